@@ -30,11 +30,15 @@
 
 #include <stdlib.h>
 
+#include <string>
+
 #include "basic_types.h"
 
 bool g_is_quiet_mode = false;
+int g_enabled_log_levels = (1 << calns::LOG_LEVEL_COUNT) - 1;
 calns::screen_logger *g_screen_logger = NULL;
 calns::file_logger *g_file_logger = NULL;
+calns::binary_logger *g_binary_logger = NULL;
 
 namespace cafw
 {
@@ -44,8 +48,13 @@ int init_logger(
     const bool enables_file_logger,
     const int file_level,
     const char *log_dir,
-    const char *log_name)
+    const char *log_name,
+    const bool writes_file_in_background,
+    const bool has_binary_log,
+    const bool maps_log_file)
 {
+    std::string binary_log_name;
+
     if (enables_file_logger)
     {
         if (NULL == log_dir || NULL == log_name)
@@ -55,17 +64,28 @@ int init_logger(
         }
 
         if (NULL == g_file_logger
-            && NULL == (g_file_logger = new calns::file_logger))
+            && NULL == (g_file_logger = (writes_file_in_background ? new calns::async_file_logger
+                : (maps_log_file ? new calns::mmap_file_logger : new calns::file_logger))))
         {
             LOGF_NS(E, "cafw", "failed to allocate memory for g_file_logger\n");
             return RET_FAILED;
         }
         // Note: g_screen_logger was created at the beginning.
+
+        if (has_binary_log
+            && NULL == g_binary_logger
+            && NULL == (g_binary_logger = new calns::binary_logger))
+        {
+            LOGF_NS(E, "cafw", "failed to allocate memory for g_binary_logger\n");
+            return RET_FAILED;
+        }
+        binary_log_name = std::string(log_name) + "_binary";
     }
 
     calns::logger *loggers[] = {
         g_screen_logger,
-        g_file_logger
+        g_file_logger,
+        g_binary_logger
     };
 
     for (size_t i = 0; i < sizeof(loggers) / sizeof(calns::logger*); ++i)
@@ -80,6 +100,9 @@ int init_logger(
         int ret = CA_RET_GENERAL_FAILURE;
 
         logger->set_log_level((calns::enum_log_level)log_level);
+#ifdef MULTI_THREADING
+        logger->set_thread_safe(true); // worker threads log through the same loggers
+#endif
 
         //LOGF_NS(D, "cafw", "log_dir: %s\n", log_dir);
         if ((ret = logger->set_log_directory(log_dir)) < 0)
@@ -88,15 +111,17 @@ int init_logger(
             goto LOG_INIT_FAILED;
         }
 
-        if ((ret = logger->set_log_name(log_name)) < 0)
+        const char *name = (logger == g_binary_logger) ? binary_log_name.c_str() : log_name;
+
+        if ((ret = logger->set_log_name(name)) < 0)
         {
-            LOGF_NS(E, "cafw", "failed to set log name to [%s], ret = %d\n", log_name, ret);
+            LOGF_NS(E, "cafw", "failed to set log name to [%s], ret = %d\n", name, ret);
             goto LOG_INIT_FAILED;
         }
 
         if ((ret = logger->open()) < 0)
         {
-            LOGF_NS(E, "cafw", "failed to open log file [%s], ret = %d\n", log_name, ret);
+            LOGF_NS(E, "cafw", "failed to open log file [%s], ret = %d\n", name, ret);
             goto LOG_INIT_FAILED;
         }
     }
@@ -114,6 +139,8 @@ int init_logger(
         goto LOG_INIT_FAILED;
     }
 
+    refresh_screen_logger(); // which updates enabled log levels too
+
     if (enables_file_logger && !is_quiet_mode())
         printf("\nFile logger has been enabled, see more details in %s(.tmp)"
             " and its afterward files and its worker thread log files.\n\n", g_file_logger->log_name());
@@ -128,6 +155,12 @@ LOG_INIT_FAILED:
 
 void clear_logger(void)
 {
+    if (NULL != g_binary_logger)
+    {
+        delete g_binary_logger;
+        g_binary_logger = NULL;
+    }
+
     if (NULL != g_file_logger)
     {
         delete g_file_logger;
@@ -139,6 +172,77 @@ void clear_logger(void)
         delete g_screen_logger;
         g_screen_logger = NULL;
     }
+
+    update_enabled_log_levels();
+}
+
+void update_enabled_log_levels(void)
+{
+    calns::logger *loggers[] = {
+        g_screen_logger,
+        g_file_logger,
+        g_binary_logger
+    };
+    int enabled_levels = 0;
+
+    for (size_t i = 0; i < sizeof(loggers) / sizeof(calns::logger*); ++i)
+    {
+        if (NULL == loggers[i] || loggers[i]->is_muted())
+            continue;
+
+        for (int level = loggers[i]->log_level(); level < calns::LOG_LEVEL_COUNT; ++level)
+            enabled_levels |= (1 << level);
+    }
+
+    __atomic_store_n(&g_enabled_log_levels, enabled_levels, __ATOMIC_RELAXED);
+}
+
+void refresh_screen_logger(void)
+{
+    if (NULL != g_screen_logger)
+    {
+        g_screen_logger->refresh_output_status();
+        g_screen_logger->set_muted(g_screen_logger->output_is_discarded()
+            || (is_quiet_mode() && NULL != g_file_logger
+                && (calns::daemon::is_daemonized() || !g_screen_logger->is_terminal())));
+    }
+
+    update_enabled_log_levels();
+}
+
+bool log_rate_limiter::allows(int per_second, int64_t &suppressed)
+{
+    suppressed = 0;
+    if (per_second <= 0)
+        return true;
+
+    struct timespec now_ts;
+
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &now_ts); // milliseconds are accurate enough
+
+    const int64_t kNow = (int64_t)now_ts.tv_sec * 1000000 + now_ts.tv_nsec / 1000;
+    const int64_t kInterval = 1000000 / per_second;
+    const int64_t kBurstTolerance = kInterval * (per_second - 1);
+    int64_t next_time = __atomic_load_n(&next_time_usec, __ATOMIC_RELAXED);
+
+    do
+    {
+        int64_t base_time = (next_time > kNow) ? next_time : kNow;
+
+        if (base_time - kNow > kBurstTolerance) // the bucket is empty
+        {
+            __atomic_add_fetch(&suppressed_count, 1, __ATOMIC_RELAXED);
+            return false;
+        }
+
+        if (__atomic_compare_exchange_n(&next_time_usec, &next_time, base_time + kInterval,
+            false, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+            break;
+    } while (true); // next_time is refreshed by the failed exchange
+
+    suppressed = __atomic_exchange_n(&suppressed_count, 0, __ATOMIC_RELAXED);
+
+    return true;
 }
 
 }
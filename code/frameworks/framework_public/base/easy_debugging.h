@@ -49,8 +49,21 @@ namespace calns = CA_LIB_NAMESPACE;
 
 #define __FUNC__                                    __FUNCTION__
 
+// Log lines below this level are removed at compile time,
+// e.g. -DCAFW_MIN_LOG_LEVEL=1 removes all DEBUG lines from a release build.
+#ifndef CAFW_MIN_LOG_LEVEL
+#define CAFW_MIN_LOG_LEVEL                          0
+#endif
+
+// Checked before any argument is evaluated. The first part is a constant expression,
+// and the second part reads the switches set by cafw::update_enabled_log_levels().
+#define LOG_LEVEL_IS_ON(log_level)                  ((log_level) >= CAFW_MIN_LOG_LEVEL \
+    && 0 != (__atomic_load_n(&g_enabled_log_levels, __ATOMIC_RELAXED) & (1 << (log_level))))
+
 #undef LOGF_BASE
 #define LOGF_BASE(log_level, fmt, ...)              do{\
+    if (!LOG_LEVEL_IS_ON(log_level)) \
+        break; \
     g_screen_logger->output(calns::HAS_LOG_PREFIX, log_level, fmt, ##__VA_ARGS__); \
     if (NULL != g_file_logger) \
         g_file_logger->output(calns::HAS_LOG_PREFIX, log_level, fmt, ##__VA_ARGS__); \
@@ -79,6 +92,8 @@ namespace calns = CA_LIB_NAMESPACE;
 #define LOG_FLUSH()                                 do{\
     if (NULL != g_file_logger) \
         g_file_logger->flush(); \
+    if (NULL != g_binary_logger) \
+        g_binary_logger->flush(); \
 }while(0)
 
 // R is short for raw, which means outputting log contents as little as possible.
@@ -87,6 +102,36 @@ namespace calns = CA_LIB_NAMESPACE;
 #endif
 #define RLOGF(x, fmt, ...)                          LOGF_BASE(calns::LOG_LEVEL_##x, fmt, ##__VA_ARGS__)
 
+// KV is short for key-value, which means a structured line made up of @msg and typed key-value pairs,
+// rendered as text or as JSON (see the "json" attribute of the file logger) without printf-like formatting, e.g.,
+//     KVLOGF(I, "new connection arrived", "fd", fd, "peer_ip", conn->peer_ip, "peer_port", conn->peer_port);
+#ifdef KVLOGF
+#undef KVLOGF
+#endif
+#define KVLOGF(x, msg, ...)                         do{\
+    if (!LOG_LEVEL_IS_ON(calns::LOG_LEVEL_##x)) \
+        break; \
+    g_screen_logger->kv(calns::LOG_LEVEL_##x, msg, ##__VA_ARGS__); \
+    if (NULL != g_file_logger) \
+        g_file_logger->kv(calns::LOG_LEVEL_##x, msg, ##__VA_ARGS__); \
+}while(0)
+
+// B is short for binary, which means the same as RLOGF except that, if binary log is enabled,
+// the line goes into the binary log file without being formatted, use decode_binary_log to read it.
+// Arguments can only be integers, floating points, pointers and C strings.
+#ifdef BLOGF
+#undef BLOGF
+#endif
+#define BLOGF(x, fmt, ...)                          do{\
+    if (!LOG_LEVEL_IS_ON(calns::LOG_LEVEL_##x)) \
+        break; \
+    g_screen_logger->output(calns::HAS_LOG_PREFIX, calns::LOG_LEVEL_##x, fmt, ##__VA_ARGS__); \
+    if (NULL != g_binary_logger) \
+        BLOG(*g_binary_logger, calns::LOG_LEVEL_##x, fmt, ##__VA_ARGS__); \
+    else if (NULL != g_file_logger) \
+        g_file_logger->output(calns::HAS_LOG_PREFIX, calns::LOG_LEVEL_##x, fmt, ##__VA_ARGS__); \
+}while(0)
+
 // Q is short for quiet, which means quiet mode and outputting log contents as little as possible on startup.
 #ifdef RQLOGF
 #undef RQLOGF
@@ -120,21 +165,80 @@ namespace calns = CA_LIB_NAMESPACE;
 #endif
 #define QLOGF_NS(x, _namespace_, fmt, ...)          QLOGF_BASE_V(calns::LOG_LEVEL_##x, #_namespace_, "::", fmt, ##__VA_ARGS__)
 
+// Runs the logging statement at the 1st, (n+1)th, (2n+1)th, ... time of the call site only.
+#define LOG_EVERY_N_BASE(log_level, n, logging)     do{\
+    if (!LOG_LEVEL_IS_ON(log_level)) \
+        break; \
+    static int64_t __cafw_log_count = 0; \
+    if (0 != __atomic_fetch_add(&__cafw_log_count, 1, __ATOMIC_RELAXED) % (n)) \
+        break; \
+    logging; \
+}while(0)
+
+// Runs the logging statement at most @per_second times a second on average, and bursting up to @per_second times,
+// each call site has its own token bucket, and reports how many lines were suppressed when it resumes.
+#define LOG_RATE_LIMITED_BASE(log_level, per_second, logging)  do{\
+    if (!LOG_LEVEL_IS_ON(log_level)) \
+        break; \
+    static cafw::log_rate_limiter __cafw_log_limiter; \
+    int64_t __cafw_suppressed_count = 0; \
+    if (!__cafw_log_limiter.allows((per_second), __cafw_suppressed_count)) \
+        break; \
+    if (__cafw_suppressed_count > 0) \
+        LOGF_BASE(log_level, "%s:%d: %ld similar messages suppressed\n", __FILE__, __LINE__, __cafw_suppressed_count); \
+    logging; \
+}while(0)
+
+// EVERY_N and RATE_LIMITED are for lines which may be flooded by a misbehaving peer,
+// see LOG_EVERY_N_BASE and LOG_RATE_LIMITED_BASE.
+#define RLOGF_EVERY_N(x, n, fmt, ...)               LOG_EVERY_N_BASE(calns::LOG_LEVEL_##x, n, RLOGF(x, fmt, ##__VA_ARGS__))
+#define LOGF_EVERY_N(x, n, fmt, ...)                LOG_EVERY_N_BASE(calns::LOG_LEVEL_##x, n, LOGF(x, fmt, ##__VA_ARGS__))
+#define LOGF_C_EVERY_N(x, n, fmt, ...)              LOG_EVERY_N_BASE(calns::LOG_LEVEL_##x, n, LOGF_C(x, fmt, ##__VA_ARGS__))
+
+#define RLOGF_RATE_LIMITED(x, per_second, fmt, ...) LOG_RATE_LIMITED_BASE(calns::LOG_LEVEL_##x, per_second, \
+    RLOGF(x, fmt, ##__VA_ARGS__))
+#define LOGF_RATE_LIMITED(x, per_second, fmt, ...)  LOG_RATE_LIMITED_BASE(calns::LOG_LEVEL_##x, per_second, \
+    LOGF(x, fmt, ##__VA_ARGS__))
+#define LOGF_C_RATE_LIMITED(x, per_second, fmt, ...)    LOG_RATE_LIMITED_BASE(calns::LOG_LEVEL_##x, per_second, \
+    LOGF_C(x, fmt, ##__VA_ARGS__))
+
 extern bool g_is_quiet_mode;
+extern int g_enabled_log_levels; // bit N is set if any logger accepts level N
 extern calns::screen_logger *g_screen_logger;
 extern calns::file_logger *g_file_logger;
+extern calns::binary_logger *g_binary_logger;
 
 namespace cafw
 {
 
+// A token bucket of a call site, in the form of GCRA(generic cell rate algorithm),
+// which needs a single time variable only. Zero-initialized as a static variable.
+struct log_rate_limiter
+{
+    int64_t next_time_usec; // when the bucket is full again, or earlier
+    int64_t suppressed_count;
+
+    // Whether a line is allowed, @suppressed is set to how many lines were suppressed
+    // since the last allowed one. A non-positive @per_second means no limit.
+    bool allows(int per_second, int64_t &suppressed);
+};
+
+// Mutes g_screen_logger if its output is discarded, or in quiet mode if it's not watched
+// (daemonized or not on a terminal) while g_file_logger takes all lines,
+// so that LOGF() and the like skip formatting for it. Unmutes it otherwise.
+void refresh_screen_logger(void);
+
+// Quiet mode can be switched at runtime, e.g., in a signal handler.
 inline void enable_quiet_mode(void)
 {
     g_is_quiet_mode = true;
+    refresh_screen_logger();
 }
 
 inline void disable_quiet_mode(void)
 {
     g_is_quiet_mode = false;
+    refresh_screen_logger();
 }
 
 inline bool is_quiet_mode(void)
@@ -147,10 +251,17 @@ int init_logger(
     const bool enables_file_logger = false,
     const int file_level = -1,
     const char *log_dir = ".",
-    const char *log_name = "unknown_program");
+    const char *log_name = "unknown_program",
+    const bool writes_file_in_background = false,
+    const bool has_binary_log = false,
+    const bool maps_log_file = false);
 
 void clear_logger(void);
 
+// Refreshes g_enabled_log_levels according to the levels of current loggers,
+// call it after changing the level of any logger.
+void update_enabled_log_levels(void);
+
 }
 
 #endif /* __CASDK_FRAMEWORK_EASY_DEBUG_H__ */
@@ -35,6 +35,10 @@
 
 #include "char_dictionary.h"
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 #include "base/all.h"
 
 #if HASH_OPTION == HASH_OPTION_STL_UNORDERED_MAP
@@ -43,13 +47,15 @@
 #pragma message("map used for implementing dictionary")
 #elif HASH_OPTION == HASH_OPTION_STL_HASH_MAP
 #pragma message("hash_map used for implementing dictionary")
+#elif HASH_OPTION == HASH_OPTION_FLAT_DICT
+#pragma message("open-addressing flat_dict used for implementing dictionary")
 #else
 #pragma message("dict from 3rd-party source code used for implementing dictionary")
 #endif
 
 #if(HASH_OPTION == HASH_OPTION_3RD_PARTY_DICT)
 
-dict *char_dict_create(int dict_size)
+char_dict *char_dict_create(int dict_size)
 {
     dict *d = NULL;
 
@@ -68,7 +74,7 @@ dict *char_dict_create(int dict_size)
 }
 
 void char_dict_destroy(
-    dict **dict,
+    char_dict **dict,
     free_dict_value_func free_val_func,
     uint32_t free_hint
 )
@@ -110,7 +116,7 @@ int char_dict_add_element(
     const int keylen,
     const void *val,
     const int vallen,
-    dict *dict
+    char_dict *dict
 )
 {
     if (NULL == dict ||
@@ -146,7 +152,7 @@ int char_dict_add_element(
 int char_dict_delete_element(
     const char *key,
     const int keylen,
-    dict *dict,
+    char_dict *dict,
     free_dict_value_func free_val_func,
     uint32_t free_hint
 )
@@ -173,7 +179,7 @@ int char_dict_delete_element(
     return (DICT_OK == ret) ? RET_OK : RET_FAILED;
 }
 
-void *char_dict_find_iterator(const char *key, const int keylen, dict *dict)
+void *char_dict_find_iterator(const char *key, const int keylen, char_dict *dict)
 {
     if (NULL == key || NULL == dict)
     {
@@ -184,7 +190,7 @@ void *char_dict_find_iterator(const char *key, const int keylen, dict *dict)
     return dict_find(dict, key, keylen);
 }
 
-void *char_dict_find_value(const char *key, const int keylen, dict *dict)
+void *char_dict_find_value(const char *key, const int keylen, char_dict *dict)
 {
     dict_entry *entry = (dict_entry*)char_dict_find_iterator(key, keylen, dict);
 
@@ -194,7 +200,7 @@ void *char_dict_find_value(const char *key, const int keylen, dict *dict)
     return entry->val;
 }
 
-void char_dict_print(const dict *dict)
+void char_dict_print(const char_dict *dict)
 {
     dict_entry *entry = NULL;
 
@@ -227,7 +233,7 @@ void char_dict_print(const dict *dict)
     }
 }
 
-void char_dict_batch_operation(dict *dict, action_to_char_dict_element op)
+void char_dict_batch_operation(char_dict *dict, action_to_char_dict_element op)
 {
     if (NULL == dict || NULL == op)
         return;
@@ -243,15 +249,650 @@ void char_dict_batch_operation(dict *dict, action_to_char_dict_element op)
     dict_release_iterator(it);
 }
 
+size_t char_dict_size(const char_dict *dict)
+{
+    return (NULL == dict) ? 0 : dict_size(dict);
+}
+
+int char_dict_reserve(char_dict *dict, int count)
+{
+    if (NULL == dict || count < 0)
+        return RET_FAILED;
+
+    if (dict_is_rehashing(dict) || dict_slots(dict) >= (unsigned long)count)
+        return RET_OK;
+
+    if (DICT_OK != dict_expand(dict, count))
+    {
+        LOGF(E, "dict_expand() failed, count = %d\n", count);
+        return RET_FAILED;
+    }
+    while (dict_rehash(dict, 100))
+    {
+        ;
+    }
+
+    return RET_OK;
+}
+
+int char_dict_rehash(char_dict *dict, int budget_usec)
+{
+    if (NULL == dict || !dict_is_rehashing(dict))
+        return 0;
+
+    if (dict->iterators > 0) // entries must not move under safe iterators
+        return 1;
+
+    int64_t deadline = calns::time_util::get_utc_microseconds() + budget_usec;
+
+    while (dict_rehash(dict, 100) && calns::time_util::get_utc_microseconds() < deadline)
+    {
+        ;
+    }
+
+    return dict_is_rehashing(dict) ? 1 : 0;
+}
+
+#elif (HASH_OPTION == HASH_OPTION_FLAT_DICT)
+
+static const int8_t S_CTRL_EMPTY = (int8_t)0x80;
+static const int8_t S_CTRL_DELETED = (int8_t)0xFE;
+static const size_t S_MIN_CAPACITY = FLAT_DICT_GROUP_WIDTH;
+static const size_t S_REHASH_SLOTS_PER_ADD = 2 * FLAT_DICT_GROUP_WIDTH;
+static const size_t S_REHASH_SLOTS_PER_CHECK = 1024; // between two checks of the time budget
+
+// A hash reading 8 bytes at a time with 64x64->128 multiplications, in the style of wyhash.
+static inline uint64_t __mix(uint64_t a, uint64_t b)
+{
+    __uint128_t product = (__uint128_t)a * b;
+
+    return (uint64_t)product ^ (uint64_t)(product >> 64);
+}
+
+static uint64_t __hash(const char *key, int keylen)
+{
+    static const uint64_t kSecret0 = 0xa0761d6478bd642fULL;
+    static const uint64_t kSecret1 = 0xe7037ed1a0b428dbULL;
+    uint64_t h = kSecret0 ^ (uint64_t)keylen;
+    uint64_t word = 0;
+    int i = 0;
+
+    for (; i + 8 <= keylen; i += 8)
+    {
+        memcpy(&word, key + i, 8);
+        h = __mix(word ^ kSecret1, h ^ kSecret0);
+    }
+
+    if (i < keylen)
+    {
+        word = 0;
+        memcpy(&word, key + i, keylen - i);
+        h = __mix(word ^ kSecret1, h ^ kSecret0);
+    }
+
+    return __mix(h, kSecret1 ^ (uint64_t)keylen);
+}
+
+static inline int8_t __h2(uint64_t hash)
+{
+    return (int8_t)(hash & 0x7F);
+}
+
+static inline size_t __h1(uint64_t hash)
+{
+    return (size_t)(hash >> 7);
+}
+
+static inline bool __is_rehashing(const flat_dict *dict)
+{
+    return (dict->rehashidx >= 0);
+}
+
+// Returns a bit mask of control bytes in the group at @ctrl which equal @value.
+static inline uint32_t __match_group(const int8_t *ctrl, int8_t value)
+{
+#if defined(__SSE2__)
+    __m128i group = _mm_loadu_si128((const __m128i *)ctrl);
+
+    return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8(value)));
+#else
+    uint32_t mask = 0;
+
+    for (int i = 0; i < FLAT_DICT_GROUP_WIDTH; ++i)
+    {
+        if (ctrl[i] == value)
+            mask |= (1U << i);
+    }
+
+    return mask;
+#endif
+}
+
+// Returns a bit mask of empty or deleted slots in the group at @ctrl.
+static inline uint32_t __match_group_free(const int8_t *ctrl)
+{
+#if defined(__SSE2__)
+    return (uint32_t)_mm_movemask_epi8(_mm_loadu_si128((const __m128i *)ctrl)); // the sign bits
+#else
+    uint32_t mask = 0;
+
+    for (int i = 0; i < FLAT_DICT_GROUP_WIDTH; ++i)
+    {
+        if (ctrl[i] < 0)
+            mask |= (1U << i);
+    }
+
+    return mask;
+#endif
+}
+
+static inline void __set_ctrl(flat_dict_table *table, size_t index, int8_t value)
+{
+    table->ctrl[index] = value;
+    if (index < FLAT_DICT_GROUP_WIDTH)
+        table->ctrl[table->capacity + index] = value; // the mirror, for groups wrapping around
+}
+
+// Returns the slot index of the element in @table, or -1 if not found.
+static long __find_slot(const flat_dict_table *table, const char *key, int keylen, uint64_t hash)
+{
+    const size_t kMask = table->capacity - 1;
+    const int8_t kH2 = __h2(hash);
+    size_t pos = __h1(hash) & kMask;
+
+    for (size_t probe = 1; probe <= table->capacity / FLAT_DICT_GROUP_WIDTH; ++probe)
+    {
+        const int8_t *group = table->ctrl + pos;
+
+        for (uint32_t match = __match_group(group, kH2); 0 != match; match &= match - 1)
+        {
+            size_t index = (pos + __builtin_ctz(match)) & kMask;
+            const flat_dict_entry *entry = table->slots[index];
+
+            if (hash == entry->hash && keylen == entry->keylen && 0 == memcmp(entry->key, key, keylen))
+                return (long)index;
+        }
+
+        if (0 != __match_group(group, S_CTRL_EMPTY))
+            break;
+
+        pos = (pos + probe * FLAT_DICT_GROUP_WIDTH) & kMask; // triangular probing, visiting every group
+    }
+
+    return -1;
+}
+
+// Finds the element in the table being filled first, then in the one being emptied, if rehashing.
+static flat_dict_entry *__find(flat_dict *dict, const char *key, int keylen, uint64_t hash,
+    flat_dict_table **table_holder, long *index_holder)
+{
+    for (int i = __is_rehashing(dict) ? 1 : 0; i >= 0; --i)
+    {
+        long index = __find_slot(&(dict->ht[i]), key, keylen, hash);
+
+        if (index >= 0)
+        {
+            if (NULL != table_holder)
+                *table_holder = &(dict->ht[i]);
+            if (NULL != index_holder)
+                *index_holder = index;
+            return dict->ht[i].slots[index];
+        }
+    }
+
+    return NULL;
+}
+
+// Puts @entry into the first empty or deleted slot on the probe sequence of its hash.
+static void __insert(flat_dict_table *table, flat_dict_entry *entry)
+{
+    const size_t kMask = table->capacity - 1;
+    size_t pos = __h1(entry->hash) & kMask;
+    uint32_t match = 0;
+
+    for (size_t probe = 1; 0 == (match = __match_group_free(table->ctrl + pos)); ++probe)
+    {
+        pos = (pos + probe * FLAT_DICT_GROUP_WIDTH) & kMask;
+    }
+
+    size_t index = (pos + __builtin_ctz(match)) & kMask;
+
+    if (S_CTRL_DELETED == table->ctrl[index])
+        --(table->deleted);
+    __set_ctrl(table, index, __h2(entry->hash));
+    table->slots[index] = entry;
+    ++(table->used);
+}
+
+static int __alloc_table(flat_dict_table *table, size_t capacity)
+{
+    int8_t *ctrl = (int8_t *)malloc(capacity + FLAT_DICT_GROUP_WIDTH);
+    flat_dict_entry **slots = (flat_dict_entry **)malloc(capacity * sizeof(flat_dict_entry *));
+
+    if (NULL == ctrl || NULL == slots)
+    {
+        free(ctrl);
+        free(slots);
+        return RET_FAILED;
+    }
+
+    memset(ctrl, S_CTRL_EMPTY, capacity + FLAT_DICT_GROUP_WIDTH);
+    table->ctrl = ctrl;
+    table->slots = slots;
+    table->capacity = capacity;
+    table->used = 0;
+    table->deleted = 0;
+
+    return RET_OK;
+}
+
+static void __free_table(flat_dict_table *table)
+{
+    free(table->ctrl);
+    free(table->slots);
+    memset(table, 0, sizeof(flat_dict_table));
+}
+
+// Moves elements in at most @slot_count slots of ht[0] into ht[1],
+// and ht[1] takes the place of ht[0] when all are moved. Elements themselves never move.
+static void __rehash_slots(flat_dict *dict, size_t slot_count)
+{
+    if (!__is_rehashing(dict))
+        return;
+
+    flat_dict_table *from = &(dict->ht[0]);
+    size_t end = dict->rehashidx + slot_count;
+
+    if (end > from->capacity)
+        end = from->capacity;
+
+    for (size_t i = dict->rehashidx; i < end && from->used > 0; ++i)
+    {
+        if (from->ctrl[i] < 0)
+            continue;
+
+        __insert(&(dict->ht[1]), from->slots[i]);
+        __set_ctrl(from, i, S_CTRL_DELETED);
+        --(from->used);
+    }
+    dict->rehashidx = end;
+
+    if (0 == from->used)
+    {
+        __free_table(from);
+        dict->ht[0] = dict->ht[1];
+        memset(&(dict->ht[1]), 0, sizeof(flat_dict_table));
+        dict->rehashidx = -1;
+    }
+}
+
+// Starts rehashing all elements into a new table with @capacity slots.
+static int __start_rehashing(flat_dict *dict, size_t capacity)
+{
+    if (__is_rehashing(dict))
+        __rehash_slots(dict, dict->ht[0].capacity); // finishes the last one at once, which is rare
+
+    if (RET_OK != __alloc_table(&(dict->ht[1]), capacity))
+        return RET_FAILED;
+
+    dict->rehashidx = 0;
+    __rehash_slots(dict, 0); // done at once if ht[0] is empty
+
+    return RET_OK;
+}
+
+static flat_dict_entry *__alloc_entry(flat_dict *dict)
+{
+    if (NULL == dict->free_entries)
+    {
+        flat_dict_chunk *chunk = (flat_dict_chunk *)malloc(sizeof(flat_dict_chunk));
+
+        if (NULL == chunk)
+            return NULL;
+
+        chunk->next = dict->chunks;
+        dict->chunks = chunk;
+        for (int i = FLAT_DICT_CHUNK_ENTRY_COUNT - 1; i >= 0; --i)
+        {
+            chunk->entries[i].val = dict->free_entries;
+            dict->free_entries = &(chunk->entries[i]);
+        }
+    }
+
+    flat_dict_entry *entry = dict->free_entries;
+
+    dict->free_entries = (flat_dict_entry *)(entry->val);
+
+    return entry;
+}
+
+static void __release_entry(flat_dict *dict, flat_dict_entry *entry)
+{
+    if (entry->key != entry->inline_key)
+        char_dict_release_key(&(entry->key));
+    entry->key = NULL;
+    entry->val = dict->free_entries;
+    dict->free_entries = entry;
+}
+
+// Returns the capacity in which @count elements fit without rehashing,
+// see the load factor in char_dict_add_element().
+static size_t __capacity_for(size_t count)
+{
+    size_t capacity = S_MIN_CAPACITY;
+
+    while (capacity * 7 / 8 < count)
+        capacity <<= 1;
+
+    return capacity;
+}
+
+char_dict *char_dict_create(int dict_size)
+{
+    flat_dict *d = (flat_dict *)calloc(1, sizeof(flat_dict));
+
+    if (NULL == d)
+    {
+        LOGF(E, "calloc() for flat_dict failed\n");
+        return NULL;
+    }
+
+    size_t capacity = __capacity_for((dict_size < 0) ? DEFAULT_ELEMENT_COUNT : dict_size);
+
+    d->rehashidx = -1;
+    if (RET_OK != __alloc_table(&(d->ht[0]), capacity))
+    {
+        LOGF(E, "failed to allocate a table of %ld slots\n", capacity);
+        free(d);
+        return NULL;
+    }
+
+    return d;
+}
+
+void char_dict_destroy(
+    char_dict **dict,
+    free_dict_value_func free_val_func,
+    uint32_t free_hint
+)
+{
+    if (NULL == dict || NULL == (*dict))
+        return;
+
+    flat_dict *d = *dict;
+
+    for (int i = 0; i <= 1; ++i)
+    {
+        flat_dict_table *table = &(d->ht[i]);
+
+        for (size_t j = 0; j < table->capacity; ++j)
+        {
+            if (table->ctrl[j] < 0)
+                continue;
+
+            flat_dict_entry *entry = table->slots[j];
+
+            if (NULL != free_val_func)
+                free_val_func(free_hint, &(entry->val));
+            __release_entry(d, entry);
+        }
+        __free_table(table);
+    }
+
+    while (NULL != d->chunks)
+    {
+        flat_dict_chunk *next = d->chunks->next;
+
+        free(d->chunks);
+        d->chunks = next;
+    }
+    free(d);
+    (*dict) = NULL;
+}
+
+int char_dict_add_element(
+    const char *key,
+    const int keylen,
+    const void *val,
+    const int vallen,
+    char_dict *dict
+)
+{
+    if (NULL == dict ||
+        NULL == key ||
+        NULL == val ||
+        keylen <= 0 ||
+        vallen <= 0)
+    {
+        LOGF(E, "invalid dict, key or value pointer, or invalid key or value length\n");
+        return RET_FAILED;
+    }
+
+    uint64_t hash = __hash(key, keylen);
+
+    if (NULL != __find(dict, key, keylen, hash, NULL, NULL))
+    {
+        LOGF(E, "element with key[%s] already existed\n", key);
+        return RET_FAILED;
+    }
+
+    __rehash_slots(dict, S_REHASH_SLOTS_PER_ADD); // so that an ongoing rehashing always ends in time
+
+    flat_dict_table *table = &(dict->ht[__is_rehashing(dict) ? 1 : 0]);
+
+    // At most 7/8 of slots are used or deleted, or an unsuccessful lookup may probe too many groups.
+    // The new table is twice as large unless there are mostly deleted slots,
+    // and elements are moved into it incrementally.
+    if ((table->used + table->deleted + 1) * 8 > table->capacity * 7)
+    {
+        size_t element_count = char_dict_size(dict) + 1;
+        size_t capacity = (element_count * 16 > table->capacity * 7) ? (table->capacity << 1) : table->capacity;
+
+        if (RET_OK != __start_rehashing(dict, capacity))
+        {
+            LOGF(E, "failed to start rehashing into %ld slots\n", capacity);
+            return RET_FAILED;
+        }
+        table = &(dict->ht[__is_rehashing(dict) ? 1 : 0]);
+    }
+
+    flat_dict_entry *entry = __alloc_entry(dict);
+
+    if (NULL == entry)
+    {
+        LOGF(E, "failed to allocate an element\n");
+        return RET_FAILED;
+    }
+
+    if (keylen < FLAT_DICT_INLINE_KEY_SIZE)
+        entry->key = entry->inline_key;
+    else if (NULL == (entry->key = char_dict_alloc_key(keylen + 1))) // one more byte for '\0'
+    {
+        LOGF(E, "char_dict_alloc_key() failed\n");
+        entry->val = dict->free_entries;
+        dict->free_entries = entry;
+        return RET_FAILED;
+    }
+    memcpy(entry->key, key, keylen);
+    ((char *)(entry->key))[keylen] = '\0';
+    entry->keylen = keylen;
+    entry->val = (void *)val;
+    entry->vallen = vallen;
+    entry->hash = hash;
+
+    __insert(table, entry);
+
+    return RET_OK;
+}
+
+int char_dict_delete_element(
+    const char *key,
+    const int keylen,
+    char_dict *dict,
+    free_dict_value_func free_val_func,
+    uint32_t free_hint
+)
+{
+    if (NULL == key || NULL == dict)
+    {
+        LOGF(E, "null key or dict\n");
+        return RET_FAILED;
+    }
+
+    flat_dict_table *table = NULL;
+    long index = -1;
+    flat_dict_entry *entry = __find(dict, key, keylen, __hash(key, keylen), &table, &index);
+
+    if (NULL == entry)
+    {
+        LOGF(E, "message with key[%s] not found\n", key);
+        return RET_FAILED;
+    }
+
+    // Marked deleted, not empty, so that probe sequences passing through it are not broken.
+    __set_ctrl(table, index, S_CTRL_DELETED);
+    --(table->used);
+    ++(table->deleted);
+
+    if (NULL != free_val_func)
+        free_val_func(free_hint, &(entry->val));
+    __release_entry(dict, entry);
+
+    return RET_OK;
+}
+
+void *char_dict_find_iterator(const char *key, const int keylen, char_dict *dict)
+{
+    if (NULL == key || NULL == dict)
+    {
+        LOGF(E, "null key or dict\n");
+        return NULL;
+    }
+
+    return __find(dict, key, keylen, __hash(key, keylen), NULL, NULL);
+}
+
+void *char_dict_find_value(const char *key, const int keylen, char_dict *dict)
+{
+    flat_dict_entry *entry = (flat_dict_entry*)char_dict_find_iterator(key, keylen, dict);
+
+    if (NULL == entry)
+        return NULL;
+
+    return entry->val;
+}
+
+flat_dict_entry *flat_dict_next(const flat_dict *dict, size_t *pos)
+{
+    if (NULL == dict || NULL == pos)
+        return NULL;
+
+    // Slots of ht[0] come first, followed by those of ht[1].
+    for (; *pos < dict->ht[0].capacity + dict->ht[1].capacity; ++(*pos))
+    {
+        const flat_dict_table *table = &(dict->ht[0]);
+        size_t index = *pos;
+
+        if (index >= table->capacity)
+        {
+            index -= table->capacity;
+            table = &(dict->ht[1]);
+        }
+
+        if (table->ctrl[index] >= 0)
+        {
+            ++(*pos);
+            return table->slots[index];
+        }
+    }
+
+    return NULL;
+}
+
+void char_dict_print(const char_dict *dict)
+{
+    LOGF(I, "Dictionary report:\n");
+    RLOGF(I, "rehashidx = %ld\n", dict->rehashidx);
+    for (int i = 0; i <= 1; ++i)
+    {
+        RLOGF(I, "ht[%d]:\n", i);
+        RLOGF(I, "\tcapacity = %ld\n", dict->ht[i].capacity);
+        RLOGF(I, "\tused = %ld\n", dict->ht[i].used);
+        RLOGF(I, "\tdeleted = %ld\n", dict->ht[i].deleted);
+    }
+
+    size_t pos = 0;
+    flat_dict_entry *entry = NULL;
+
+    while (NULL != (entry = flat_dict_next(dict, &pos)))
+    {
+        RLOGF(I, "\t\t%s | %d | %p | %d\n", (char*)entry->key, entry->keylen, entry->val, entry->vallen);
+    }
+}
+
+void char_dict_batch_operation(char_dict *dict, action_to_char_dict_element op)
+{
+    if (NULL == dict || NULL == op)
+        return;
+
+    size_t pos = 0;
+    flat_dict_entry *entry = NULL;
+
+    while (NULL != (entry = flat_dict_next(dict, &pos)))
+    {
+        op((char *)(entry->key), entry->val);
+    }
+}
+
+size_t char_dict_size(const char_dict *dict)
+{
+    return (NULL == dict) ? 0 : (dict->ht[0].used + dict->ht[1].used);
+}
+
+int char_dict_reserve(char_dict *dict, int count)
+{
+    if (NULL == dict || count < 0)
+        return RET_FAILED;
+
+    size_t capacity = __capacity_for(count);
+
+    if (capacity <= dict->ht[__is_rehashing(dict) ? 1 : 0].capacity)
+        return RET_OK;
+
+    if (RET_OK != __start_rehashing(dict, capacity))
+    {
+        LOGF(E, "failed to rehash into %ld slots\n", capacity);
+        return RET_FAILED;
+    }
+    __rehash_slots(dict, dict->ht[0].capacity);
+
+    return RET_OK;
+}
+
+int char_dict_rehash(char_dict *dict, int budget_usec)
+{
+    if (NULL == dict || !__is_rehashing(dict))
+        return 0;
+
+    int64_t deadline = calns::time_util::get_utc_microseconds() + budget_usec;
+
+    do
+    {
+        __rehash_slots(dict, S_REHASH_SLOTS_PER_CHECK);
+    } while (__is_rehashing(dict) && calns::time_util::get_utc_microseconds() < deadline);
+
+    return __is_rehashing(dict) ? 1 : 0;
+}
+
 #else
 
-dict *char_dict_create(int dict_size)
+char_dict *char_dict_create(int dict_size)
 {
     return new dict; // TODO: how to use dict_size ?
 }
 
 void char_dict_destroy(
-    dict **dict,
+    char_dict **dict,
     free_dict_value_func free_val_func,
     uint32_t free_hint
 )
@@ -280,7 +921,7 @@ int char_dict_add_element(
     const int keylen,
     const void *val,
     const int vallen,
-    dict *dict
+    char_dict *dict
 )
 {
     if (NULL == dict ||
@@ -336,7 +977,7 @@ int char_dict_add_element(
 int char_dict_delete_element(
     const char *key,
     const int keylen,
-    dict *dict,
+    char_dict *dict,
     free_dict_value_func free_val_func,
     uint32_t free_hint
 )
@@ -366,7 +1007,7 @@ int char_dict_delete_element(
     return RET_OK;
 }
 
-void *char_dict_find_iterator(const char *key, const int keylen, dict *dict)
+void *char_dict_find_iterator(const char *key, const int keylen, char_dict *dict)
 {
     if (NULL == key || NULL == dict)
     {
@@ -381,7 +1022,7 @@ void *char_dict_find_iterator(const char *key, const int keylen, dict *dict)
     return it;
 }
 
-void *char_dict_find_value(const char *key, const int keylen, dict *dict)
+void *char_dict_find_value(const char *key, const int keylen, char_dict *dict)
 {
     dict::iterator it = (dict::iterator)char_dict_find_iterator(key, keylen, dict);
 
@@ -391,7 +1032,7 @@ void *char_dict_find_value(const char *key, const int keylen, dict *dict)
     return it->second;
 }
 
-void char_dict_print(const dict *dict)
+void char_dict_print(const char_dict *dict)
 {
     dict::const_iterator begin = dict->begin();
     dict::const_iterator end = dict->end();
@@ -405,9 +1046,34 @@ void char_dict_print(const dict *dict)
     }
 }
 
-void char_dict_batch_operation(dict *dict, action_to_char_dict_element op)
+void char_dict_batch_operation(char_dict *dict, action_to_char_dict_element op)
 {
     ;
 }
 
+size_t char_dict_size(const char_dict *dict)
+{
+    return (NULL == dict) ? 0 : dict->size();
+}
+
+int char_dict_reserve(char_dict *dict, int count)
+{
+    if (NULL == dict || count < 0)
+        return RET_FAILED;
+
+#if HASH_OPTION == HASH_OPTION_STL_UNORDERED_MAP
+    dict->reserve(count);
+#elif HASH_OPTION == HASH_OPTION_STL_HASH_MAP
+    dict->resize(count);
+#endif
+    // A tree-based map allocates nodes one by one, and has nothing to reserve.
+
+    return RET_OK;
+}
+
+int char_dict_rehash(char_dict *dict, int budget_usec)
+{
+    return 0; // STL containers rehash at once
+}
+
 #endif
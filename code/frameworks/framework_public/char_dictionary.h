@@ -48,17 +48,19 @@ enum
     HASH_OPTION_STL_UNORDERED_MAP = 1,
     HASH_OPTION_STL_MAP,
     HASH_OPTION_STL_HASH_MAP,
-    HASH_OPTION_3RD_PARTY_DICT
+    HASH_OPTION_3RD_PARTY_DICT,
+    HASH_OPTION_FLAT_DICT
 };
 #else // Enable this branch when macro compare is used.
 #define HASH_OPTION_STL_UNORDERED_MAP                               1
 #define HASH_OPTION_STL_MAP                                         2
 #define HASH_OPTION_STL_HASH_MAP                                    3
 #define HASH_OPTION_3RD_PARTY_DICT                                  4
+#define HASH_OPTION_FLAT_DICT                                       5
 #endif
 
 #ifndef HASH_OPTION
-#define HASH_OPTION                                                 HASH_OPTION_3RD_PARTY_DICT
+#define HASH_OPTION                                                 HASH_OPTION_FLAT_DICT
 #endif
 
 #if HASH_OPTION == HASH_OPTION_STL_UNORDERED_MAP
@@ -70,15 +72,75 @@ typedef std::map<char*, void*, calns::char_lt_op > dict;
 #elif HASH_OPTION == HASH_OPTION_STL_HASH_MAP
 #include <hash_map>
 typedef __gnu_cxx::hash_map<char*, void*, __gnu_cxx::hash<char*>, calns::char_eq_op > dict;
-#else
-//typedef dict dict;
+#elif HASH_OPTION == HASH_OPTION_FLAT_DICT
+/*
+ * An open-addressing hash table in the way of Swiss tables: each slot has a control byte,
+ * which holds 7 bits of the hash of its element or marks it empty or deleted,
+ * and control bytes are matched a group at a time (by SSE2 if available),
+ * so that a lookup usually touches one group of control bytes and one element.
+ * Elements are allocated in chunks and never move, so that a dict_entry_ptr stays valid
+ * until its element is deleted, and short keys are stored in elements themselves.
+ * Like dict, it grows into a second table, and elements are moved into it incrementally,
+ * by a few slots on each add, and by char_dict_rehash() which is called between rounds of polling.
+ */
+enum
+{
+    FLAT_DICT_GROUP_WIDTH = 16,
+    FLAT_DICT_INLINE_KEY_SIZE = 40, // including the terminating '\0', enough for session IDs
+    FLAT_DICT_CHUNK_ENTRY_COUNT = 64
+};
+
+typedef struct flat_dict_entry
+{
+    void *key; // points to inline_key if the key fits in it
+    void *val;
+    uint64_t hash;
+    int keylen;
+    int vallen;
+    char inline_key[FLAT_DICT_INLINE_KEY_SIZE];
+}flat_dict_entry;
+
+typedef struct flat_dict_chunk
+{
+    struct flat_dict_chunk *next;
+    flat_dict_entry entries[FLAT_DICT_CHUNK_ENTRY_COUNT];
+}flat_dict_chunk;
+
+typedef struct flat_dict_table
+{
+    int8_t *ctrl; // capacity + FLAT_DICT_GROUP_WIDTH bytes, with the first group mirrored at the end
+    flat_dict_entry **slots;
+    size_t capacity; // a power of 2
+    size_t used;
+    size_t deleted; // slots marked deleted, which are reclaimed by rehashing
+}flat_dict_table;
+
+typedef struct flat_dict
+{
+    flat_dict_table ht[2]; // ht[1] is used during rehashing only
+    long rehashidx; // the next slot of ht[0] to move, or -1 if not rehashing
+    flat_dict_entry *free_entries; // linked by val
+    flat_dict_chunk *chunks;
+}flat_dict;
+
+typedef flat_dict char_dict;
+
+// Walks through elements of @dict, starting with *@pos being 0, returns NULL at the end.
+// The element returned can be deleted during the walk, but nothing can be added.
+flat_dict_entry *flat_dict_next(const flat_dict *dict, size_t *pos);
 #endif
 
 #if HASH_OPTION == HASH_OPTION_3RD_PARTY_DICT
+typedef dict char_dict;
 typedef dict_entry* dict_entry_ptr;
 #define GET_CHAR_DICT_KEY(dict_item)    ((char*)((dict_item)->key))
 #define GET_CHAR_DICT_VALUE(dict_item)  ((dict_item)->val)
+#elif HASH_OPTION == HASH_OPTION_FLAT_DICT
+typedef flat_dict_entry* dict_entry_ptr;
+#define GET_CHAR_DICT_KEY(dict_item)    ((char*)((dict_item)->key))
+#define GET_CHAR_DICT_VALUE(dict_item)  ((dict_item)->val)
 #else
+typedef dict char_dict;
 typedef dict::iterator dict_entry_ptr;
 #define GET_CHAR_DICT_KEY(dict_item)    ((char*)((dict_item)->first))
 #define GET_CHAR_DICT_VALUE(dict_item)  ((dict_item)->second)
@@ -131,10 +193,10 @@ enum
     NO_FREE_HINT = 0
 };
 
-dict *char_dict_create(int dict_size);
+char_dict *char_dict_create(int dict_size);
 
 void char_dict_destroy(
-    dict **dict,
+    char_dict **dict,
     free_dict_value_func free_val_func = NULL,
     uint32_t free_hint = NO_FREE_HINT
 );
@@ -144,23 +206,34 @@ int char_dict_add_element(
     const int keylen,
     const void *val,
     const int vallen,
-    dict *dict
+    char_dict *dict
 );
 
 int char_dict_delete_element(
     const char *key,
     const int keylen,
-    dict *dict,
+    char_dict *dict,
     free_dict_value_func free_val_func = NULL,
     uint32_t free_hint = NO_FREE_HINT
 );
 
-void *char_dict_find_iterator(const char *key, const int keylen, dict *dict);
+void *char_dict_find_iterator(const char *key, const int keylen, char_dict *dict);
+
+void *char_dict_find_value(const char *key, const int keylen, char_dict *dict);
+
+void char_dict_print(const char_dict *dict);
+
+void char_dict_batch_operation(char_dict *dict, action_to_char_dict_element op);
 
-void *char_dict_find_value(const char *key, const int keylen, dict *dict);
+// Returns the count of elements.
+size_t char_dict_size(const char_dict *dict);
 
-void char_dict_print(const dict *dict);
+// Makes room for @count elements, so that adding them does not trigger rehashing,
+// call it on startup, for it rehashes existing elements at once.
+int char_dict_reserve(char_dict *dict, int count);
 
-void char_dict_batch_operation(dict *dict, action_to_char_dict_element op);
+// Moves elements of an ongoing rehashing into the new table for about @budget_usec microseconds,
+// returns 1 if the rehashing is not finished, or 0 otherwise.
+int char_dict_rehash(char_dict *dict, int budget_usec);
 
 #endif /* __CASDK_FRAMEWORK_CHAR_DICTIONARY_H__ */
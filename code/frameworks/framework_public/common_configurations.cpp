@@ -327,6 +327,58 @@ static int __load_integer_items(
     return RET_OK;
 }
 
+typedef struct optional_integer_item
+{
+    const char *name;
+    int64_t default_value;
+}optional_integer_item;
+
+// Unlike __load_integer_items(), takes the default value of an item missing from common configuration.
+static int __load_optional_integer_items(
+    const config_file_t *config_file,
+    const char *xpath_prefix,
+    const bool from_common,
+    const char *item_parent,
+    const optional_integer_item *items,
+    std::map<std::string, int64_t> &result)
+{
+    std::string full_path;
+
+    for (int i = 0; NULL != items[i].name; ++i)
+    {
+        full_path.clear();
+        full_path.append(xpath_prefix)
+            .append("/")
+            .append(item_parent)
+            .append("/")
+            .append(items[i].name);
+
+        int64_t value = 0;
+        int read_ret = load_unique_config_node_value(config_file, full_path.c_str(), from_common, value);
+
+        if (read_ret < 0)
+        {
+            if (from_common)
+            {
+                QLOGF_NS(I, "cafw", "can not find %s item in common configuration,"
+                    " take the default value: %ld\n", full_path.c_str(), items[i].default_value);
+                result[items[i].name] = items[i].default_value;
+
+                continue;
+            }
+
+            QLOGF_NS(I, "cafw", "can not find %s item in private configuration,"
+                " take the value from common configuration.\n", full_path.c_str());
+
+            continue;
+        }
+
+        result[items[i].name] = value;
+    }
+
+    return RET_OK;
+}
+
 static int __load_timed_task_timeouts(
     const config_file_t *config_file,
     const char *xpath_prefix,
@@ -365,6 +417,7 @@ static int __load_timed_task_intervals(
         XNODE_SESSION_CLEAN,
         XNODE_HEARTBEAT,
         XNODE_LOG_FLUSHING,
+        XNODE_BUF_RECLAIM,
         NULL
     };
 
@@ -387,6 +440,7 @@ static int __load_buffer_settings(
     const char *buf_setting_nodes[] = {
         XNODE_TCP_SEND_BUF,
         XNODE_TCP_RECV_BUF,
+        XNODE_TCP_INITIAL_BUF,
         NULL
     };
 
@@ -412,14 +466,34 @@ static int __load_counters(
         XNODE_WORKER_THREAD,
         NULL
     };
+    const optional_integer_item optional_counter_nodes[] = {
+        { XNODE_MAX_CONNECTION, DEFAULT_MAX_CONNECTION },
+        { XNODE_POLL_EVENT_BATCH, DEFAULT_POLL_EVENT_BATCH },
+        { XNODE_REACTOR_WORKER, DEFAULT_REACTOR_WORKER },
+        { XNODE_LISTEN_BACKLOG, calns::tcp_server::DEFAULT_LISTEN_BACKLOG },
+        { XNODE_MESSAGE_CACHE_SIZE, DEFAULT_MESSAGE_CACHE_SIZE },
+        { XNODE_CONNECTION_CACHE_SIZE, DEFAULT_CONNECTION_CACHE_SIZE },
+        { XNODE_REHASH_USEC_PER_ROUND, DEFAULT_REHASH_USEC_PER_ROUND },
+        { NULL, 0 }
+    };
 
-    return __load_integer_items(
+    if (RET_OK != __load_integer_items(
         config_file,
         xpath_prefix,
         from_common,
         XNODE_COUNTER,
         &(counter_nodes[0]),
         result
+    ))
+        return RET_FAILED;
+
+    return __load_optional_integer_items(
+        config_file,
+        xpath_prefix,
+        from_common,
+        XNODE_COUNTER,
+        &(optional_counter_nodes[0]),
+        result
     );
 }
 
@@ -459,6 +533,8 @@ static int __load_dispatch_settings(
         result[XNODE_DISPATCH_POLICY] = DISPATCHED_RANDOMLY;
     else if (0 == strcmp(value_str, "by-id"))
         result[XNODE_DISPATCH_POLICY] = DISPATCHED_BY_ID;
+    else if (0 == strcmp(value_str, "round-robin"))
+        result[XNODE_DISPATCH_POLICY] = DISPATCHED_ROUND_ROBIN;
     else
         result[XNODE_DISPATCH_POLICY] = DISPATCHED_TO_LEAST_LOAD;
 
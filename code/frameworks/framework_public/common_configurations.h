@@ -88,6 +88,7 @@ enum
     DISPATCHED_RANDOMLY = 0,
     DISPATCHED_BY_ID,
     DISPATCHED_TO_LEAST_LOAD,
+    DISPATCHED_ROUND_ROBIN,
 };
 
 typedef struct net_node_config
@@ -150,11 +151,13 @@ typedef struct mutable_common_config
 #define XNODE_SESSION_CLEAN                         "session-clean"
 #define XNODE_HEARTBEAT                             "heartbeat"
 #define XNODE_LOG_FLUSHING                          "log-flushing"
+#define XNODE_BUF_RECLAIM                           "buffer-reclaim"
 
 #define RELATIVE_XPATH_TIMED_TASK_INTERVAL_MSG_CLEAN        RELATIVE_XPATH_TIMED_TASK_INTERVAL_ROOT "/" XNODE_MSG_CLEAN
 #define RELATIVE_XPATH_TIMED_TASK_INTERVAL_SESSION_CLEAN    RELATIVE_XPATH_TIMED_TASK_INTERVAL_ROOT "/" XNODE_SESSION_CLEAN
 #define RELATIVE_XPATH_TIMED_TASK_INTERVAL_HEARTBEAT        RELATIVE_XPATH_TIMED_TASK_INTERVAL_ROOT "/" XNODE_HEARTBEAT
 #define RELATIVE_XPATH_TIMED_TASK_INTERVAL_LOG_FLUSHING     RELATIVE_XPATH_TIMED_TASK_INTERVAL_ROOT "/" XNODE_LOG_FLUSHING
+#define RELATIVE_XPATH_TIMED_TASK_INTERVAL_BUF_RECLAIM      RELATIVE_XPATH_TIMED_TASK_INTERVAL_ROOT "/" XNODE_BUF_RECLAIM
 
 /*
  * timed task timeouts
@@ -198,6 +201,7 @@ typedef struct mutable_common_config
 #define XNODE_NET_NODE                              "net-node"
 #define XNODE_TCP_SEND_BUF                          "tcp-send"
 #define XNODE_TCP_RECV_BUF                          "tcp-receive"
+#define XNODE_TCP_INITIAL_BUF                       "tcp-initial"
 
 /*
  * counters
@@ -206,6 +210,24 @@ typedef struct mutable_common_config
 #define XNODE_MSG_PROCESS_COUNT_PER_ROUND           "message-processing-per-round"
 #define XNODE_FORWARD_RETRIES_ON_FAILURE            "forward-retries-on-failure"
 #define XNODE_WORKER_THREAD                         "worker-thread"
+#define XNODE_MAX_CONNECTION                        "max-connection"
+#define XNODE_POLL_EVENT_BATCH                      "poll-event-batch"
+#define XNODE_REACTOR_WORKER                        "reactor-worker"
+#define XNODE_LISTEN_BACKLOG                        "listen-backlog"
+#define XNODE_MESSAGE_CACHE_SIZE                    "message-cache-size"
+#define XNODE_CONNECTION_CACHE_SIZE                 "connection-cache-size"
+#define XNODE_REHASH_USEC_PER_ROUND                 "rehash-usec-per-round"
+
+/*
+ * default values of counters which may be left out
+ */
+
+#define DEFAULT_MAX_CONNECTION                      1024
+#define DEFAULT_POLL_EVENT_BATCH                    256
+#define DEFAULT_REACTOR_WORKER                      1
+#define DEFAULT_MESSAGE_CACHE_SIZE                  1024
+#define DEFAULT_CONNECTION_CACHE_SIZE               64
+#define DEFAULT_REHASH_USEC_PER_ROUND               100
 
 /*
  * dispatch relative items
@@ -321,11 +321,38 @@ int config_manager::__load_log_config(void)
     if (0 != strncasecmp("yes", file_log_node[0].attributes["enabled"].c_str(), 3))
     {
         private_config.file_log_enabled = false;
+        private_config.file_log_async = false;
+        private_config.file_log_binary = false;
+        private_config.file_log_mmap = false;
+        private_config.file_log_json = false;
         return RET_OK;
     }
 
     private_config.file_log_enabled = true;
 
+    std::vector<calns::xml::node_t> optional_attr_node;
+
+    // Optional, file I/O is done by the logging thread itself if "async" is missing,
+    // BLOGF() writes text lines as RLOGF() does if "binary" is missing,
+    // lines are buffered by stdio if "mmap" is missing,
+    // and KVLOGF() lines are rendered as text if "json" is missing.
+    read_ret = calns::xml::find_and_parse_nodes(*file, XPATH_LOG_CONFIG_ROOT"/file-logger", 1,
+        optional_attr_node, true, "async", "binary", "mmap", "json", NULL);
+    private_config.file_log_async = (read_ret > 0
+        && 0 == strncasecmp("yes", optional_attr_node[0].attributes["async"].c_str(), 3));
+    private_config.file_log_binary = (read_ret > 0
+        && 0 == strncasecmp("yes", optional_attr_node[0].attributes["binary"].c_str(), 3));
+    private_config.file_log_mmap = (read_ret > 0
+        && 0 == strncasecmp("yes", optional_attr_node[0].attributes["mmap"].c_str(), 3));
+    private_config.file_log_json = (read_ret > 0
+        && 0 == strncasecmp("yes", optional_attr_node[0].attributes["json"].c_str(), 3));
+
+    if (private_config.file_log_async && private_config.file_log_mmap)
+    {
+        LOGF_C(E, "\"async\" and \"mmap\" of the file logger can not be both enabled\n");
+        return RET_FAILED;
+    }
+
     if (load_unique_config_node_value(file, XPATH_LOG_CONFIG_ROOT"/file-logger/level",
         false, private_config.file_log_level) < 0)
     {
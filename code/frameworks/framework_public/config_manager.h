@@ -54,6 +54,10 @@ namespace cafw
 typedef struct private_config
 {
     bool file_log_enabled;
+    bool file_log_async; // writes the log file in a background thread
+    bool file_log_binary; // has a binary log file for BLOGF() besides the text one
+    bool file_log_mmap; // writes the log file through a shared memory mapping, which survives crashes
+    bool file_log_json; // renders KVLOGF() lines as JSON objects in the log file
     std::string basic_log_name;
     std::string log_directory;
     std::string file_log_level;
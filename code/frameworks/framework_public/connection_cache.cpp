@@ -38,14 +38,14 @@ namespace cafw
 
 connection_cache::connection_cache()
     : m_connection_dictionary(NULL)
-    , m_type_group(NULL)
+    , m_type_groups(NULL)
 {
     ;
 }
 
 connection_cache::connection_cache(int dict_size)
     : m_connection_dictionary(NULL)
-    , m_type_group(NULL)
+    , m_type_groups(NULL)
 {
     create(dict_size);
 }
@@ -58,16 +58,16 @@ connection_cache::~connection_cache()
 int connection_cache::create(int dict_size)
 {
     if ((NULL == m_connection_dictionary) &&
-        (NULL == (m_connection_dictionary = char_dict_create(DEFAULT_DICT_SIZE))))
+        (NULL == (m_connection_dictionary = char_dict_create(dict_size))))
     {
         LOGF_C(E, "char_dict_create() failed\n");
         return RET_FAILED;
     }
 
-    if ((NULL == m_type_group) &&
-        (NULL == (m_type_group = new server_group)))
+    if ((NULL == m_type_groups) &&
+        (NULL == (m_type_groups = char_dict_create(DEFAULT_TYPE_COUNT))))
     {
-        LOGF_C(E, "new(ServerGroup) failed\n");
+        LOGF_C(E, "char_dict_create() for server groups failed\n");
         return RET_FAILED;
     }
 
@@ -79,23 +79,49 @@ static void free_connection_dict_value(uint32_t unused_hint, void **val)
     char_dict_release_val((net_conn_index **)val);
 }
 
-void connection_cache::destroy(void)
+static void free_server_group(uint32_t unused_hint, void **val)
 {
-    if (NULL != m_type_group)
-    {
-        delete m_type_group;
-        m_type_group = NULL;
-    }
+    char_dict_release_val((server_group **)val);
+}
 
+void connection_cache::destroy(void)
+{
+    char_dict_destroy(&m_type_groups, free_server_group, NO_FREE_HINT);
     char_dict_destroy(&m_connection_dictionary, free_connection_dict_value, NO_FREE_HINT);
 }
 
+server_group *connection_cache::__find_group(const char *type)
+{
+    return (server_group *)char_dict_find_value(type, strlen(type), m_type_groups);
+}
+
 int connection_cache::add(
     const char *name,
     const int name_len,
-    const net_conn_index *conn,
+    net_conn_index *conn,
     const int conn_len)
 {
+    if (NULL == conn)
+    {
+        LOGF_C(E, "null connection index\n");
+        return RET_FAILED;
+    }
+
+    server_group *group = __find_group(conn->server_type);
+
+    if (NULL == group)
+    {
+        group = char_dict_alloc_val< server_group >();
+        group->next_turn = 0;
+        if (char_dict_add_element(conn->server_type, strlen(conn->server_type), group,
+            sizeof(server_group), m_type_groups) < 0)
+        {
+            LOGF_C(E, "failed to add a group for server type[%s]\n", conn->server_type);
+            char_dict_release_val(&group);
+            return RET_FAILED;
+        }
+    }
+
     // note: a new connection must has a different name, otherwise it would not be added successfully
     if (char_dict_add_element(name, name_len, conn, conn_len, m_connection_dictionary) < 0)
     {
@@ -103,7 +129,11 @@ int connection_cache::add(
         return RET_FAILED;
     }
 
-    m_type_group->insert(std::make_pair(conn->server_type, name));
+    conn->live_pos = -1;
+    conn->in_flight = 0;
+    group->members.push_back(conn);
+    if (NULL != conn->conn_detail)
+        attach(conn, conn->conn_detail);
 
     return RET_OK;
 }
@@ -117,16 +147,17 @@ int connection_cache::del(const char *name, const int name_len)
     }
 
     net_conn_index *conn_index = return_as_index(name, name_len);
+    server_group *group = (NULL == conn_index) ? NULL : __find_group(conn_index->server_type);
 
-    if (NULL != conn_index)
+    if (NULL != group)
     {
-        std::pair<server_group_iter, server_group_iter> group = m_type_group->equal_range(conn_index->server_type);
-
-        for (server_group_iter it = group.first; it != group.second; ++it)
+        detach(conn_index);
+        for (size_t i = 0; i < group->members.size(); ++i)
         {
-            if (name == it->second)
+            if (conn_index == group->members[i])
             {
-                m_type_group->erase(it);
+                group->members[i] = group->members.back();
+                group->members.pop_back();
                 break;
             }
         }
@@ -135,6 +166,46 @@ int connection_cache::del(const char *name, const int name_len)
     return char_dict_delete_element(name, name_len, m_connection_dictionary, free_connection_dict_value, NO_FREE_HINT);
 }
 
+void connection_cache::attach(net_conn_index *conn, calns::net_connection *detail)
+{
+    if (NULL == conn || NULL == detail)
+        return;
+
+    conn->fd = detail->fd;
+    conn->conn_detail = detail;
+
+    server_group *group = __find_group(conn->server_type);
+
+    if (NULL == group || conn->live_pos >= 0) // not added yet, or attached already
+        return;
+
+    conn->live_pos = group->live.size();
+    conn->in_flight = 0;
+    group->live.push_back(conn);
+}
+
+void connection_cache::detach(net_conn_index *conn)
+{
+    if (NULL == conn)
+        return;
+
+    conn->fd = calns::INVALID_SOCK_FD;
+    conn->conn_detail = NULL;
+
+    server_group *group = __find_group(conn->server_type);
+
+    if (NULL == group || conn->live_pos < 0)
+        return;
+
+    // Fills the hole with the last one, so that the array stays dense.
+    net_conn_index *last = group->live.back();
+
+    group->live[conn->live_pos] = last;
+    last->live_pos = conn->live_pos;
+    group->live.pop_back();
+    conn->live_pos = -1;
+}
+
 net_conn_index* connection_cache::return_as_index(const char *name, const int name_len)
 {
     return (net_conn_index *)char_dict_find_value(name, name_len, m_connection_dictionary);
@@ -145,6 +216,43 @@ dict_entry_ptr connection_cache::return_as_entry(const char *name, const int nam
     return (dict_entry_ptr)char_dict_find_iterator(name, name_len, m_connection_dictionary);
 }
 
+int connection_cache::reserve(int count)
+{
+    return char_dict_reserve(m_connection_dictionary, count);
+}
+
+int connection_cache::rehash(int budget_usec)
+{
+    return char_dict_rehash(m_connection_dictionary, budget_usec);
+}
+
+// Picks the one with the fewest messages in flight, and then the fewest bytes waiting to be sent.
+net_conn_index *connection_cache::__pick_least_load(const std::vector<net_conn_index *> &candidates)
+{
+    net_conn_index *target = NULL;
+    int target_pending_bytes = 0;
+
+    for (size_t i = 0; i < candidates.size(); ++i)
+    {
+        net_conn_index *conn_index = candidates[i];
+        calns::net_connection *conn_detail = conn_index->conn_detail;
+        int pending_bytes = (NULL == conn_detail) ? 0 : conn_detail->queued_bytes;
+
+        if (NULL != conn_detail && NULL != conn_detail->send_buf)
+            pending_bytes += conn_detail->send_buf->data_size();
+
+        if (NULL == target ||
+            conn_index->in_flight < target->in_flight ||
+            (conn_index->in_flight == target->in_flight && pending_bytes < target_pending_bytes))
+        {
+            target = conn_index;
+            target_pending_bytes = pending_bytes;
+        }
+    }
+
+    return target;
+}
+
 net_conn_index* connection_cache::pick_one_connection(const char *type, int policy, int id, bool pick_alive_only/* = true*/)
 {
     if (NULL == type)
@@ -153,90 +261,31 @@ net_conn_index* connection_cache::pick_one_connection(const char *type, int poli
         return NULL;
     }
 
-    std::string type_str(type);
-    int node_count = m_type_group->count(type_str);
+    server_group *group = __find_group(type);
+    const std::vector<net_conn_index *> *candidates = (NULL == group)
+        ? NULL
+        : (pick_alive_only ? &(group->live) : &(group->members));
+    size_t node_count = (NULL == candidates) ? 0 : candidates->size();
 
     if (0 == node_count)
     {
-        LOGF_C(E, "0 nodes of type[%s]\n", type);
+        LOGF_C(E, "0 %snodes of type[%s]\n", pick_alive_only ? "alive " : "", type);
         return NULL;
     }
 
-    std::pair<server_group_iter, server_group_iter> group = m_type_group->equal_range(type_str);
     static unsigned int s_rand_seed = time(NULL);
-    int node_offset = (SEND_POLICY_BY_ID == policy)
-        ? (abs(id) % node_count)
-        : (rand_r(&s_rand_seed) % node_count);
-    bool uses_offset = true; // that is: picking a connection randomly at first time.
-    int offset_count = 0;
-    net_conn_index *target = NULL;
 
-SEARCH_CYCLE:
-
-    for (server_group_iter it = group.first; it != group.second; ++it)
+    switch (policy)
     {
-        int current_offset = offset_count++;
-
-        if (uses_offset && current_offset < node_offset)
-            continue;
-
-        const char *serv_name = it->second.c_str();
-
-        net_conn_index *conn_index = return_as_index(serv_name, strlen(serv_name));
-
-        if (NULL == conn_index)
-        {
-            LOGF_C(W, "can not find connection index of server[%s]\n", serv_name);
-
-            if (uses_offset)
-            {
-                uses_offset = false; // gives up random selection
-                offset_count = 0;
-                if (node_count > 1)
-                    goto SEARCH_CYCLE; // and does searching from the beginning until finds an available one
-                else
-                    return NULL;
-            }
-            else
-            {
-                LOGF_C(I, "continue to find next one of the same type ...\n");
-                continue;
-            }
-        }
-
-        if (!pick_alive_only)
-        {
-            target = conn_index;
-            break;
-        }
-
-        calns::net_connection *conn_detail = conn_index->conn_detail;
-
-        if (NULL == conn_detail)
-        {
-            LOGF_C(W, "can not find connection detail of server[%s]\n", serv_name);
-
-            if (uses_offset)
-            {
-                uses_offset = false;
-                offset_count = 0;
-                if (node_count > 1)
-                    goto SEARCH_CYCLE;
-                else
-                    return NULL;
-            }
-            else
-            {
-                LOGF_C(I, "continue to find next one of the same type ...\n");
-                continue;
-            }
-        }
-
-        target = conn_index;
-        break;
+    case SEND_POLICY_BY_ID:
+        return (*candidates)[abs(id) % node_count];
+    case SEND_POLICY_TO_LEAST_LOAD:
+        return __pick_least_load(*candidates);
+    case SEND_POLICY_ROUND_ROBIN:
+        return (*candidates)[(group->next_turn++) % node_count];
+    default:
+        return (*candidates)[rand_r(&s_rand_seed) % node_count];
     }
-
-    return target;
 }
 
 void connection_cache::do_batch_operation(action_to_char_dict_element op)
@@ -294,13 +343,14 @@ int connection_cache::send_to_connections_by_type(const char *type,
 
         const char *target_server = target_conn->conn_detail->peer_name;
         int target_fd = target_conn->conn_detail->fd;
-        int ret = calns::tcp_base::send_fragment(target_fd, msg, msg_len);
+        int ret = calns::tcp_base::send_to_connection(target_conn->conn_detail, msg, msg_len);
 
         if (ret < 0)
         {
             LOGF_C(E, "failed to send message to node[%s], ret = %d\n", target_server, ret);
             return RET_FAILED;
         }
+        ++(target_conn->in_flight);
 
         LOGF_C(I, "message sent to a node [name: %s, ip: %s, port: %u, fd: %d] successfully,"
             " expected bytes = %d, actual bytes = %d\n",
@@ -309,52 +359,44 @@ int connection_cache::send_to_connections_by_type(const char *type,
         return ret;
     }
 
-    const char *serv_name = NULL;
     int ok_count = 0;
     int bytes_sent = 0;
-    std::string type_str(type);
-    std::pair<server_group_iter, server_group_iter> group = m_type_group->equal_range(type_str);
+    server_group *group = __find_group(type);
+    // Copied once and shared by all receivers, whose send queues are flushed by the event loop.
+    calns::shared_packet *packet = calns::create_shared_packet(msg, msg_len);
+
+    if (NULL == packet)
+    {
+        LOGF_C(E, "failed to create a shared packet of %d bytes\n", msg_len);
+        return RET_FAILED;
+    }
 
     LOGF_C(I, "about to send message to servers of type[%s],"
         " max receiver count: %d, to all or not: %d\n", type, max_conn_count, to_all);
 
-    for (server_group_iter it = group.first; it != group.second; ++it)
+    for (size_t i = 0; NULL != group && i < group->live.size() && ok_count < max_conn_count; ++i)
     {
-        serv_name = it->second.c_str();
-
-        net_conn_index *conn_index = return_as_index(serv_name, strlen(serv_name));
-
-        if (NULL == conn_index)
-            continue;
-
+        net_conn_index *conn_index = group->live[i];
         calns::net_connection *conn_detail = conn_index->conn_detail;
-
-        if (NULL == conn_detail)
-        {
-            LOGF_C(E, "server[%s] is in an invalid status\n", serv_name);
-            continue;
-        }
-
-        int fd = conn_detail->fd;
-        int ret = calns::tcp_base::send_fragment(fd, msg, msg_len);
+        int ret = calns::tcp_base::enqueue_to_connection(conn_detail, packet);
 
         if (ret < 0)
         {
-            LOGF_C(E, "failed to send message to node[%s], ret = %d\n", serv_name, ret);
+            LOGF_C(E, "failed to queue message to node[%s], ret = %d\n", conn_detail->peer_name, ret);
             continue;
         }
-        else
-        {
-            LOGF_C(I, "message sent to node [name: %s, ip: %s, port: %u, fd: %d] successfully,"
-                " expected bytes = %d, actual bytes = %d\n",
-                serv_name, conn_index->peer_ip, conn_index->peer_port, fd, msg_len, ret);
-            ++ok_count;
-            bytes_sent += ret;
-            if (ok_count >= max_conn_count)
-                break;
-        }
+
+        LOGF_C(I, "message queued to node [name: %s, ip: %s, port: %u, fd: %d] successfully,"
+            " bytes = %d, bytes queued = %d\n",
+            conn_detail->peer_name, conn_index->peer_ip, conn_index->peer_port, conn_detail->fd,
+            msg_len, conn_detail->queued_bytes);
+        ++(conn_index->in_flight);
+        ++ok_count;
+        bytes_sent += ret;
     }
 
+    calns::release_shared_packet(&packet);
+
     if (ok_count <= 0)
     {
         LOGF_C(E, "! ! ! ! ! all servers of type[%s] dead or not found\n", type);
@@ -389,13 +431,14 @@ int connection_cache::send_to_single_connection(const char *name, const void *ms
     }
 
     int fd = conn_detail->fd;
-    int ret = calns::tcp_base::send_fragment(fd, msg, msg_len);
+    int ret = calns::tcp_base::send_to_connection(conn_detail, msg, msg_len);
     if (ret < 0)
     {
         LOGF_C(E, "failed to send message to node[%s], ret = %d\n", name, ret);
         return RET_FAILED;
     }
 
+    ++(conn_index->in_flight);
     LOGF_C(I, "message sent to node [name: %s, ip: %s, port: %u, fd: %d] successfully,"
         " expected bytes = %d, actual bytes = %d\n",
         name, conn_index->peer_ip, conn_index->peer_port, fd, msg_len, ret);
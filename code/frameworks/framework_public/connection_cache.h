@@ -40,6 +40,7 @@
 #include <string.h>
 
 #include <map>
+#include <vector>
 
 #include "base/all.h"
 #include "char_dictionary.h"
@@ -68,10 +69,19 @@ typedef struct net_conn_index
     calns::net_connection *conn_detail;
     int fd;
     net_conn_attr attribute;
+    // Fields below are maintained by connection_cache.
+    int live_pos; // position in server_group::live, or -1 if not connected
+    // Messages sent via connection_cache minus packets received, a hint of how busy the peer is.
+    uint32_t in_flight;
 }net_conn_index;
 
-typedef std::multimap<std::string, std::string> server_group; // <server type, server name>
-typedef server_group::iterator server_group_iter;
+// All nodes of a server type, in dense arrays so that picking one takes O(1) time.
+typedef struct server_group
+{
+    std::vector<net_conn_index *> members;
+    std::vector<net_conn_index *> live; // connected members, in no particular order
+    unsigned int next_turn; // for round-robin
+}server_group;
 
 class connection_cache
 {
@@ -108,7 +118,13 @@ public:
     {
         SEND_POLICY_RANDOMLY = 0,
         SEND_POLICY_BY_ID,
-        SEND_POLICY_TO_LEAST_LOAD
+        SEND_POLICY_TO_LEAST_LOAD,
+        SEND_POLICY_ROUND_ROBIN
+    };
+
+    enum
+    {
+        DEFAULT_TYPE_COUNT = 16
     };
 
 /* ===================================
@@ -117,10 +133,16 @@ public:
 public:
     int create(int dict_size = DEFAULT_DICT_SIZE);
     void destroy(void);
-    int add(const char *name, const int name_len, const net_conn_index *conn, const int conn_len);
+    int add(const char *name, const int name_len, net_conn_index *conn, const int conn_len);
     int del(const char *name, const int name_len);
+    // Mark a node connected or disconnected, use them instead of assigning fd and conn_detail.
+    void attach(net_conn_index *conn, calns::net_connection *detail);
+    void detach(net_conn_index *conn);
     net_conn_index* return_as_index(const char *name, const int name_len);
     dict_entry_ptr return_as_entry(const char *name, const int name_len);
+    // See char_dict_reserve() and char_dict_rehash().
+    int reserve(int count);
+    int rehash(int budget_usec);
     net_conn_index* pick_one_connection(const char *type, int policy, int route_id, bool pick_alive_only = true);
     void do_batch_operation(action_to_char_dict_element op);
     void profile(void);
@@ -156,13 +178,15 @@ public:
  * private methods:
  * =================================== */
 protected:
+    server_group *__find_group(const char *type);
+    static net_conn_index *__pick_least_load(const std::vector<net_conn_index *> &candidates);
 
 /* ===================================
  * data:
  * =================================== */
 protected:
-    dict *m_connection_dictionary;
-    server_group *m_type_group;
+    char_dict *m_connection_dictionary;
+    char_dict *m_type_groups; // <server type, server_group>
 };
 
 typedef connection_cache conn_cache;
@@ -56,6 +56,13 @@ int main(int argc, char **argv)
         fprintf(stderr, "**** Errors occurred while loading configurations.\n");
         return -1;
     }
+#endif
+#if defined(HAS_CONFIG_FILES) && defined(ACCEPTS_CLIENTS)
+    if (app->spawn_reactor_workers() < 0)
+    {
+        fprintf(stderr, "**** Errors occurred while spawning reactor workers.\n");
+        return -1;
+    }
 #endif
     if (app->prepare_resources() < 0)
     {
@@ -32,6 +32,9 @@
 #include <stdlib.h>
 #include <unistd.h>
 #include <signal.h>
+#include <errno.h>
+#include <sys/prctl.h>
+#include <sys/wait.h>
 
 #include <sstream>
 
@@ -268,6 +271,7 @@ int main_app::parse_command_line(int argc, char **argv)
         //google::protobuf::ShutdownProtobufLibrary();
 
         calns::daemon::daemonize();
+        refresh_screen_logger();
     }
 
     return RET_OK;
@@ -299,6 +303,66 @@ int main_app::load_configurations(void)
 }
 #endif
 
+#if defined(HAS_CONFIG_FILES) && defined(ACCEPTS_CLIENTS)
+int main_app::spawn_reactor_workers(void)
+{
+    const int kWorkerCount = CFG_GET_COUNTER(XNODE_REACTOR_WORKER);
+    const pid_t kParentPid = getpid();
+
+    if (kWorkerCount <= 1)
+        return RET_OK;
+
+    // Avoids the pending outputs being flushed once more by every child.
+    fflush(NULL);
+
+    for (int i = 1; i < kWorkerCount; ++i)
+    {
+        pid_t pid = fork();
+
+        if (pid < 0)
+        {
+            LOGF_C(E, "failed to fork reactor worker[%d], errno = %d\n", i, errno);
+            stop_reactor_workers();
+            return RET_FAILED;
+        }
+
+        if (0 == pid)
+        {
+            // A worker should not outlive its parent,
+            // and the parent may have exited before prctl() is called.
+            if (prctl(PR_SET_PDEATHSIG, SIGTERM) < 0 || getppid() != kParentPid)
+                _exit(EXIT_FAILURE);
+
+            m_reactor_worker_pids.clear();
+            QLOGF_C(I, "reactor worker[%d] started, pid = %d\n", i, getpid());
+
+            return RET_OK;
+        }
+
+        m_reactor_worker_pids.push_back(pid);
+    }
+
+    QLOGF_C(I, "%d reactor worker(s) spawned\n", kWorkerCount - 1);
+
+    return RET_OK;
+}
+
+void main_app::stop_reactor_workers(void)
+{
+    for (size_t i = 0; i < m_reactor_worker_pids.size(); ++i)
+    {
+        kill(m_reactor_worker_pids[i], SIGTERM);
+    }
+
+    for (size_t i = 0; i < m_reactor_worker_pids.size(); ++i)
+    {
+        waitpid(m_reactor_worker_pids[i], NULL, 0);
+    }
+
+    m_reactor_worker_pids.clear();
+}
+#endif
+
 int main_app::prepare_resources(void)
 {
     const config_content_t *config = NULL;
@@ -318,6 +382,14 @@ int main_app::prepare_resources(void)
         LOGF_C(E, "PacketProcessor::BuildComponentMap() failed\n");
         return RET_FAILED;
     }
+#if defined(HAS_CONFIG_FILES)
+    // Sized once on startup, rather than growing while peak traffic comes.
+    if (m_packet_processor->get_message_cache()->reserve(CFG_GET_COUNTER(XNODE_MESSAGE_CACHE_SIZE)))
+    {
+        LOGF_C(E, "message_cache::reserve() failed\n");
+        return RET_FAILED;
+    }
+#endif
 #endif
 
     return RET_OK;
@@ -386,6 +458,10 @@ timed_task_info_t g_built_in_timed_tasks[] = {
         XNODE_LOG_FLUSHING,
         { timed_task_config::TRIGGERED_PERIODICALLY,   true,   {0},    {1000},    default_log_flushing_timed_task }
     },
+    {
+        XNODE_BUF_RECLAIM,
+        { timed_task_config::TRIGGERED_PERIODICALLY,   true,   {0},    {60000},   default_buffer_reclaim_timed_task }
+    },
     {
         NULL,
         {}
@@ -467,6 +543,12 @@ int main_app::run_business(void)
 
 #endif // defined(HAS_TCP)
 
+#if defined(HAS_CONFIG_FILES)
+    const int kRehashUsecPerRound = CFG_GET_COUNTER(XNODE_REHASH_USEC_PER_ROUND);
+#else
+    const int kRehashUsecPerRound = 0;
+#endif
+
     fprintf(stdout, "%s started successfully, version: %s, pid: %d\n",
         m_cmdline->program_name(), MODULE_VERSION, getpid());
 
@@ -496,6 +578,8 @@ int main_app::run_business(void)
 
         m_timed_task_scheduler->check_and_execute();
 
+        rehash_dictionaries(kRehashUsecPerRound);
+
         ret = run_private_business(should_exit);
         if (should_exit) break;
     }
@@ -503,8 +587,38 @@ int main_app::run_business(void)
     return ret;
 }
 
+void main_app::rehash_dictionaries(int budget_usec)
+{
+    if (budget_usec <= 0)
+        return;
+
+    const resource_t *res = m_resource_manager->resource();
+
+    if (NULL != res)
+    {
+        connection_cache *conn_caches[] = { res->master_connection_cache, res->slave_connection_cache };
+
+        for (size_t i = 0; i < sizeof(conn_caches) / sizeof(connection_cache *); ++i)
+        {
+            if (NULL != conn_caches[i])
+                conn_caches[i]->rehash(budget_usec);
+        }
+    }
+
+#if defined(HAS_TCP)
+    message_cache *msg_cache = m_packet_processor->get_message_cache();
+
+    if (NULL != msg_cache)
+        msg_cache->rehash(budget_usec);
+#endif
+}
+
 void main_app::release_resources(void)
 {
+#if defined(HAS_CONFIG_FILES) && defined(ACCEPTS_CLIENTS)
+    stop_reactor_workers();
+#endif
+
     if (NULL != m_resource_manager)
         m_resource_manager->clean();
 
@@ -548,29 +662,53 @@ void main_app::poll_and_process(calns::tcp_base *tcp_manager, bool &should_exit)
         else
         {
             calns::net_connection *conn = (calns::net_connection*)(active_peer_array->elements[i].data.ptr);
-            int recv_ret = tcp_manager->recv_to_connection(conn);
 
-            if (recv_ret < 0)
+            if (calns::CONN_STATUS_CONNECTING == conn->conn_status)
             {
-                LOGF_C(E, "failed to received packets and put them into connection[%d],"
-                    " ret = %d, err = %s\n", conn->fd, recv_ret, calns::what(recv_ret).c_str());
+                finish_connecting(tcp_manager, conn);
+                continue;
+            }
+
+            // In edge-triggered mode, the socket is drained as much as possible, and if the receive buffer
+            // becomes full before that, packets are handled to make room and then the draining continues.
+            int drain_rounds = tcp_manager->is_edge_triggered() ? kMaxHandleCountPerCycle : 1;
+            bool conn_shut = false;
 
-                if (CA_RET(CONNECTION_BROKEN) == recv_ret)
+            do
+            {
+                int recv_ret = tcp_manager->receive(conn);
+
+                if (recv_ret < 0)
                 {
-                    shut_bad_connection(tcp_manager, conn);
-                    continue;
+                    LOGF_C_RATE_LIMITED(E, 10, "failed to received packets and put them into connection[%d],"
+                        " ret = %d, err = %s\n", conn->fd, recv_ret, calns::what(recv_ret).c_str());
+
+                    if (CA_RET(CONNECTION_BROKEN) == recv_ret)
+                    {
+                        shut_bad_connection(tcp_manager, conn);
+                        conn_shut = true;
+                        break;
+                    }
+                }
+                else
+                {
+                    if (recv_ret > 0)
+                        RLOGF(D, "%d bytes received\n", recv_ret);
                 }
-            }
-            else
-            {
-                if (recv_ret > 0)
-                    RLOGF(D, "%d bytes received\n", recv_ret);
-            }
 
-            if (conn->recv_buf->empty())
-                continue;
+                if (conn->recv_buf->empty())
+                    break;
+
+                int data_len_before = conn->recv_buf->data_size();
+
+                handle_received_packets(conn, kMaxHandleCountPerCycle);
 
-            handle_received_packets(conn, kMaxHandleCountPerCycle);
+                if (conn->recv_buf->data_size() >= data_len_before) // no room made, try it next round
+                    break;
+            } while (conn->is_still_readable && --drain_rounds > 0);
+
+            if (!conn_shut && conn->is_still_readable)
+                tcp_manager->rearm_connection(conn); // or it will never be reported again
         }
     }
 
@@ -579,30 +717,61 @@ void main_app::poll_and_process(calns::tcp_base *tcp_manager, bool &should_exit)
 
 int main_app::accept_new_connection(calns::tcp_server *tcp_server, int send_buf_size, int recv_buf_size)
 {
-    int accfd = tcp_server->accept_new_connection(send_buf_size, recv_buf_size);
+    std::vector<int> new_fds;
+    // Takes all pending connections at once, or the backlog may overflow during a connection storm.
+    int accept_ret = tcp_server->accept_new_connections(send_buf_size, recv_buf_size, &new_fds);
 
-    if (accfd < 0)
+    if (accept_ret < 0)
     {
-        LOGF_C(E, "failed to accept new connection, ret = %d, err = %s\n", accfd, calns::what(accfd).c_str());
+        LOGF_C(E, "failed to accept new connection, ret = %d, err = %s\n", accept_ret, calns::what(accept_ret).c_str());
 
         return RET_FAILED;
     }
 
     calns::tcp_base::conn_map *all_peers = tcp_server->peers();
-    calns::net_connection *new_conn = (*all_peers)[accfd];
 
-    snprintf(new_conn->self_name, sizeof(new_conn->self_name), "%s", tcp_server->self_name());
+    for (size_t i = 0; i < new_fds.size(); ++i)
+    {
+        int accfd = new_fds[i];
+        calns::net_connection *new_conn = (*all_peers)[accfd];
+
+        snprintf(new_conn->self_name, sizeof(new_conn->self_name), "%s", tcp_server->self_name());
 
-    RLOGF(I, "new connection[%d] arrived: fd[%d] | self_ip[%s] | self_port[%u] | self_name[%s]"
-        " | peer_ip[%s] | peer_port[%u] | peer_name[%s] | status[0x%08X]"
-        " | is_blocking[%d] | is_validated[%d] | send_buffer[%d bytes] | recv_buffer[%d bytes]\n",
-        accfd, new_conn->fd, new_conn->self_ip, new_conn->self_port, new_conn->self_name,
-        new_conn->peer_ip, new_conn->peer_port, new_conn->peer_name, new_conn->conn_status,
-        new_conn->is_blocking, new_conn->is_validated, new_conn->send_buf->total_size(), new_conn->recv_buf->total_size());
+        KVLOGF(I, "new connection arrived", "fd", new_conn->fd,
+            "self_ip", new_conn->self_ip, "self_port", new_conn->self_port, "self_name", new_conn->self_name,
+            "peer_ip", new_conn->peer_ip, "peer_port", new_conn->peer_port, "peer_name", new_conn->peer_name,
+            "status", new_conn->conn_status, "is_blocking", new_conn->is_blocking, "is_validated", new_conn->is_validated,
+            "send_buffer", new_conn->send_buf->total_size(), "recv_buffer", new_conn->recv_buf->total_size());
+    }
 
     return RET_OK;
 }
 
+void main_app::finish_connecting(calns::tcp_base *tcp_manager, calns::net_connection *conn)
+{
+    calns::tcp_client *tcp_client = dynamic_cast<calns::tcp_client *>(tcp_manager);
+
+    if (NULL == tcp_client)
+    {
+        LOGF_C(W, "this connection node is not a client, can not connect, fd = %d\n", conn->fd);
+        return;
+    }
+
+    int ret = tcp_client->finish_connecting(conn);
+
+    if (ret < 0)
+    {
+        RLOGF(E, "! ! ! ! ! connection to [%s][%s:%u] failed, ret = %d, msg = %s\n",
+            conn->peer_name, conn->peer_ip, conn->peer_port, ret, calns::what(ret).c_str());
+        shut_bad_connection(tcp_manager, conn);
+        return;
+    }
+
+    RLOGF(I, "~ ~ ~ ~ ~ connection to [%s][%s:%u] successful, fd = %d, local address = [%s:%u]\n",
+        conn->peer_name, conn->peer_ip, conn->peer_port, conn->fd, conn->self_ip, conn->self_port);
+    // Greetings have been held since connecting started, see update_connection_status() in timed_task_scheduler.cpp.
+}
+
 void main_app::shut_bad_connection(calns::tcp_base *tcp_manager, calns::net_connection *bad_conn)
 {
     LOGF_C(W, "peer shut down, fd = %d, name = %s, ip = %s, port = %u\n",
@@ -614,10 +783,14 @@ void main_app::shut_bad_connection(calns::tcp_base *tcp_manager, calns::net_conn
     if (NULL != owner
         && NULL != (conn_index = (net_conn_index*)GET_CHAR_DICT_VALUE(owner)))
     {
+        const resource_t *res = m_resource_manager->resource();
+        connection_cache *conn_cache = conn_index->attribute.is_master
+            ? res->master_connection_cache
+            : res->slave_connection_cache;
+
         RLOGF(I, "found connection cache info of this node, name is [%s],"
             " cleaned up cache info\n", GET_CHAR_DICT_KEY(owner));
-        conn_index->fd = calns::INVALID_SOCK_FD;
-        conn_index->conn_detail = NULL;
+        conn_cache->detach(conn_index);
     }
 
     tcp_manager->shutdown_connection(bad_conn);
@@ -655,6 +828,13 @@ void main_app::handle_received_packets(calns::net_connection *input_conn, int ma
         {
             in_buf->move_read_pointer(bytes_handled);
             input_conn->last_op_time = calns::time_util::get_utc_microseconds();
+
+            // A packet from an upstream server answers one sent to it, see connection_cache::pick_one_connection().
+            dict_entry_ptr owner = (dict_entry_ptr)(input_conn->owner);
+            net_conn_index *source = (NULL == owner) ? NULL : (net_conn_index *)GET_CHAR_DICT_VALUE(owner);
+
+            if (NULL != source && source->is_server && source->in_flight > 0)
+                --(source->in_flight);
         }
 
         RLOGF(D, "%d bytes input handled, %d bytes output generated\n", bytes_handled, bytes_output);
@@ -666,6 +846,7 @@ void main_app::handle_received_packets(calns::net_connection *input_conn, int ma
         calns::buffer *out_buf = actual_output_conn->send_buf;
 
         out_buf->move_write_pointer(bytes_output);
+        calns::mark_send_pending(*actual_output_conn); // to be sent by send_result_packets()
         actual_output_conn->last_op_time = calns::time_util::get_utc_microseconds();
 
         RLOGF(D, "loading packets into output connection{ fd[%d] | name[%s] }.send_buf: %d bytes free,"
@@ -680,16 +861,14 @@ void main_app::handle_received_packets(calns::net_connection *input_conn, int ma
 
 void main_app::send_result_packets(calns::tcp_base *tcp_manager)
 {
-    calns::tcp_base::conn_map *all_peers = tcp_manager->peers();
+    calns::net_connection *next = NULL;
 
-    for (calns::tcp_base::conn_map::iterator iter = all_peers->begin(); iter != all_peers->end(); ++iter)
+    // Only peers with data left to send are visited, and each leaves the list once drained.
+    for (calns::net_connection *conn = tcp_manager->send_pending_head(); NULL != conn; conn = next)
     {
-        calns::net_connection *conn = iter->second;
-
-        if (NULL == conn)
-            continue;
+        next = conn->pending_next;
 
-        if (conn->send_buf->empty())
+        if (calns::CONN_STATUS_CONNECTING == conn->conn_status)
             continue;
 
         int ret = 0;
@@ -697,7 +876,7 @@ void main_app::send_result_packets(calns::tcp_base *tcp_manager)
         if ((ret = tcp_manager->send_from_connection(conn)) < 0)
         {
             LOGF_C(E, "failed to send contents of connection[%d], ret = %d, err = %s\n",
-                iter->first, ret, calns::what(ret).c_str());
+                conn->fd, ret, calns::what(ret).c_str());
         }
         else
             RLOGF(D, "%d bytes sent\n", ret);
@@ -37,6 +37,10 @@
 #ifndef __CASDK_FRAMEWORK_MAIN_APP_H__
 #define __CASDK_FRAMEWORK_MAIN_APP_H__
 
+#include <sys/types.h>
+
+#include <vector>
+
 #include "base/all.h"
 
 namespace cafw
@@ -82,6 +86,12 @@ public:
     int parse_command_line(int argc, char **argv);
 #if defined(HAS_CONFIG_FILES)
     int load_configurations(void);
+#endif
+#if defined(HAS_CONFIG_FILES) && defined(ACCEPTS_CLIENTS)
+    // Forks (reactor-worker - 1) worker processes, each of which then prepares
+    // its own listener (bound with SO_REUSEPORT), upstream connections and loggers,
+    // and runs its own event loop. Must be called before prepare_resources().
+    int spawn_reactor_workers(void);
 #endif
     int prepare_resources(void);
     int register_signals(void);
@@ -114,10 +124,18 @@ protected:
 #if defined(HAS_TCP)
     void poll_and_process(calns::tcp_base *tcp_manager, bool &should_exit);
     int accept_new_connection(calns::tcp_server *tcp_server, int send_buf_size, int recv_buf_size);
+    // Completes an asynchronous connect() reported by poll(), see tcp_client::start_connecting().
+    void finish_connecting(calns::tcp_base *tcp_manager, calns::net_connection *conn);
     void shut_bad_connection(calns::tcp_base *tcp_manager, calns::net_connection *bad_conn);
     void handle_received_packets(calns::net_connection *input_conn, int max_packet_count);
     void send_result_packets(calns::tcp_base *tcp_manager);
 #endif
+#if defined(HAS_CONFIG_FILES) && defined(ACCEPTS_CLIENTS)
+    void stop_reactor_workers(void);
+#endif
+    // Moves elements of each dictionary being rehashed for about @budget_usec microseconds,
+    // so that growing a dictionary never stalls a round of polling.
+    void rehash_dictionaries(int budget_usec);
 
 /* ===================================
  * data:
@@ -128,6 +146,9 @@ private:
     resource_manager *m_resource_manager;
     timed_task_scheduler *m_timed_task_scheduler;
     packet_processor *m_packet_processor;
+#if defined(HAS_CONFIG_FILES) && defined(ACCEPTS_CLIENTS)
+    std::vector<pid_t> m_reactor_worker_pids;
+#endif
 };
 
 }
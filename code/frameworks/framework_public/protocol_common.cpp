@@ -305,7 +305,7 @@ int serialize_to_buffer(const int32_t out_cmd,
     return RET_OK;
 }
 
-int send_lite_packet(const int fd,
+int send_lite_packet(struct calns::net_connection *conn,
     const int32_t cmd,
     const int32_t errcode,
     const msg_base *msg_body,
@@ -313,8 +313,8 @@ int send_lite_packet(const int fd,
     const bool is_final_fragment/* = true*/,
     const int16_t packet_num/* = 1*/)
 {
-    if (fd < 0)
-        return CA_RET(INVALID_PARAM_VALUE);
+    if (NULL == conn)
+        return CA_RET(NULL_PARAM);
 
     char data[16 * 1024] = {0};
     proto_header_t header;
@@ -330,7 +330,7 @@ int send_lite_packet(const int fd,
     fill_proto_header(header, body_len, cmd, errcode, route_id, packet_num, is_final_fragment);
     assemble_header(&header, data);
 
-    return calns::tcp_base::send_fragment(fd, data, header.length);
+    return calns::tcp_base::send_to_connection(conn, data, header.length);
 }
 
 int send_lite_packet(const char *node_type,
@@ -401,22 +401,22 @@ int send_lite_packet(const char *node_type,
 
 #if defined(HAS_TCP)
 
-int send_heartbeat_request(const int fd)
+int send_heartbeat_request(struct calns::net_connection *conn)
 {
-    if (fd < 0)
+    if (NULL == conn)
     {
-        LOGF_NS(E, "cafw", "fd < 0\n");
+        LOGF_NS(E, "cafw", "null connection\n");
         return RET_FAILED;
     }
 
-    return send_lite_packet(fd, CMD_HEARTBEAT_REQ, PROTO_RET_SUCCESS, NULL);
+    return send_lite_packet(conn, CMD_HEARTBEAT_REQ, PROTO_RET_SUCCESS, NULL);
 }
 
-int send_identity_report_request(const int fd)
+int send_identity_report_request(struct calns::net_connection *conn)
 {
-    if (fd < 0)
+    if (NULL == conn)
     {
-        LOGF_NS(E, "cafw", "fd < 0\n");
+        LOGF_NS(E, "cafw", "null connection\n");
         return RET_FAILED;
     }
 
@@ -452,7 +452,22 @@ int send_identity_report_request(const int fd)
 
 #endif // #ifndef USE_JSON_MSG
 
-    return send_lite_packet(fd, cmd, PROTO_RET_SUCCESS, &msg);
+    return send_lite_packet(conn, cmd, PROTO_RET_SUCCESS, &msg);
+}
+
+void send_upstream_greetings(struct calns::net_connection *conn)
+{
+    int ret = 0;
+
+    LOGF_NS(I, "cafw", "identity report request to: [%s][%s:%u]\n",
+        conn->peer_name, conn->peer_ip, conn->peer_port);
+    if ((ret = send_identity_report_request(conn)) < 0)
+        LOGF_NS(E, "cafw", "failed to send identity report request, ret = %d\n", ret);
+
+    LOGF_NS(D, "cafw", "^~^~^~^~ request to: [%s][%s:%u]\n",
+        conn->peer_name, conn->peer_ip, conn->peer_port);
+    if ((ret = send_heartbeat_request(conn)) < 0)
+        LOGF_NS(E, "cafw", "failed to send heart-beat request, ret = %d\n", ret);
 }
 
 #endif // #if defined(HAS_TCP)
@@ -505,7 +505,9 @@ int serialize_to_buffer(const int32_t out_cmd,
     const bool is_final_fragment = true,
     const int16_t packet_num = 1);
 
-int send_lite_packet(const int fd,
+// Sends a packet to @conn through tcp_base::send_to_connection(),
+// so that it stays in order with data buffered or queued before it.
+int send_lite_packet(struct calns::net_connection *conn,
     const int32_t cmd,
     const int32_t errcode,
     const msg_base *msg_body,
@@ -525,8 +527,12 @@ int send_lite_packet(const char *node_type,
     const bool is_final_fragment = true,
     const int16_t packet_num = 1);
 
-int send_heartbeat_request(const int fd);
-int send_identity_report_request(const int fd);
+int send_heartbeat_request(struct calns::net_connection *conn);
+int send_identity_report_request(struct calns::net_connection *conn);
+
+// Sends an identity report request and a heart-beat request to an upstream server
+// as soon as connecting to it starts, so that they go ahead of anything queued to it later.
+void send_upstream_greetings(struct calns::net_connection *conn);
 
 const char *desc_of_end_flag(int src_value);
 
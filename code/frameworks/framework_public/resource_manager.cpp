@@ -28,7 +28,9 @@
 
 #include "resource_manager.h"
 
+#include <stdio.h>
 #include <string.h>
+#include <unistd.h>
 
 #include "connection_cache.h"
 #include "config_manager.h"
@@ -143,7 +145,18 @@ int resource_manager::__prepare_loggers(const void *condition)
 
     bool enables_file_logger = private_configs.file_log_enabled;
     const char *log_dir = private_configs.log_directory.c_str();
-    const char *log_name = private_configs.basic_log_name.c_str();
+    std::string log_name_str = private_configs.basic_log_name;
+#if defined(ACCEPTS_CLIENTS)
+    // Reactor workers must not share (and rotate) the same log file.
+    if (CFG_GET_COUNTER(XNODE_REACTOR_WORKER) > 1)
+    {
+        char pid_suffix[16] = {0};
+
+        snprintf(pid_suffix, sizeof(pid_suffix), ".%d", getpid());
+        log_name_str += pid_suffix;
+    }
+#endif
+    const char *log_name = log_name_str.c_str();
 
     if (calns::daemon::is_daemonized() || enables_file_logger)
     {
@@ -156,10 +169,16 @@ int resource_manager::__prepare_loggers(const void *condition)
         }
         file_level = level_definitions[file_level_str];
     }
-    LOGF_C(D, "enables_file_logger: %d, log_dir: %s, log_name: %s\n",
-        enables_file_logger, log_dir, log_name);
+    LOGF_C(D, "enables_file_logger: %d, log_dir: %s, log_name: %s, async: %d, mmap: %d\n",
+        enables_file_logger, log_dir, log_name, private_configs.file_log_async, private_configs.file_log_mmap);
+
+    int ret = init_logger(term_level, enables_file_logger, file_level, log_dir, log_name,
+        private_configs.file_log_async, private_configs.file_log_binary, private_configs.file_log_mmap);
 
-    return init_logger(term_level, enables_file_logger, file_level, log_dir, log_name);
+    if (RET_OK == ret && NULL != g_file_logger && private_configs.file_log_json)
+        g_file_logger->set_kv_format(calns::KV_FORMAT_JSON);
+
+    return ret;
 }
 
 int resource_manager::__prepare_network(const void *condition)
@@ -194,6 +213,10 @@ int resource_manager::__prepare_network(const void *condition)
     };
 
     size_t upstream_server_count;
+    const int kMaxConnCount = CFG_GET_COUNTER(XNODE_MAX_CONNECTION);
+    const int kPollEventBatch = CFG_GET_COUNTER(XNODE_POLL_EVENT_BATCH);
+    const int kPollTimeout = CFG_GET_TIMEOUT_USEC(XNODE_POLL_WAITING) / 1000;
+    const int kInitialBufSize = CFG_GET_BUF_SIZE(XNODE_TCP_INITIAL_BUF);
 
     for (size_t i = 0; i < sizeof(tcp_mgr_item) / sizeof(struct TcpManagerInfo); ++i)
     {
@@ -203,8 +226,8 @@ int resource_manager::__prepare_network(const void *condition)
             continue;
 
         calns::tcp_base *mgr = mgr_item.is_server
-            ? ((calns::tcp_base *)(new calns::tcp_server))
-            : ((calns::tcp_base *)(new calns::tcp_client));
+            ? ((calns::tcp_base *)(new calns::tcp_server(self_node_name, kMaxConnCount, kPollTimeout)))
+            : ((calns::tcp_base *)(new calns::tcp_client(self_node_name, kMaxConnCount, kPollTimeout)));
 
         if (NULL == (*(mgr_item.pptr) = mgr))
         {
@@ -212,6 +235,20 @@ int resource_manager::__prepare_network(const void *condition)
             goto PREPARATION_FAILED;
         }
 
+        // The batch grows by itself on busy rounds, so a moderate initial value is enough.
+        if (mgr->set_event_batch_size(kPollEventBatch) < 0)
+        {
+            LOGF_C(E, "failed to set poll event batch size of %s to %d\n", mgr_item.name, kPollEventBatch);
+            goto PREPARATION_FAILED;
+        }
+
+#if defined(USES_EDGE_TRIGGERED_POLL)
+        mgr->set_edge_triggered(true);
+#endif
+
+        // Buffers start from this size (nothing if it's 0) and grow on demand.
+        mgr->conn_pool()->set_initial_buffer_size(kInitialBufSize);
+
         QLOGF_C(I, "%s initialization successful\n", mgr_item.name);
     }
 
@@ -226,6 +263,10 @@ int resource_manager::__prepare_network(const void *condition)
     if (!is_quiet_mode())
         LOGF_C(I, "server listener name set as %s\n", server_listener->self_name());
 
+    if (CFG_GET_COUNTER(XNODE_REACTOR_WORKER) > 1)
+        server_listener->set_reuses_port(true);
+    server_listener->set_listen_backlog(CFG_GET_COUNTER(XNODE_LISTEN_BACKLOG));
+
     if ((ret = server_listener->start(self_info.node_ip.c_str(), self_info.node_port)) < 0)
     {
         LOGF_C(E, "failed to start server listener, ret = %d\n", ret);
@@ -248,7 +289,7 @@ int resource_manager::__prepare_network(const void *condition)
 
         QLOGF_C(I, "%s initialization successful\n", cache_item.name);
 
-        if ((*(cache_item.pptr))->create())
+        if ((*(cache_item.pptr))->create(CFG_GET_COUNTER(XNODE_CONNECTION_CACHE_SIZE)))
         {
             LOGF_C(E, "%s creation failed\n", cache_item.name);
             goto PREPARATION_FAILED;
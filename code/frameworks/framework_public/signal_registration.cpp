@@ -28,8 +28,6 @@
 
 #include "signal_registration.h"
 
-#include <sstream>
-
 #include "base/all.h"
 
 #include "config_manager.h"
@@ -88,9 +86,6 @@ DECLARE_DEFAULT_SIG_HANDLER(sigusr1)
      * info of tcp managers
      */
 
-    std::string conn_info;
-    std::istringstream info_stream;
-    std::string line;
     struct mgrinfo
     {
         calns::tcp_base *tcp_manager;
@@ -102,14 +97,11 @@ DECLARE_DEFAULT_SIG_HANDLER(sigusr1)
 
     for (size_t i = 0; i < sizeof(manager_info) / sizeof(struct mgrinfo); ++i)
     {
-        manager_info[i].tcp_manager->has_what(&conn_info);
-        info_stream.str(conn_info);
         RLOGF(I, "---- details of %s:\n", manager_info[i].manager_name);
-        while (std::getline(info_stream, line))
-        {
-            RLOGF(I, "%s\n", line.c_str());
-        }
-        info_stream.clear(); // TODO: clears and refreshes some inner flags relative to conn_info ??
+        // One key-value line for each connection, for log parsers.
+        manager_info[i].tcp_manager->log_connections(*g_screen_logger, calns::LOG_LEVEL_INFO);
+        if (NULL != g_file_logger)
+            manager_info[i].tcp_manager->log_connections(*g_file_logger, calns::LOG_LEVEL_INFO);
     }
 #endif
 
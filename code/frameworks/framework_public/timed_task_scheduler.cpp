@@ -33,6 +33,10 @@
 #include "resource_manager.h"
 #include "connection_cache.h"
 #include "protocol_common.h"
+#if defined(HAS_TCP)
+#include "message_cache.h"
+#include "packet_processor.h"
+#endif
 
 namespace cafw
 {
@@ -268,9 +272,11 @@ bool timed_task_scheduler::__task_info_is_ok(const timed_task_config &info)
 
 void default_message_clean_timed_task(void)
 {
-    /*message_cache *msg_cache = calns::singleton<packet_processor>::get_instance()->get_message_cache();
+#if defined(HAS_TCP)
+    message_cache *msg_cache = calns::singleton<packet_processor>::get_instance()->get_message_cache();
 
-    msg_cache->clean_expired_messages(calns::time_util::get_utc_microseconds());*/
+    msg_cache->clean_expired_messages(calns::time_util::get_utc_microseconds());
+#endif
 }
 
 void default_session_clean_timed_task(void)
@@ -279,12 +285,10 @@ void default_session_clean_timed_task(void)
 }
 
 #if defined(HAS_TCP)
-// this function may do a lot of searches, execute it when it has to.
+// Cached messages are not routed to upstream servers yet (see packet_processor::dispacher_general_flow()),
+// so none of them is outstanding on a connection, and nothing is worth waiting longer for.
 static bool has_time_consuming_messages(const char *conn_name)
 {
-    /*message_cache *msg_cache = calns::singleton<packet_processor>::get_instance()->get_message_cache();
-
-    return (msg_cache->time_consuming_message_count(conn_name) > 0);*/
     return false;
 }
 
@@ -310,7 +314,11 @@ static void update_connection_status(char *name, void *conn)
         return;
     }
 
-    calns::tcp_client *client = calns::singleton<resource_manager>::get_instance()->resource()->client_requester;
+    const resource_t *res = calns::singleton<resource_manager>::get_instance()->resource();
+    connection_cache *conn_cache = (peer_index->attribute.is_master)
+        ? res->master_connection_cache
+        : res->slave_connection_cache;
+    calns::tcp_client *client = res->client_requester;
     calns::net_connection *conn_found = client->find_peer(peer_index->fd);
     int64_t cur_time = calns::time_util::get_utc_microseconds();
 
@@ -328,6 +336,20 @@ static void update_connection_status(char *name, void *conn)
         || conn_not_in_client_requester
         || conn_info_inconsistent;
 
+    if (!server_not_connected && calns::CONN_STATUS_CONNECTING == conn_found->conn_status)
+    {
+        // still in progress, and completed in main_app::poll_and_process() if it succeeds
+        if (cur_time - conn_found->last_op_time <= CFG_GET_TIMEOUT_USEC(XNODE_CONNECT_TRYING))
+            return;
+
+        RLOGF(E, "! ! ! ! ! connection to [%s][%s:%u] timed out\n",
+            peer_index->conn_alias, peer_index->peer_ip, peer_index->peer_port);
+        client->disconnect_server(conn_found);
+        conn_cache->detach(peer_index);
+
+        return;
+    }
+
     if (!server_not_connected)
     {
         int64_t last_heartbeat_time = conn_found->last_op_time;
@@ -335,7 +357,7 @@ static void update_connection_status(char *name, void *conn)
         int64_t default_timeout = CFG_GET_TIMEOUT_USEC(XNODE_DEFAULT_WAITING_FOR_PEER_REPLY);
         int64_t longest_timeout = CFG_GET_TIMEOUT_USEC(XNODE_LONGEST_WAITING_FOR_PEER_REPLY);
 
-        RLOGF(D, "cur_time: %ld, last_heartbeat_time: %ld,"
+        RLOGF_RATE_LIMITED(D, 10, "cur_time: %ld, last_heartbeat_time: %ld,"
             " actual_timeout = cur_time - last_heartbeat_time = %ld, default_timeout = %ld,"
             " longest_timeout = %ld\n", cur_time, last_heartbeat_time, actual_timeout,
             default_timeout, longest_timeout);
@@ -351,17 +373,16 @@ static void update_connection_status(char *name, void *conn)
 
 SEND_HEARTBEAT:
 
-        RLOGF(D, "^~^~^~^~ request to: [%s][%s:%u]\n",
+        RLOGF_RATE_LIMITED(D, 10, "^~^~^~^~ request to: [%s][%s:%u]\n",
             peer_index->conn_alias, peer_index->peer_ip, peer_index->peer_port);
-        send_heartbeat_request(peer_index->fd);
+        send_heartbeat_request(conn_found);
 
         return;
 
 DISCONNECT:
 
         client->disconnect_server(conn_found);
-        peer_index->fd = calns::INVALID_SOCK_FD;
-        peer_index->conn_detail = NULL;
+        conn_cache->detach(peer_index);
         RLOGF(E, "no heart beat response for too long, detached from server %s\n",
             conn_found->peer_name);
 
@@ -370,14 +391,14 @@ DISCONNECT:
 
     const int kSendBufSize = CFG_GET_BUF_SIZE(XNODE_TCP_SEND_BUF);
     const int kRecvBufSize = CFG_GET_BUF_SIZE(XNODE_TCP_RECV_BUF);
-    int ret = client->connect_server(peer_index->peer_ip, peer_index->peer_port, kSendBufSize, kRecvBufSize, true);
+    // Does not wait here, or the whole event loop stalls while dead upstreams are reconnected one by one.
+    int ret = client->start_connecting(peer_index->peer_ip, peer_index->peer_port, kSendBufSize, kRecvBufSize);
 
     if (ret < 0)
     {
         RLOGF(E, "! ! ! ! ! connection to [%s][%s:%u] failed, ret = %d, msg = %s\n",
             peer_index->conn_alias, peer_index->peer_ip, peer_index->peer_port, ret, calns::what(ret).c_str());
-        peer_index->fd = calns::INVALID_SOCK_FD;
-        peer_index->conn_detail = NULL;
+        conn_cache->detach(peer_index);
         return;
     }
 
@@ -385,25 +406,21 @@ DISCONNECT:
 
     calns::net_connection *detail = (*(client->peers()))[fd];
 
-    RLOGF(I, "~ ~ ~ ~ ~ connection to [%s][%s:%u] successful, fd = %d, local address = [%s:%u]\n",
-        peer_index->conn_alias, peer_index->peer_ip, peer_index->peer_port, fd, detail->self_ip, detail->self_port);
-
-    RLOGF(I, "identity report request to: [%s][%s:%u]\n",
-        peer_index->conn_alias, peer_index->peer_ip, peer_index->peer_port);
-    send_identity_report_request(fd);
-
-    RLOGF(D, "^~^~^~^~ request to: [%s][%s:%u]\n",
-        peer_index->conn_alias, peer_index->peer_ip, peer_index->peer_port);
-    send_heartbeat_request(fd);
+    if (calns::CONN_STATUS_CONNECTING == detail->conn_status)
+    {
+        RLOGF(I, "~ ~ ~ ~ ~ connecting to [%s][%s:%u] in progress, fd = %d\n",
+            peer_index->conn_alias, peer_index->peer_ip, peer_index->peer_port, fd);
+    }
+    else
+    {
+        RLOGF(I, "~ ~ ~ ~ ~ connection to [%s][%s:%u] successful, fd = %d, local address = [%s:%u]\n",
+            peer_index->conn_alias, peer_index->peer_ip, peer_index->peer_port, fd, detail->self_ip, detail->self_port);
+    }
 
-    peer_index->fd = fd;
-    peer_index->conn_detail = detail;
+    conn_cache->attach(peer_index, detail);
     detail->last_op_time = cur_time;
     if (NULL != name)
     {
-        connection_cache *conn_cache = (peer_index->attribute.is_master)
-            ? calns::singleton<resource_manager>::get_instance()->resource()->master_connection_cache
-            : calns::singleton<resource_manager>::get_instance()->resource()->slave_connection_cache;
         dict_entry_ptr owner_ptr = conn_cache->return_as_entry(name, strlen(name));
 
         if (NULL != owner_ptr)
@@ -414,6 +431,9 @@ DISCONNECT:
 
         strncpy(detail->peer_name, name, calns::MAX_CONNECTION_NAME_LEN);
     }
+
+    // A connection still connecting is corked, and holds them until connected.
+    send_upstream_greetings(detail);
 }
 #endif
 
@@ -433,4 +453,29 @@ void default_log_flushing_timed_task(void)
     LOG_FLUSH();
 }
 
+void default_buffer_reclaim_timed_task(void)
+{
+#if defined(HAS_TCP)
+    const resource_t *resource = calns::singleton<resource_manager>::get_instance()->resource();
+#if defined(HAS_CONFIG_FILES)
+    // connections idle for a whole round give their buffer memory back
+    int64_t idle_usec = CFG_GET_TIME_INTERVAL_USEC(XNODE_BUF_RECLAIM);
+#else
+    int64_t idle_usec = 60 * 1000 * 1000;
+#endif
+    int released_size = 0;
+
+    if (idle_usec < 0)
+        return;
+
+#if defined(ACCEPTS_CLIENTS)
+    released_size += resource->server_listener->release_idle_buffers(idle_usec);
+#endif
+    released_size += resource->client_requester->release_idle_buffers(idle_usec);
+
+    if (released_size > 0)
+        RLOGF(D, "%d bytes of idle connection buffers released\n", released_size);
+#endif
+}
+
 } // namespace cafw
@@ -164,6 +164,7 @@ void default_message_clean_timed_task(void);
 void default_session_clean_timed_task(void);
 void default_heartbeat_timed_task(void);
 void default_log_flushing_timed_task(void);
+void default_buffer_reclaim_timed_task(void);
 
 }
 
@@ -37,12 +37,13 @@ namespace cafw
 message_cache::message_cache()
     : m_message_dictionary(NULL)
 {
-    ;
+    memset(m_expiry_lists, 0, sizeof(m_expiry_lists));
 }
 
 message_cache::message_cache(int dict_size)
     : m_message_dictionary(NULL)
 {
+    memset(m_expiry_lists, 0, sizeof(m_expiry_lists));
     create(dict_size);
 }
 
@@ -54,7 +55,7 @@ message_cache::~message_cache()
 int message_cache::create(int dict_size)
 {
     if ((NULL == m_message_dictionary) &&
-        (NULL == (m_message_dictionary = char_dict_create(DEFAULT_DICT_SIZE))))
+        (NULL == (m_message_dictionary = char_dict_create(dict_size))))
     {
         LOGF_C(E, "char_dict_create() failed\n");
         return RET_FAILED;
@@ -78,15 +79,33 @@ static void __free_message_value(uint32_t unused_hint, void **val)
 void message_cache::destroy(void)
 {
     char_dict_destroy(&m_message_dictionary, __free_message_value, NO_FREE_HINT);
+    memset(m_expiry_lists, 0, sizeof(m_expiry_lists));
 }
 
 int message_cache::add(const char *key, const int keylen, const void *val, const int vallen)
 {
-    return char_dict_add_element(key, keylen, val, vallen, m_message_dictionary);
+    if (RET_OK != char_dict_add_element(key, keylen, val, vallen, m_message_dictionary))
+        return RET_FAILED;
+
+    msg_cache_value *msg = (msg_cache_value *)val;
+    dict_entry_ptr entry = (dict_entry_ptr)char_dict_find_iterator(key, keylen, m_message_dictionary);
+
+    msg->key = GET_CHAR_DICT_KEY(entry);
+    msg->keylen = keylen;
+    msg->is_time_consuming = message_is_time_consuming(msg->cmd);
+    msg->last_op_time = calns::time_util::get_utc_microseconds();
+    __link(msg);
+
+    return RET_OK;
 }
 
 int message_cache::del(const char *key, const int keylen)
 {
+    msg_cache_value *msg = (msg_cache_value *)find(key, keylen);
+
+    if (NULL != msg)
+        __unlink(msg);
+
     return char_dict_delete_element(key, keylen, m_message_dictionary, __free_message_value, NO_FREE_HINT);
 }
 
@@ -95,129 +114,91 @@ void* message_cache::find(const char *key, const int keylen)
     return char_dict_find_value(key, keylen, m_message_dictionary);
 }
 
-#if HASH_OPTION == HASH_OPTION_3RD_PARTY_DICT
+int message_cache::reserve(int count)
+{
+    return char_dict_reserve(m_message_dictionary, count);
+}
+
+int message_cache::rehash(int budget_usec)
+{
+    return char_dict_rehash(m_message_dictionary, budget_usec);
+}
+
+void message_cache::touch(msg_cache_value *msg, int64_t cur_utc_usec)
+{
+    if (NULL == msg)
+        return;
+
+    __unlink(msg);
+    msg->last_op_time = cur_utc_usec;
+    __link(msg);
+}
 
 void message_cache::clean_expired_messages(int64_t cur_utc_usec)
 {
-    dict_iterator *it = dict_get_iterator(m_message_dictionary);
-    dict_entry *entry = NULL;
     int del_count = 0;
-    int64_t msg_time = 0;
-    msg_cache_value *msg_item = NULL;
     static const int64_t kDefaultTimeout = CFG_GET_TIMEOUT_USEC(XNODE_DEFAULT_MSG_PROCESS);
     static const int64_t kMaxTimeout = CFG_GET_TIMEOUT_USEC(XNODE_MAX_MSG_PROCESS);
+    const int64_t kTimeouts[] = { kDefaultTimeout, kMaxTimeout };
 
-    while (NULL != (entry = dict_next(it)))
+    for (size_t i = 0; i < sizeof(m_expiry_lists) / sizeof(expiry_list); ++i)
     {
-        if (NULL == (msg_item = (msg_cache_value *)(entry->val)))
-            continue;
-
-        msg_time = msg_item->last_op_time;
+        msg_cache_value *msg_item = NULL;
 
-        bool msg_is_time_consuming = message_is_time_consuming(msg_item->cmd);
-        bool msg_expired = msg_is_time_consuming
-            ? (cur_utc_usec - msg_time >= kMaxTimeout)
-            : (cur_utc_usec - msg_time >= kDefaultTimeout);
-
-        if (msg_expired)
+        // Stops at the first message not expired, as all after it are newer.
+        while (NULL != (msg_item = m_expiry_lists[i].head) &&
+            cur_utc_usec - msg_item->last_op_time >= kTimeouts[i])
         {
             LOGF_C(I, "message[%s | 0x%08X] last operated on time[%ld] expired, cleaned up now\n",
-                (char*)(entry->key), msg_item->reqcmd, msg_time);
-            dict_delete_no_free(m_message_dictionary, entry->key, entry->keylen);
-            char_dict_release_key((void **)&(entry->key));
-            __free_message_value(NO_FREE_HINT, &(entry->val));
+                msg_item->key, msg_item->reqcmd, msg_item->last_op_time);
+            del(msg_item->key, msg_item->keylen);
             ++del_count;
         }
     }
 
-    dict_release_iterator(it);
-
     if (del_count > 0)
         RLOGF(I, "%d expired messages cleaned up\n", del_count);
 }
 
-size_t message_cache::time_consuming_message_count(const char *connection_name) const
+void message_cache::print(void)
 {
-    if (NULL == connection_name)
-        return 0;
-
-    dict_iterator *it = dict_get_iterator(m_message_dictionary);
-    dict_entry *entry = NULL;
-    int target_count = 0;
-    msg_cache_value *msg_item = NULL;
-
-    while (NULL != (entry = dict_next(it)))
-    {
-        if (NULL == (msg_item = (msg_cache_value *)(entry->val)) || NULL == msg_item->to_name)
-            continue;
-
-        bool msg_is_time_consuming = message_is_time_consuming(msg_item->cmd);
-
-        if (!msg_is_time_consuming)
-            continue;
-
-        if (0 == strcmp(connection_name, msg_item->to_name))
-            ++target_count;
-    }
-
-    dict_release_iterator(it);
-
-    return target_count;
+    char_dict_print(m_message_dictionary);
 }
 
-#else
-
-void message_cache::clean_expired_messages(int64_t cur_utc_usec)  // TODO: to be improved ...
+message_cache::expiry_list& message_cache::__expiry_list_of(const msg_cache_value *msg)
 {
-    Dictionary::iterator begin = m_message_dictionary->begin();
-    Dictionary::iterator end = m_message_dictionary->end();
-    Dictionary::iterator tmp_it = m_message_dictionary->end();
-    int del_count = 0;
-    int64_t msg_time = 0;
-    static const int64_t kDefaultTimeout = CFG_GET_TIMEOUT_USEC(XNODE_DEFAULT_MSG_PROCESS);
-    static const int64_t kMaxTimeout = CFG_GET_TIMEOUT_USEC(XNODE_MAX_MSG_PROCESS);
-
-    for (Dictionary::iterator it = begin; it != end;)
-    {
-        tmp_it = it++;
-
-        if (NULL == tmp_it->second)
-            continue;
-
-        msg_time = ((msg_cache_value *)(tmp_it->second))->last_op_time;
-
-        bool msg_is_time_consuming = message_is_time_consuming(msg_item->cmd);
-        bool msg_expired = msg_is_time_consuming
-            ? (cur_utc_usec - msg_time >= kMaxTimeout)
-            : (cur_utc_usec - msg_time >= kDefaultTimeout);
-
-        if (msg_expired)
-        {
-            LOG_INFO_CV("message[%s] last operated on time[%lld] expired, cleaned up now\n", tmp_it->first, msg_time);
-//#if HASH_OPTION == HASH_OPTION_STL_MAP
-#if 1
-            char_dict_release_key((void **)&(tmp_it->first));
-#endif
-            __free_message_value(NO_FREE_HINT, &(tmp_it->second));
-            m_message_dictionary->erase(tmp_it);
-            ++del_count;
-        }
-    }
-
-    if (del_count > 0)
-        LOG_INFO("%d expired messages cleaned up\n", del_count);
+    return m_expiry_lists[msg->is_time_consuming ? 1 : 0];
 }
 
-size_t message_cache::time_consuming_message_count(const char *connection_name) const
+void message_cache::__link(msg_cache_value *msg)
 {
-    // TODO: implement it when it is needed
+    expiry_list &list = __expiry_list_of(msg);
+
+    msg->prev = list.tail;
+    msg->next = NULL;
+    if (NULL != list.tail)
+        list.tail->next = msg;
+    else
+        list.head = msg;
+    list.tail = msg;
 }
 
-#endif
-
-void message_cache::print(void)
+void message_cache::__unlink(msg_cache_value *msg)
 {
-    char_dict_print(m_message_dictionary);
+    expiry_list &list = __expiry_list_of(msg);
+
+    if (NULL != msg->prev)
+        msg->prev->next = msg->next;
+    else
+        list.head = msg->next;
+
+    if (NULL != msg->next)
+        msg->next->prev = msg->prev;
+    else
+        list.tail = msg->prev;
+
+    msg->prev = NULL;
+    msg->next = NULL;
 }
 
 }
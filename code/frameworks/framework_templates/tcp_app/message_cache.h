@@ -63,8 +63,14 @@ typedef struct msg_cache_value
         int to_fd;
         char *to_name;
     //};
-    int64_t last_op_time;
+    int64_t last_op_time; // updated by message_cache::touch()
     void *contents;
+    // Fields below are maintained by message_cache.
+    char *key; // the copy held by the dictionary
+    int keylen;
+    bool is_time_consuming;
+    struct msg_cache_value *prev; // in the expiry list
+    struct msg_cache_value *next;
 }msg_cache_value;
 
 class message_cache
@@ -101,6 +107,12 @@ public:
     {
         MAX_MSG_EXPIRED_USECS = 5 * 60 * 1000000
     };
+    // Messages in the order of last_op_time, the oldest first.
+    typedef struct expiry_list
+    {
+        msg_cache_value *head;
+        msg_cache_value *tail;
+    }expiry_list;
 
 /* ===================================
  * abilities:
@@ -108,11 +120,17 @@ public:
 public:
     int create(int dict_size = DEFAULT_DICT_SIZE);
     void destroy(void);
+    // @val must point to a msg_cache_value.
     int add(const char *key, const int keylen, const void *val, const int vallen);
     int del(const char *key, const int keylen);
     void *find(const char *key, const int keylen);
+    // Updates last_op_time of a cached message, use it instead of assigning last_op_time.
+    void touch(msg_cache_value *msg, int64_t cur_utc_usec);
+    // See char_dict_reserve() and char_dict_rehash().
+    int reserve(int count);
+    int rehash(int budget_usec);
+    // Takes time in proportion to the number of expired messages.
     void clean_expired_messages(int64_t cur_utc_usec);
-    size_t time_consuming_message_count(const char *connection_name) const;
     void print(void);
 
 /* ===================================
@@ -135,12 +153,18 @@ public:
  * private methods:
  * =================================== */
 protected:
+    expiry_list& __expiry_list_of(const msg_cache_value *msg);
+    void __link(msg_cache_value *msg);
+    void __unlink(msg_cache_value *msg);
 
 /* ===================================
  * data:
  * =================================== */
 protected:
-    dict *m_message_dictionary;
+    char_dict *m_message_dictionary;
+    // [0] for ordinary messages, [1] for time-consuming ones, which have a different timeout,
+    // so that each list stays ordered when a touched message moves to its tail.
+    expiry_list m_expiry_lists[2];
 };
 
 }
@@ -142,8 +142,8 @@ int packet_processor::build_component_map(void)
     }\
     else \
     {\
-        RLOGF(I, "----\n"); \
-        RLOGF(I, "--------\n"); \
+        BLOGF(I, "----\n"); \
+        BLOGF(I, "--------\n"); \
     }
 
 #define PACKET_END_FORMAT_LINES(for_heartbeat) if (for_heartbeat) \
@@ -153,8 +153,8 @@ int packet_processor::build_component_map(void)
     }\
     else \
     {\
-        RLOGF(I, "--------\n"); \
-        RLOGF(I, "----\n"); \
+        BLOGF(I, "--------\n"); \
+        BLOGF(I, "----\n"); \
     }
 
 int packet_processor::process(const struct calns::net_connection *input_conn,
@@ -191,7 +191,7 @@ int packet_processor::process(const struct calns::net_connection *input_conn,
 
     if (in_len < length || in_len < (int)PROTO_HEADER_SIZE)
     {
-        LOGF_C(W, "incomplete packet in recv_buf of connection[fd:%d, name:%s]: expected length = %d, actual length = %d,"
+        LOGF_C_RATE_LIMITED(W, 10, "incomplete packet in recv_buf of connection[fd:%d, name:%s]: expected length = %d, actual length = %d,"
             " minimum length = %d, command code = 0x%08X, fd = %d, may need more bytes and handle them later\n",
             in_fd, kConnName, length, in_len,
             (int)PROTO_HEADER_SIZE, command, in_fd);
@@ -247,7 +247,7 @@ int packet_processor::process(const struct calns::net_connection *input_conn,
 
     if (!is_heartbeat)
     {
-        RLOGF(I, "%d bytes new packet from connection{ fd[%d] | name[%s] | address[%s:%hu] }:"
+        BLOGF(I, "%d bytes new packet from connection{ fd[%d] | name[%s] | address[%s:%hu] }:"
             " header{ length[%d] | route_id[%ld] | command[0x%08X] | flag_bits[0x%04X]"
             " | packet_number[%hd] | error_code[%d] }\n",
             in_len, in_fd, input_conn->peer_name, input_conn->peer_ip, input_conn->peer_port,
@@ -284,7 +284,7 @@ int packet_processor::process(const struct calns::net_connection *input_conn,
 #else
     bool is_req = proto_is_request(command);
     char sid[SID_LEN + 1] = {0};
-    void* out_data_ptr = (*mutable_output_conn)->send_buf->get_write_pointer();
+    void* out_data_ptr = __output_pointer(*mutable_output_conn);
 
     component_map::iterator it = m_component_map->find(command);
     if (m_component_map->end() == it)
@@ -321,7 +321,7 @@ int packet_processor::process(const struct calns::net_connection *input_conn,
     {
         // Has to fetch the pointer again, in case that the output connection changes
         // within SingleOperatorGeneralFlow().
-        out_data_ptr = (*mutable_output_conn)->send_buf->get_write_pointer();
+        out_data_ptr = __output_pointer(*mutable_output_conn);
 
         save_session_info(input_conn, out_data_ptr, output_len, true);
     }
@@ -371,7 +371,7 @@ int packet_processor::single_operator_general_flow(const struct calns::net_conne
     bool has_done_business = false;
 
 #define STAT_TIME_CONSUMPTION(op_literal) cur_step_time = calns::time_util::get_utc_microseconds(); \
-    RLOGF(I, "[cmd:0x%08X] [" op_literal "] done, time spent: %ld us\n", command, cur_step_time - last_step_time); \
+    BLOGF(I, "[cmd:0x%08X] [" op_literal "] done, time spent: %ld us\n", command, cur_step_time - last_step_time); \
     last_step_time = cur_step_time
 
     if (NULL != out_body)
@@ -447,7 +447,10 @@ int packet_processor::single_operator_general_flow(const struct calns::net_conne
             whole_in_body = component.alloc_body_container();
             msg_cache_item = char_dict_alloc_val< msg_cache_value >();
             msg_cache_item->from_fd = input_conn->fd;
+            msg_cache_item->from_name = NULL;
             //msg_cache_item->from_name = in.connection->peer_name;
+            msg_cache_item->to_fd = calns::INVALID_SOCK_FD;
+            msg_cache_item->to_name = NULL;
             msg_cache_item->cmd = command;
             msg_cache_item->contents = whole_in_body;
             if (RET_FAILED == m_message_cache->add(sid, sid_len, msg_cache_item, sizeof(msg_cache_item)))
@@ -475,7 +478,7 @@ int packet_processor::single_operator_general_flow(const struct calns::net_conne
         }
         RLOGF(I, "fragment[%d] grouped into cached packet\n", packet_num);
 
-        msg_cache_item->last_op_time = calns::time_util::get_utc_microseconds();
+        m_message_cache->touch(msg_cache_item, calns::time_util::get_utc_microseconds());
         STAT_TIME_CONSUMPTION("fragment grouping");
 
         bool is_end = is_final_packet(in_data_ptr);
@@ -496,7 +499,7 @@ int packet_processor::single_operator_general_flow(const struct calns::net_conne
     } // end if (component.has_multi_fragments)
 
     strncpy(body_container_type, typeid(*whole_in_body).name(), sizeof(body_container_type));
-    RLOGF(I, "%s was parsed successfully, cmd = 0x%08X, desc = %s,"
+    BLOGF(I, "%s was parsed successfully, cmd = 0x%08X, desc = %s,"
         " sid = %s, total bodylen = %d, in_fd = %d\n",
         body_container_type, command, component.description,
         sid, get_message_length(*whole_in_body), input_conn->fd);
@@ -542,7 +545,7 @@ OUTPUT:
     {
         calns::net_connection *output_conn = *(mutable_output_conn);
         calns::buffer *out_buf = output_conn->send_buf;
-        void* out_data_ptr = out_buf->get_write_pointer();
+        void* out_data_ptr = __output_pointer(output_conn);
         int available_buf_len = out_buf->total_size() - out_buf->write_position();
         bool no_enough_space = ( available_buf_len < 2 * get_current_max_packet_length()
             || available_buf_len > out_buf->total_size() );
@@ -554,8 +557,8 @@ OUTPUT:
             calns::tcp_base::send_from_connection(output_conn);
         }
 
+        out_data_ptr = __output_pointer(output_conn);
         available_buf_len = out_buf->total_size() - out_buf->write_position(); // refresh again, so does statements below
-        out_data_ptr = out_buf->get_write_pointer();
 
         no_enough_space = ( available_buf_len < 2 * get_current_max_packet_length()
             || available_buf_len > out_buf->total_size() );
@@ -573,7 +576,7 @@ OUTPUT:
         STAT_TIME_CONSUMPTION("output data serialization");
         update_max_packet_length(output_len);
 
-        RLOGF(I, "%d bytes output packet generated and loaded into send buffer"
+        BLOGF(I, "%d bytes output packet generated and loaded into send buffer"
             " of connection{ fd[%d] | name[%s] | address[%s:%u] }\n",
             output_len, output_conn->fd, output_conn->peer_name, output_conn->peer_ip, output_conn->peer_port);
     }
@@ -584,7 +587,7 @@ OUTPUT:
         m_message_cache->del(sid, sid_len);
 #endif
     if (PROTO_RET_SUCCESS == retcode)
-        RLOGF(I, "~ ~ ~ ~ ~ ~ ~ ~ ~ ~ %s::%s() for [ 0x%08X | %s | %s ] successful, total time spent: %ld us\n",
+        BLOGF(I, "~ ~ ~ ~ ~ ~ ~ ~ ~ ~ %s::%s() for [ 0x%08X | %s | %s ] successful, total time spent: %ld us\n",
             typeid(*this).name(), __FUNC__, command, component.description, sid, calns::time_util::get_utc_microseconds() - start_time);
     else
         RLOGF(E, "! ! ! ! ! ! ! ! ! ! %s::%s() for [ 0x%08X | %s | %s ] failed,"
@@ -842,7 +845,7 @@ static int general_heartbeat_handling(
         peer_name = connection->peer_name;
     }
 
-    RLOGF(D, "^~^~^~^~ heart beat %s: fd[%d], name[%s]\n",
+    RLOGF_RATE_LIMITED(D, 10, "^~^~^~^~ heart beat %s: fd[%d], name[%s]\n",
         heartbeat_type, fd, peer_name);
 
     return RET_OK;
@@ -963,8 +966,7 @@ DECLARE_BUSINESS_FUNC(identity_report_request_handling)
         memset(conn_index->peer_ip, 0, sizeof(conn_index->peer_ip));
         strncpy(conn_index->peer_ip, connection->peer_ip, calns::IPV4_LEN);
         conn_index->peer_port = connection->peer_port;
-        conn_index->fd = fd;
-        conn_index->conn_detail = connection;
+        conn_cache->attach(conn_index, connection);
 
         RLOGF(I, "connection cache info of client[%s] partially updated: fd[%d],"
             " address[%s:%u], conn_detail[%p]\n", client_name, conn_index->fd,
@@ -1026,7 +1028,7 @@ int packet_processor::diagnose_connection(const struct calns::net_connection *in
     int body_len = CALC_BODY_LEN(in_len);
     int32_t command = get_proto_command(in_data_ptr);
     int32_t out_cmd = 0;
-    void *out_data_ptr = (*mutable_output_conn)->send_buf->get_write_pointer();
+    void *out_data_ptr = __output_pointer(*mutable_output_conn);
 #ifndef USE_JSON_MSG
     static IdentityReportReq s_id_report_req;
     static IdentityReportResp s_id_report_resp;
@@ -1186,6 +1188,17 @@ void packet_processor::__clear(void)
     }
 }
 
+void *packet_processor::__output_pointer(struct calns::net_connection *output_conn)
+{
+    calns::buffer *out_buf = output_conn->send_buf;
+
+    // A growable buffer allocates memory only when needed, and has none at all with tcp-initial 0.
+    if (out_buf->is_growable() && out_buf->reserve(2 * get_current_max_packet_length()) < 0)
+        LOGF_C(E, "failed to reserve space in send_buf of connection[%d|%s]\n", output_conn->fd, output_conn->peer_name);
+
+    return out_buf->get_write_pointer();
+}
+
 } // namespace cafw
 
 DECLARE_BUSINESS_FUNC(unused_command)
@@ -115,6 +115,9 @@ public:
 protected:
     int __inner_init(void);
     void __clear(void);
+    // Returns the write pointer of the send buffer of @output_conn, reserving space
+    // for output packets first if the buffer is growable, see tcp-initial in common.xml.
+    void *__output_pointer(struct calns::net_connection *output_conn);
 
     int single_operator_general_flow(const struct calns::net_connection *input_conn,
         const int input_len,
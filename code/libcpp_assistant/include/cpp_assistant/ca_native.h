@@ -43,13 +43,20 @@
 #include "native/floating_point.h"
 #include "native/time_util.h"
 #include "native/singleton.h"
+#include "native/kv_line.h"
 #include "native/screen_logger.h"
 #include "native/file_logger.h"
+#include "native/async_file_logger.h"
+#include "native/mmap_file_logger.h"
+#include "native/binary_logger.h"
 #include "native/signal_capturer.h"
 #include "native/daemon.h"
 #include "native/sequential_buffer.h"
+#include "native/ring_buffer.h"
 #include "native/net_common.h"
 #include "native/net_poller.h"
+#include "native/connection_table.h"
+#include "native/connection_pool.h"
 #include "native/tcp_client.h"
 #include "native/tcp_server.h"
 #include "native/xml_helper.h"
@@ -0,0 +1,202 @@
+/*
+ * Copyright (c) 2026, Wen Xiongchang <udc577 at 126 dot com>
+ * All rights reserved.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any
+ * damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any
+ * purpose, including commercial applications, and to alter it and
+ * redistribute it freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must
+ * not claim that you wrote the original software. If you use this
+ * software in a product, an acknowledgment in the product documentation
+ * would be appreciated but is not required.
+ *
+ * 2. Altered source versions must be plainly marked as such, and
+ * must not be misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source
+ * distribution.
+ */
+
+// NOTE: The original author also uses (short/code) names listed below,
+//       for convenience or for a certain purpose, at different places:
+//       wenxiongchang, wxc, Damon Wen, udc577
+
+/*
+ * async_file_logger.h
+ *
+ *  Created on: 2026-10-17
+ *      Author: wenxiongchang
+ * Description: File logger whose file I/O is done by a background thread.
+ */
+
+#ifndef __CPP_ASSISTANT_ASYNC_FILE_LOGGER_H__
+#define __CPP_ASSISTANT_ASYNC_FILE_LOGGER_H__
+
+#include <stdint.h>
+#include <pthread.h>
+
+#include "file_logger.h"
+
+CA_LIB_NAMESPACE_BEGIN
+
+/*
+ * A file logger which formats log lines into a lock-free single-producer/single-consumer queue,
+ * and leaves writing, flushing and file switching to a dedicated flusher thread,
+ * so that the logging thread never waits for disk I/O (unless the overflow policy says so).
+ * NOTE: Like other loggers, it is supposed to be called by one thread only unless it is in thread-safe mode,
+ *     and only formatted logging goes through the queue: do not use stream-style logging on it.
+ */
+class async_file_logger : public file_logger
+{
+/* ===================================
+ * constructors:
+ * =================================== */
+public:
+    async_file_logger();
+
+/* ===================================
+ * copy control:
+ * =================================== */
+private:
+    async_file_logger(const async_file_logger& src);
+    async_file_logger& operator=(const async_file_logger& src);
+
+/* ===================================
+ * destructor:
+ * =================================== */
+public:
+    ~async_file_logger();
+
+/* ===================================
+ * types:
+ * =================================== */
+public:
+    // What to do with a log line when the queue is full.
+    enum enum_overflow_policy
+    {
+        OVERFLOW_BLOCKS = 0,            // waits for the flusher thread
+        OVERFLOW_DROPS_LOW_LEVELS,      // drops lines below LOG_LEVEL_WARNING, and waits for others
+        OVERFLOW_DROPS                  // drops any line
+    };
+
+    enum enum_queue_size
+    {
+        MIN_QUEUE_SIZE = 64 * 1024,
+        DEFAULT_QUEUE_SIZE = 4 * 1024 * 1024,
+        MAX_QUEUE_SIZE = 256 * 1024 * 1024
+    };
+
+    enum
+    {
+        MAX_LINE_LEN = 8 * 1024 // longer lines are truncated
+    };
+
+/* ===================================
+ * abilities:
+ * =================================== */
+public:
+    // Opens the log file and starts the flusher thread.
+    virtual int open(int cache_buf_size = DEFAULT_LOG_CACHE_SIZE);
+
+    // Writes everything queued, stops the flusher thread and closes the log file.
+    virtual int close(bool release_buffer = true);
+
+    // Asks the flusher thread to write everything queued and flush the file, without waiting for it.
+    virtual void flush(void);
+
+    using file_logger::output; // the variadic one, which would be hidden otherwise
+
+    virtual int output(bool has_prefix,
+        enum_log_level log_level,
+        const char *fmt,
+        va_list args) CA_NOTNULL(4);
+
+    virtual int output_formatted(bool has_prefix,
+        enum_log_level log_level,
+        const char *line,
+        int len) CA_NOTNULL(4);
+
+/* ===================================
+ * attributes:
+ * =================================== */
+public:
+    inline enum_overflow_policy overflow_policy(void) const
+    {
+        return m_overflow_policy;
+    }
+
+    inline void set_overflow_policy(enum_overflow_policy policy)
+    {
+        m_overflow_policy = policy;
+    }
+
+    inline int queue_size(void) const
+    {
+        return m_queue_size;
+    }
+
+    // Sets the size of the queue, which is rounded into [MIN_QUEUE_SIZE, MAX_QUEUE_SIZE].
+    // NOTE: It can not be called when the logger is open.
+    int set_queue_size(int size);
+
+/* ===================================
+ * status:
+ * =================================== */
+public:
+    // How many lines have been dropped because of a full queue.
+    inline int64_t dropped_count(void) const
+    {
+        return __atomic_load_n(&m_dropped_count, __ATOMIC_RELAXED);
+    }
+
+/* ===================================
+ * private methods:
+ * =================================== */
+protected:
+    // Formats a log line into the queue.
+    int __queue_line(bool has_prefix,
+        enum_log_level log_level,
+        const char *fmt,
+        va_list args);
+
+    static void *flusher_routine(void *arg);
+
+    // Writes queued records to the file, returns how many bytes of the queue are consumed.
+    int64_t write_queued_records(void);
+
+    inline int64_t queued_size(void) const
+    {
+        return __atomic_load_n(&m_write_pos, __ATOMIC_ACQUIRE) - __atomic_load_n(&m_read_pos, __ATOMIC_ACQUIRE);
+    }
+
+    void wake_flusher(void);
+
+/* ===================================
+ * data:
+ * =================================== */
+protected:
+    enum_overflow_policy m_overflow_policy;
+    int m_queue_size;
+    char *m_queue;
+    int64_t m_write_pos; // owned by the logging thread
+    int64_t m_read_pos; // owned by the flusher thread
+    int64_t m_dropped_count;
+    int m_queued_lines; // lines queued into the current file, for switching it
+    int64_t m_queued_bytes;
+    int m_queued_mday;
+    bool m_flush_requested;
+    bool m_stop_requested;
+    bool m_flusher_running;
+    pthread_t m_flusher;
+    pthread_mutex_t m_wakeup_mutex;
+    pthread_cond_t m_wakeup_cond;
+};
+
+CA_LIB_NAMESPACE_END
+
+#endif // __CPP_ASSISTANT_ASYNC_FILE_LOGGER_H__
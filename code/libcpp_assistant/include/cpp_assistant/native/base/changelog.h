@@ -51,6 +51,50 @@
  *
  * !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
  *
+ * wxc, 2026/10/17, 0.05.01:
+ *      1. Added edge-triggered monitoring mode into tcp_base, with drain_to_connection()
+ *          receiving data until EAGAIN and net_connection::is_still_readable marking pending data.
+ *      2. Removed the connection count cap of net_poller, and made the event batch size of poll()
+ *          configurable and growable, independent of the count of monitored connections.
+ *      3. Added connection_table, an fd-indexed table replacing std::map for tcp_base::m_peers.
+ *      4. Added SO_REUSEPORT option and adopt_connection() into tcp_server,
+ *          for multiple reactors sharing the same listening port.
+ *      5. Made the listen backlog of tcp_server configurable, and added tcp_server::accept_new_connections()
+ *          accepting all pending connections by accept4() in one call.
+ *      6. Added tcp_base::send_fragments() sending scattered segments by sendmsg(),
+ *          send_to_connection() sending pending data and new data in one call,
+ *          and cork_connection()/uncork_connection() for batching small packets.
+ *      7. Added ring_buffer, which never moves data and exposes its regions as iovec structures,
+ *          with an optional mirrored(double-mapped) mode, and tcp_base::send_from/recv_to_ring_buffer().
+ *      8. Added connection_pool recycling connection nodes and buffers for tcp_base and its subclasses,
+ *          and fixed leaks of connection nodes when accepting or connecting fails.
+ *      9. Added growable mode into sequential_buffer, which allocates memory lazily and grows on demand,
+ *          connection_pool::set_initial_buffer_size() enabling it, and tcp_base::release_idle_buffers().
+ *      10. Added tcp_client::start_connecting() and finish_connecting() for connecting without blocking,
+ *          and made send_to_connection() hold data of connections which are still connecting.
+ *      11. Reimplemented tcp_base::is_readable()/is_writable() with poll() instead of select(),
+ *          which fails on fds not less than FD_SETSIZE, and added the batch forms are_readable()/are_writable().
+ *      12. Added async_file_logger, which formats log lines into a lock-free queue and writes them
+ *          in a flusher thread, with a configurable overflow policy, and made logger::output()/flush() virtual.
+ *      13. Cached the date and time part of log line prefixes per second in logger, patching only microseconds
+ *          into it, and added logger::set_uses_coarse_clock() for reading time from CLOCK_REALTIME_COARSE.
+ *      14. Added binary_logger and BLOG(), writing only site IDs, timestamps and raw arguments of log lines,
+ *          and the tool decode_binary_log(src/tools/) turning binary log files into text.
+ *      15. Added thread-safe mode into logger and its subclasses, in which lines are formatted in buffers
+ *          of each thread and written and switched in a lock.
+ *      16. Added size limit of log fragments, and background rotation into file_logger, in which the next fragment
+ *          is pre-opened, and finished fragments are closed, renamed, compressed and removed by a housekeeping thread.
+ *      17. Added mmap_file_logger, writing log lines into a shared memory mapping of the log file,
+ *          so that they survive crashes of the process without being flushed.
+ *      18. Added structured logging: logger::kv() renders typed key-value pairs by kv_line as text or JSON lines,
+ *          without printf-like formatting, and tcp_base::log_connections() logs connections that way.
+ *      19. Added logger::set_muted() to drop lines before formatting, and screen_logger turns off colors
+ *          if stdout/stderr are not terminals and mutes itself if they're discarded.
+ *      20. Added reference-counted shared_packet and a per-connection send queue, so one packet can be
+ *          queued to many connections without copying it; see tcp_base::enqueue_to_connection().
+ *      21. Added a list of peers with data left to send to tcp_base, see tcp_base::send_pending_head(),
+ *          so that flushing them no longer walks all peers.
+ *
  * wxc, 2019/06/01, 0.05.00:
  *      1. Changed the logging style of logger classes to be the same as Google logging library.
  *
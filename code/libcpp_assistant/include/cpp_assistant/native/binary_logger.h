@@ -0,0 +1,239 @@
+/*
+ * Copyright (c) 2026, Wen Xiongchang <udc577 at 126 dot com>
+ * All rights reserved.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any
+ * damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any
+ * purpose, including commercial applications, and to alter it and
+ * redistribute it freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must
+ * not claim that you wrote the original software. If you use this
+ * software in a product, an acknowledgment in the product documentation
+ * would be appreciated but is not required.
+ *
+ * 2. Altered source versions must be plainly marked as such, and
+ * must not be misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source
+ * distribution.
+ */
+
+// NOTE: The original author also uses (short/code) names listed below,
+//       for convenience or for a certain purpose, at different places:
+//       wenxiongchang, wxc, Damon Wen, udc577
+
+/*
+ * binary_logger.h
+ *
+ *  Created on: 2026-10-17
+ *      Author: wenxiongchang
+ * Description: File logger which writes log lines without formatting them,
+ *              and can decode the log files into text afterwards.
+ */
+
+#ifndef __CPP_ASSISTANT_BINARY_LOGGER_H__
+#define __CPP_ASSISTANT_BINARY_LOGGER_H__
+
+#include <stdint.h>
+#include <string.h>
+
+#include <string>
+
+#include "file_logger.h"
+
+CA_LIB_NAMESPACE_BEGIN
+
+/*
+ * A file logger which defers formatting: each logging call site registers its format string once,
+ * and then only the site ID, a timestamp and the raw bytes of the arguments are written,
+ * decode() turns a log file into text lines in the same format as the other loggers.
+ * Integers, enums, floating points, pointers and C strings are supported as arguments,
+ * use BLOG() to define a call site, for example: BLOG(logger, LOG_LEVEL_INFO, "%s: %d\n", name, value);
+ * NOTE: Like other loggers, it is supposed to be called by one thread only unless it is in thread-safe mode.
+ */
+class binary_logger : public file_logger
+{
+/* ===================================
+ * constructors:
+ * =================================== */
+public:
+    binary_logger();
+
+/* ===================================
+ * copy control:
+ * =================================== */
+private:
+    binary_logger(const binary_logger& src);
+    binary_logger& operator=(const binary_logger& src);
+
+/* ===================================
+ * destructor:
+ * =================================== */
+public:
+    ~binary_logger();
+
+/* ===================================
+ * types:
+ * =================================== */
+public:
+    // A logging call site, which is a static variable of the site, see BLOG().
+    typedef struct site_t
+    {
+        int32_t id; // assigned on the first logging
+        int32_t file_serial; // the file where the site was defined the latest time
+        enum_log_level level;
+        const char *fmt;
+    }site_t;
+
+    enum enum_record_type
+    {
+        RECORD_SITE_DEFINITION = 1, // followed by the format string
+        RECORD_LOG_ENTRY // followed by the arguments
+    };
+
+    typedef struct record_header_t
+    {
+        uint16_t type;
+        uint16_t level;
+        uint32_t site_id;
+        uint32_t len; // the whole record, including the header
+        uint32_t reserved;
+        int64_t time_usec; // UTC time in microseconds, of log entries only
+    }record_header_t;
+
+    enum
+    {
+        MAX_RECORD_LEN = 4096 // longer string arguments are truncated
+    };
+
+/* ===================================
+ * abilities:
+ * =================================== */
+public:
+    template<typename... Args>
+    int log(site_t &site, const Args&... args)
+    {
+        if (!m_is_thread_safe && !is_open()) // checked in the lock otherwise
+            return CA_RET(FILE_OR_STREAM_NOT_OPEN);
+
+        if (site.level < m_log_level)
+            return 0;
+
+        char record[MAX_RECORD_LEN];
+        char *pos = record + sizeof(record_header_t);
+
+        encode_args(pos, record + sizeof(record), args...);
+
+        return __write_entry(site, record, pos - record);
+    }
+
+    using file_logger::output; // the variadic one, which would be hidden otherwise
+
+    // Formatted text does not fit in binary log files, use log() instead.
+    virtual int output(bool has_prefix,
+        enum_log_level log_level,
+        const char *fmt,
+        va_list args) CA_NOTNULL(4);
+
+    // Neither do key-value lines.
+    virtual int output_formatted(bool has_prefix,
+        enum_log_level log_level,
+        const char *line,
+        int len) CA_NOTNULL(4);
+
+    // Decodes a binary log file into text lines, returns the count of lines or an error code.
+    static int decode(FILE *input, FILE *output);
+
+    // Formats the encoded arguments with the format string, used by decode().
+    static int format_args(const char *fmt, const char *args, int args_len, std::string &text);
+
+/* ===================================
+ * private methods:
+ * =================================== */
+protected:
+    // Writes the file header into each new fragment.
+    virtual int __start_fragment(void);
+
+    int __write_entry(site_t &site, char *record, int record_len);
+
+    int __write_entry_unlocked(site_t &site, char *record, int record_len);
+
+    int __write_site_definition(const site_t &site);
+
+    static inline void encode_args(char *&pos, const char *end)
+    {
+        ;
+    }
+
+    template<typename T, typename... Rest>
+    static inline void encode_args(char *&pos, const char *end, const T& first, const Rest&... rest)
+    {
+        encode_arg(pos, end, first);
+        encode_args(pos, end, rest...);
+    }
+
+    // Integers, chars, enums and pointers are all stored as 64-bit integers.
+    template<typename T>
+    static inline void encode_arg(char *&pos, const char *end, T value)
+    {
+        int64_t raw = (int64_t)value;
+
+        encode_raw(pos, end, &raw, sizeof(raw));
+    }
+
+    static inline void encode_arg(char *&pos, const char *end, double value)
+    {
+        encode_raw(pos, end, &value, sizeof(value));
+    }
+
+    static inline void encode_arg(char *&pos, const char *end, float value)
+    {
+        encode_arg(pos, end, (double)value);
+    }
+
+    static inline void encode_arg(char *&pos, const char *end, long double value)
+    {
+        encode_arg(pos, end, (double)value);
+    }
+
+    // Strings are stored as a 32-bit length followed by the characters.
+    static void encode_arg(char *&pos, const char *end, const char *value);
+
+    static inline void encode_arg(char *&pos, const char *end, char *value)
+    {
+        encode_arg(pos, end, (const char *)value);
+    }
+
+    static inline void encode_raw(char *&pos, const char *end, const void *value, int len)
+    {
+        if (end - pos < len)
+            return; // the argument is missing in the record then
+
+        memcpy(pos, value, len);
+        pos += len;
+    }
+
+/* ===================================
+ * data:
+ * =================================== */
+protected:
+    int32_t m_file_serial;
+};
+
+CA_LIB_NAMESPACE_END
+
+#ifndef NO_CA_LOG
+
+// Defines a call site and logs into a binary_logger instance.
+#define BLOG(logger, log_level, fmt, ...)       do{\
+    static CA_LIB_NAMESPACE::binary_logger::site_t __ca_blog_site = { 0, 0, log_level, fmt }; \
+    (logger).log(__ca_blog_site, ##__VA_ARGS__); \
+}while(0)
+
+#endif // NO_CA_LOG
+
+#endif // __CPP_ASSISTANT_BINARY_LOGGER_H__
@@ -0,0 +1,168 @@
+/*
+ * Copyright (c) 2026, Wen Xiongchang <udc577 at 126 dot com>
+ * All rights reserved.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any
+ * damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any
+ * purpose, including commercial applications, and to alter it and
+ * redistribute it freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must
+ * not claim that you wrote the original software. If you use this
+ * software in a product, an acknowledgment in the product documentation
+ * would be appreciated but is not required.
+ *
+ * 2. Altered source versions must be plainly marked as such, and
+ * must not be misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source
+ * distribution.
+ */
+
+// NOTE: The original author also uses (short/code) names listed below,
+//       for convenience or for a certain purpose, at different places:
+//       wenxiongchang, wxc, Damon Wen, udc577
+
+/*
+ * connection_pool.h
+ *
+ *  Created on: 2026-10-17
+ *      Author: wenxiongchang
+ * Description: Pool of network connection nodes and their buffers.
+ */
+
+#ifndef __CPP_ASSISTANT_CONNECTION_POOL_H__
+#define __CPP_ASSISTANT_CONNECTION_POOL_H__
+
+#include <map>
+#include <vector>
+
+#include "base/ca_inner_necessities.h"
+#include "net_common.h"
+
+CA_LIB_NAMESPACE_BEGIN
+
+/*
+ * Recycles net_connection nodes and buffers, as a replacement of
+ * create_net_connection() and destroy_net_connection() on frequent connecting and disconnecting.
+ * Nodes are carved from slabs which grow geometrically and are freed on destruction only,
+ * and buffers are kept in free lists by their sizes, with at most max_idle_count() ones per size.
+ * Idle memory is up to max_idle_count() * size for each fixed buffer size in use, as growable buffers
+ * free their memory when released. Raise it with set_max_idle_count() (e.g. via tcp_base::conn_pool())
+ * if connections churn in bursts larger than the default, or lower it to 0 to keep no idle buffers.
+ * NOTE: It's not thread-safe, use one pool per thread, just like tcp_server and tcp_client.
+ */
+class connection_pool
+{
+/* ===================================
+ * constructors:
+ * =================================== */
+public:
+    explicit connection_pool(int max_idle_count = DEFAULT_MAX_IDLE_COUNT);
+
+/* ===================================
+ * copy control:
+ * =================================== */
+private:
+    connection_pool(const connection_pool& src);
+    connection_pool& operator=(const connection_pool& src);
+
+/* ===================================
+ * destructor:
+ * =================================== */
+public:
+    ~connection_pool();
+
+/* ===================================
+ * types:
+ * =================================== */
+public:
+    enum
+    {
+        MIN_SLAB_NODE_COUNT = 64,
+        MAX_SLAB_NODE_COUNT = 1024 * 8,
+        DEFAULT_MAX_IDLE_COUNT = 32, // 4 MB at most for 128 KB buffers
+    };
+
+/* ===================================
+ * abilities:
+ * =================================== */
+public:
+    // Like create_net_connection(), returns a connection node with new or recycled buffers.
+    net_connection *acquire(int send_buf_size, int recv_buf_size);
+
+    // Like destroy_net_connection(), closes the socket, and recycles the node and its buffers.
+    // Nodes not allocated by this pool are destroyed directly.
+    void release(net_connection *conn);
+
+    // Returns a buffer whose total size is @size (or MIN_BUF_SIZE if it's smaller),
+    // which is a recycled one if available. If initial_buffer_size() is less than @size,
+    // the buffer is a growable one which starts from that size and grows up to @size.
+    buffer *acquire_buffer(int size);
+    void release_buffer(buffer *buf);
+
+    // Frees all idle buffers, nodes in use are not affected.
+    void shrink(void);
+
+/* ===================================
+ * attributes:
+ * =================================== */
+public:
+    inline int max_idle_count(void) const
+    {
+        return m_max_idle_count;
+    }
+
+    // Sets the maximum count of idle buffers kept for each buffer size.
+    inline void set_max_idle_count(int count)
+    {
+        m_max_idle_count = (count >= 0) ? count : DEFAULT_MAX_IDLE_COUNT;
+    }
+
+    inline int idle_node_count(void) const
+    {
+        return (int)m_idle_nodes.size();
+    }
+
+    int idle_buffer_count(void) const;
+
+    inline int initial_buffer_size(void) const
+    {
+        return m_initial_buf_size;
+    }
+
+    // Sets the initial size of buffers to be acquired, 0 for allocating memory on first use,
+    // or a negative number(by default) for allocating the full size at once.
+    // Memory of growable buffers is released when they go back to the pool.
+    inline void set_initial_buffer_size(int size)
+    {
+        m_initial_buf_size = size;
+    }
+
+/* ===================================
+ * private methods:
+ * =================================== */
+private:
+    int grow_slabs(void);
+    bool owns(const net_connection *conn) const;
+
+/* ===================================
+ * data:
+ * =================================== */
+private:
+    typedef std::pair<net_connection*, int> slab_t; // (nodes, node count)
+
+    std::vector<slab_t> m_slabs;
+    std::vector<net_connection*> m_idle_nodes;
+    std::map<int, std::vector<buffer*> > m_idle_buffers; // key: buffer size
+    std::map<int, std::vector<buffer*> > m_idle_growable_buffers; // key: maximum buffer size
+    int m_max_idle_count;
+    int m_initial_buf_size;
+};
+
+CA_LIB_NAMESPACE_END
+
+#endif // __CPP_ASSISTANT_CONNECTION_POOL_H__
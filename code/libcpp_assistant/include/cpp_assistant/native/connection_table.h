@@ -0,0 +1,177 @@
+/*
+ * Copyright (c) 2026, Wen Xiongchang <udc577 at 126 dot com>
+ * All rights reserved.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any
+ * damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any
+ * purpose, including commercial applications, and to alter it and
+ * redistribute it freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must
+ * not claim that you wrote the original software. If you use this
+ * software in a product, an acknowledgment in the product documentation
+ * would be appreciated but is not required.
+ *
+ * 2. Altered source versions must be plainly marked as such, and
+ * must not be misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source
+ * distribution.
+ */
+
+// NOTE: The original author also uses (short/code) names listed below,
+//       for convenience or for a certain purpose, at different places:
+//       wenxiongchang, wxc, Damon Wen, udc577
+
+/*
+ * connection_table.h
+ *
+ *  Created on: 2026-10-17
+ *      Author: wenxiongchang
+ * Description: Table of network connections indexed by file descriptor.
+ */
+
+#ifndef __CPP_ASSISTANT_CONNECTION_TABLE_H__
+#define __CPP_ASSISTANT_CONNECTION_TABLE_H__
+
+#include <stddef.h>
+
+#include <vector>
+#include <utility>
+
+#include "base/ca_inner_necessities.h"
+
+CA_LIB_NAMESPACE_BEGIN
+
+struct net_connection;
+
+/*
+ * A replacement of std::map<int, net_connection*> for peers of TCP utility classes.
+ * Connections are stored densely so that a traversal only costs as much as the number of
+ * connections, and a position table indexed by fd makes lookup, insertion and erasure O(1).
+ * NOTE: Erasure moves the last element into the erased position,
+ *     so DO NOT erase elements while iterating forward over the table.
+ */
+class connection_table
+{
+/* ===================================
+ * constructors:
+ * =================================== */
+public:
+    connection_table();
+
+/* ===================================
+ * copy control:
+ * =================================== */
+private:
+    connection_table(const connection_table& src);
+    connection_table& operator=(const connection_table& src);
+
+/* ===================================
+ * destructor:
+ * =================================== */
+public:
+    ~connection_table();
+
+/* ===================================
+ * types:
+ * =================================== */
+public:
+    typedef std::pair<int, net_connection*> value_type; // (fd, connection)
+    typedef std::vector<value_type> element_array;
+    typedef element_array::iterator iterator;
+    typedef element_array::const_iterator const_iterator;
+
+/* ===================================
+ * abilities:
+ * =================================== */
+public:
+    // Returns an iterator pointing to the element with key @fd, or end() if not found.
+    iterator find(int fd);
+    const_iterator find(int fd) const;
+
+    // Inserts @conn with key @fd. Returns an iterator to the element with key @fd
+    // and false if the key exists already, or true if it's a new element.
+    std::pair<iterator, bool> insert(int fd, net_connection *conn);
+
+    // Returns the count of elements erased, which is 0 or 1.
+    size_t erase(int fd);
+
+    void clear(void);
+
+    // Reserves space for at least @count connections.
+    void reserve(int count);
+
+/* ===================================
+ * attributes:
+ * =================================== */
+public:
+    inline iterator begin(void)
+    {
+        return m_elements.begin();
+    }
+
+    inline const_iterator begin(void) const
+    {
+        return m_elements.begin();
+    }
+
+    inline iterator end(void)
+    {
+        return m_elements.end();
+    }
+
+    inline const_iterator end(void) const
+    {
+        return m_elements.end();
+    }
+
+    inline size_t size(void) const
+    {
+        return m_elements.size();
+    }
+
+/* ===================================
+ * status:
+ * =================================== */
+public:
+    inline bool empty(void) const
+    {
+        return m_elements.empty();
+    }
+
+/* ===================================
+ * operators:
+ * =================================== */
+public:
+    // Like std::map, inserts a null connection if @fd does not exist.
+    net_connection*& operator[](int fd);
+
+/* ===================================
+ * private methods:
+ * =================================== */
+private:
+    inline int position_of(int fd) const
+    {
+        return (fd >= 0 && fd < (int)m_positions.size()) ? m_positions[fd] : INVALID_POSITION;
+    }
+
+/* ===================================
+ * data:
+ * =================================== */
+private:
+    enum
+    {
+        INVALID_POSITION = -1
+    };
+
+    element_array m_elements;
+    std::vector<int> m_positions; // index: fd, value: position in m_elements
+};
+
+CA_LIB_NAMESPACE_END
+
+#endif // __CPP_ASSISTANT_CONNECTION_TABLE_H__
@@ -37,6 +37,11 @@
 #ifndef __CPP_ASSISTANT_FILE_LOGGER_H__
 #define __CPP_ASSISTANT_FILE_LOGGER_H__
 
+#include <pthread.h>
+
+#include <string>
+#include <deque>
+
 #include "logger.h"
 
 CA_LIB_NAMESPACE_BEGIN
@@ -136,22 +141,132 @@ public:
         return CA_RET_OK;
     }
 
+    virtual int64_t log_size_limit(void)
+    {
+        return m_size_limit;
+    }
+
+    // Sets how many bytes a fragment can hold roughly, 0 means no limit (the default),
+    // or it is LOG_SIZE_LIMIT_MIN at least.
+    // NOTE: It can not be called when the logger is open.
+    int set_log_size_limit(int64_t limit);
+
+    // In background rotation, the next fragment is opened in advance by a housekeeping thread,
+    // so that the logging thread only swaps file handles when the logger switches,
+    // and the finished fragment is flushed, closed, renamed, compressed and so on in that thread.
+    inline bool rotates_in_background(void) const
+    {
+        return m_rotates_in_background;
+    }
+
+    // NOTE: It can not be called when the logger is open.
+    int set_rotates_in_background(bool enabled);
+
+    inline const char *compression_command(void) const
+    {
+        return m_compression_command.c_str();
+    }
+
+    // Sets a shell command compressing finished fragments, such as "gzip -f" or "zstd -q --rm",
+    // which is run by /bin/sh with the path of a fragment as its last argument.
+    // An empty command means no compression (the default).
+    // NOTE: It takes effect in background rotation only, and can not be called when the logger is open.
+    int set_compression_command(const char *command) CA_NOTNULL(2);
+
+    inline int max_fragments(void) const
+    {
+        return m_max_fragments;
+    }
+
+    // Sets how many finished fragments with the same base name and the current PID are kept
+    // in the log directory, the oldest ones are removed when there are more, 0 means no limit (the default).
+    // NOTE: It takes effect in background rotation only, and can not be called when the logger is open.
+    int set_max_fragments(int count);
+
 /* ===================================
  * status:
  * =================================== */
 public:
+    // The latest error of the housekeeping thread in background rotation, 0 if none.
+    inline int rotation_error(void) const
+    {
+        return __atomic_load_n(&m_rotation_error, __ATOMIC_RELAXED);
+    }
 
 /* ===================================
  * operators:
  * =================================== */
 public:
 
+/* ===================================
+ * types:
+ * =================================== */
+public:
+    enum
+    {
+        LOG_SIZE_LIMIT_MIN = 64 * 1024
+    };
+
+protected:
+    // A fragment handed over to the housekeeping thread when the logger switches.
+    typedef struct finished_fragment_t
+    {
+        FILE *holder;
+        char *buffer;
+        std::string tmp_path; // the finished fragment, renamed into final_path
+        std::string final_path;
+        std::string current_src_path; // the pre-opened fragment, which is the current one now,
+        std::string current_dst_path; // and renamed into current_dst_path
+        std::string next_path; // where the next fragment is pre-opened
+    }finished_fragment_t;
+
 /* ===================================
  * private methods:
  * =================================== */
 protected:
+    // Switches to a new fragment, by swapping in the pre-opened one in background rotation.
     virtual int __switch_logger_status(void);
 
+    // Called when a new fragment becomes the current one, before anything is written into it.
+    virtual int __start_fragment(void)
+    {
+        return CA_RET_OK;
+    }
+
+    // Called when the current fragment is going to be closed or handed over to the housekeeping thread.
+    virtual void __end_fragment(void)
+    {
+        ;
+    }
+
+    // Opens and closes the current fragment, without starting or stopping the housekeeping thread.
+    int __open_fragment(int cache_buf_size);
+    int __close_fragment(bool release_buffer);
+
+    int __swap_in_next_fragment(void);
+
+    inline bool __needs_housekeeper(void) const
+    {
+        return m_rotates_in_background || !m_compression_command.empty() || m_max_fragments > 0;
+    }
+
+    int __start_housekeeper(void);
+    void __stop_housekeeper(void);
+
+    static void *housekeeper_routine(void *arg);
+
+    // Called by the housekeeping thread, or by close() after the thread stops.
+    void __preopen_next_fragment(const std::string &path);
+    void __finish_fragment(const finished_fragment_t &fragment);
+    void __compress_fragment(const std::string &path);
+    void __remove_old_fragments(void);
+
+    // Gets the path of the current fragment, with @suffix appended.
+    std::string __fragment_path(const char *suffix) const;
+
+    // Gets the base name from the current log name.
+    std::string __base_name(void) const;
+
     int __update_log_num(void);
 
     int __innerly_set_log_name(const char *base_name, bool updates_log_num = false);
@@ -172,6 +287,28 @@ protected:
     char *m_log_name;
     char *m_log_directory;
     char *m_buffer;
+    int m_cache_buf_size;
+    int64_t m_size_limit;
+    bool m_rotates_in_background;
+    int m_max_fragments;
+    std::string m_compression_command;
+
+    /*
+     * Used in background rotation, guarded by m_housekeeping_mutex except the thread itself.
+     */
+
+    pthread_t m_housekeeper;
+    pthread_mutex_t m_housekeeping_mutex;
+    pthread_cond_t m_housekeeping_cond;
+    bool m_housekeeper_running;
+    bool m_stop_requested;
+    std::deque<finished_fragment_t> m_finished_fragments;
+    FILE *m_next_holder; // the pre-opened fragment
+    char *m_next_buffer;
+    std::string m_next_path;
+    int m_preopen_error;
+    std::string m_base_name; // fragments with this base name are kept at most m_max_fragments
+    int m_rotation_error;
 };
 
 typedef file_logger flog;
@@ -0,0 +1,187 @@
+/*
+ * Copyright (c) 2026, Wen Xiongchang <udc577 at 126 dot com>
+ * All rights reserved.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any
+ * damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any
+ * purpose, including commercial applications, and to alter it and
+ * redistribute it freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must
+ * not claim that you wrote the original software. If you use this
+ * software in a product, an acknowledgment in the product documentation
+ * would be appreciated but is not required.
+ *
+ * 2. Altered source versions must be plainly marked as such, and
+ * must not be misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source
+ * distribution.
+ */
+
+// NOTE: The original author also uses (short/code) names listed below,
+//       for convenience or for a certain purpose, at different places:
+//       wenxiongchang, wxc, Damon Wen, udc577
+
+/*
+ * kv_line.h
+ *
+ *  Created on: 2026-10-17
+ *      Author: wenxiongchang
+ * Description: Renderer of structured log lines made up of typed key/value pairs.
+ */
+
+#ifndef __CPP_ASSISTANT_KV_LINE_H__
+#define __CPP_ASSISTANT_KV_LINE_H__
+
+#include <stdint.h>
+
+#include <string>
+
+#include "base/ca_inner_necessities.h"
+
+CA_LIB_NAMESPACE_BEGIN
+
+enum enum_kv_format
+{
+    KV_FORMAT_TEXT = 0, // message: key1[value1] | key2[value2] | ..., after the usual prefix
+    KV_FORMAT_JSON      // {"ts":<UTC microseconds>,"level":"I","msg":"message","key1":value1,...}, one object a line
+};
+
+/*
+ * Renders a structured log line into a buffer of its own, field by field, without printf-like formatting
+ * except for floating points. Fields beyond MAX_LEN are dropped, and the line is always ended properly.
+ */
+class kv_line
+{
+/* ===================================
+ * constructors:
+ * =================================== */
+public:
+    explicit kv_line(enum_kv_format format);
+
+/* ===================================
+ * copy control:
+ * =================================== */
+private:
+    kv_line(const kv_line& src);
+    kv_line& operator=(const kv_line& src);
+
+/* ===================================
+ * types:
+ * =================================== */
+public:
+    enum
+    {
+        MAX_LEN = 4096
+    };
+
+/* ===================================
+ * abilities:
+ * =================================== */
+public:
+    // @level_str is a name of log level, such as "I", which is used by JSON only.
+    void begin(const char *level_str, const char *message);
+
+    void add(const char *key, long long value);
+    void add(const char *key, unsigned long long value);
+    void add(const char *key, double value);
+    void add(const char *key, bool value);
+    void add(const char *key, const char *value);
+
+    inline void add(const char *key, int value)
+    {
+        add(key, (long long)value);
+    }
+
+    inline void add(const char *key, long value)
+    {
+        add(key, (long long)value);
+    }
+
+    inline void add(const char *key, short value)
+    {
+        add(key, (long long)value);
+    }
+
+    inline void add(const char *key, unsigned int value)
+    {
+        add(key, (unsigned long long)value);
+    }
+
+    inline void add(const char *key, unsigned long value)
+    {
+        add(key, (unsigned long long)value);
+    }
+
+    inline void add(const char *key, unsigned short value)
+    {
+        add(key, (unsigned long long)value);
+    }
+
+    inline void add(const char *key, float value)
+    {
+        add(key, (double)value);
+    }
+
+    inline void add(const char *key, char *value)
+    {
+        add(key, (const char *)value);
+    }
+
+    inline void add(const char *key, const std::string &value)
+    {
+        add(key, value.c_str());
+    }
+
+    // Ends the line with a '\n'.
+    void end(void);
+
+/* ===================================
+ * attributes:
+ * =================================== */
+public:
+    inline const char *data(void) const
+    {
+        return m_buf;
+    }
+
+    inline int length(void) const
+    {
+        return m_len;
+    }
+
+/* ===================================
+ * private methods:
+ * =================================== */
+protected:
+    // Starts a field and appends its key, returns false if there is no room for the field.
+    bool __begin_field(const char *key);
+    void __end_field(void);
+
+    // Appends as much as there is room for, and marks the line full if something is cut off.
+    void __append(const char *str, int len);
+    // Appends endings, for which there is always room.
+    void __force_append(const char *str, int len);
+    void __append_escaped(const char *str);
+    void __append_integer(unsigned long long value, bool is_negative);
+
+/* ===================================
+ * data:
+ * =================================== */
+protected:
+    enum_kv_format m_format;
+    int m_len;
+    int m_field_start; // where the current field starts, a field is removed as a whole if it's cut off
+    int m_field_count;
+    bool m_has_message;
+    bool m_is_full;
+    char m_buf[MAX_LEN + 1];
+};
+
+CA_LIB_NAMESPACE_END
+
+#endif // __CPP_ASSISTANT_KV_LINE_H__
@@ -38,10 +38,13 @@
 #define __CPP_ASSISTANT_LOG_BASE_H__
 
 #include <stdio.h>
+#include <stdint.h>
 #include <time.h>
 
 #include "base/ca_inner_necessities.h"
 #include "base/ca_return_code.h"
+#include "base/platforms/threading.h"
+#include "kv_line.h"
 
 CA_LIB_NAMESPACE_BEGIN
 
@@ -113,6 +116,7 @@ extern const bool HAS_LOG_PREFIX/* = true*/;
 extern const bool NO_LOG_PREFIX/* = false*/;
 extern const bool RELEASES_LOG_BUF_ON_CLOSE/* = true*/;
 extern const bool NOT_RELEASE_LOG_BUF_ON_CLOSE/* = false*/;
+extern const char *G_LOG_LEVEL_STRINGS[];
 
 class logger
 {
@@ -135,6 +139,11 @@ private:
 public:
     typedef int (*FormattedOutput)(const char *fmt, ...);
 
+    enum
+    {
+        LOG_PREFIX_LEN = 22 // "LMMDD HH:MM:SS.uuuuuu ", L for the level
+    };
+
 /* ===================================
  * destructor:
  * =================================== */
@@ -166,7 +175,7 @@ public:
 
     // Flushes log contents to destination (that is: a file or the terminal).
     // This function can be called by user or by other member functions.
-    void flush(void);
+    virtual void flush(void);
 
     /*
      * Outputs log contents to cache or to a certain destination (that is: a file or the terminal).
@@ -175,7 +184,7 @@ public:
      * Different derived classes can have different implementations.
      */
 
-    int output(bool has_prefix,
+    virtual int output(bool has_prefix,
         enum_log_level log_level,
         const char *fmt,
         va_list args) CA_NOTNULL(4);
@@ -217,6 +226,37 @@ public:
     int CRITICAL(const char *fmt, ...) CA_NOTNULL(2) CA_PRINTF_CHECK(2, 3);
     int C(const char *fmt, ...) CA_NOTNULL(2) CA_PRINTF_CHECK(2, 3);
 
+    // Outputs a line which is formatted already and @len long.
+    virtual int output_formatted(bool has_prefix,
+        enum_log_level log_level,
+        const char *line,
+        int len) CA_NOTNULL(4);
+
+    /*
+     * Structured logging: @key_values are pairs of a key (C string) and a value
+     * (integer, floating point, bool, C string or std::string), rendered by kv_line in the format
+     * set by set_kv_format(), for example:
+     *     logger.kv(LOG_LEVEL_INFO, "new connection arrived", "fd", fd, "peer_ip", peer_ip);
+     * Values are never formatted by a printf-like function, except for floating points.
+     */
+    template<typename... Args>
+    int kv(enum_log_level log_level, const char *message, const Args&... key_values)
+    {
+        static_assert(0 == sizeof...(Args) % 2, "keys and values must be in pairs");
+
+        if (log_level < m_log_level)
+            return 0;
+
+        kv_line line(m_kv_format);
+
+        line.begin(G_LOG_LEVEL_STRINGS[log_level % LOG_LEVEL_COUNT], message);
+        __add_kv_fields(line, key_values...);
+        line.end();
+
+        // Time and level are fields of a JSON line.
+        return output_formatted(KV_FORMAT_TEXT == m_kv_format, log_level, line.data(), line.length());
+    }
+
 /* ===================================
  * attributes:
  * =================================== */
@@ -224,12 +264,27 @@ public:
 
     inline enum_log_level log_level(void) const
     {
-        return m_log_level;
+        return m_unmuted_level;
     }
 
     inline void set_log_level(enum_log_level log_level)
     {
-        m_log_level = (enum_log_level)(log_level % LOG_LEVEL_COUNT);
+        m_unmuted_level = (enum_log_level)(log_level % LOG_LEVEL_COUNT);
+        if (!m_is_muted)
+            m_log_level = m_unmuted_level;
+    }
+
+    inline bool is_muted(void) const
+    {
+        return m_is_muted;
+    }
+
+    // A muted logger drops every line at the level check, before anything is formatted,
+    // and its log level comes back when it's unmuted.
+    inline void set_muted(bool muted)
+    {
+        m_is_muted = muted;
+        m_log_level = muted ? LOG_LEVEL_COUNT : m_unmuted_level;
     }
 
     // A default implementation of getting directory in order to support polymorphism.
@@ -267,6 +322,49 @@ public:
 
     virtual int set_log_line_limit(int limit) = 0;
 
+    // Log size limit restricts how many bytes a logger fragment can hold roughly, 0 means no limit.
+    // A default implementation in order to support polymorphism.
+    virtual int64_t log_size_limit(void)
+    {
+        return 0;
+    }
+
+    // Whether the time of log lines is read from CLOCK_REALTIME_COARSE,
+    // which is cheaper but only accurate to a few milliseconds.
+    inline bool uses_coarse_clock(void) const
+    {
+        return m_uses_coarse_clock;
+    }
+
+    inline void set_uses_coarse_clock(bool enabled)
+    {
+        m_uses_coarse_clock = enabled;
+    }
+
+    inline enum_kv_format kv_format(void) const
+    {
+        return m_kv_format;
+    }
+
+    // Sets the format of lines from kv(), KV_FORMAT_TEXT by default.
+    inline void set_kv_format(enum_kv_format format)
+    {
+        m_kv_format = format;
+    }
+
+    // In thread-safe mode, each thread formats its log lines into its own buffer,
+    // and the writing and switching of the logger are done in a lock.
+    // NOTE: Opening, closing and other settings are not protected, do them before other threads start logging.
+    inline bool is_thread_safe(void) const
+    {
+        return m_is_thread_safe;
+    }
+
+    inline void set_thread_safe(bool enabled)
+    {
+        m_is_thread_safe = enabled;
+    }
+
     // Gets the output holder of a logger.
     // Output holder is the destination where log contents are output.
     // It can be a file handle, stdout, stderr, etc.
@@ -311,6 +409,12 @@ public:
         return m_cur_line;
     }
 
+    // Shows how many bytes have been output by the logger in current fragment.
+    inline int64_t current_log_size(void) const
+    {
+        return m_cur_size;
+    }
+
     // To prevent the initial generated stuff, generally a log file, becoming too big,
     // we split it into multiple fragments if needed, and give each of them a number.
     // This function shows how many fragments are generated currently.
@@ -476,6 +580,52 @@ protected:
         return CA_RET_OK;
     }
 
+    static inline void __add_kv_fields(kv_line &line)
+    {
+        ;
+    }
+
+    template<typename V, typename... Args>
+    static inline void __add_kv_fields(kv_line &line, const char *key, const V &value, const Args&... key_values)
+    {
+        line.add(key, value);
+        __add_kv_fields(line, key_values...);
+    }
+
+    // Calls __write_line() with a formatted line, for there is no va_list to pass otherwise.
+    int __write_formatted_line(bool has_prefix, enum_log_level log_level, const char *line, int len, ...);
+
+    // Whether the current fragment is full or out of date, read m_now by __update_log_time() first.
+    inline bool __needs_switching(void)
+    {
+        int64_t size_limit = log_size_limit();
+
+        return m_cur_line >= log_line_limit()
+            || (size_limit > 0 && m_cur_size >= size_limit)
+            || m_now.tm_mday != m_date.tm_mday;
+    }
+
+    // Writes a log line, whose contents are formatted already if @formatted is not null.
+    int __write_line(bool has_prefix,
+        enum_log_level log_level,
+        const char *formatted,
+        int formatted_len,
+        const char *fmt,
+        va_list args);
+
+    // Reads the clock into m_now, and rebuilds the date and time part of the cached prefix
+    // only when the second changes, the microseconds part is patched in every time.
+    void __update_log_time(void);
+
+    // Gets the prefix of a log line written at the time read by the latest __update_log_time(),
+    // which is LOG_PREFIX_LEN long.
+    inline const char *__log_prefix(enum_log_level level)
+    {
+        m_prefix[0] = G_LOG_LEVEL_STRINGS[level % LOG_LEVEL_COUNT][0];
+
+        return m_prefix;
+    }
+
     template<typename T>
     inline logger& operator<<(const T input) // TODO: does not work
     {
@@ -519,7 +669,7 @@ protected:
 
     void color_control_start(void)
     {
-        if (!m_to_screen)
+        if (!m_uses_colors)
             return;
 
         if (LOG_LEVEL_WARNING == m_instant_level)
@@ -531,7 +681,7 @@ protected:
 
     void color_control_end(void)
     {
-        if (!m_to_screen)
+        if (!m_uses_colors)
             return;
 
         if (m_instant_level >= LOG_LEVEL_WARNING)
@@ -547,14 +697,26 @@ protected:
  * data:
  * =================================== */
 protected:
-    enum_log_level m_log_level;
+    enum_log_level m_log_level; // LOG_LEVEL_COUNT if muted
+    enum_log_level m_unmuted_level;
     enum_log_level m_instant_level;
+    bool m_is_muted;
     bool m_is_open;
     FILE *m_output_holder;
     int m_cur_line;
+    int64_t m_cur_size;
     int m_log_num;
     struct tm m_date;
     bool m_to_screen;
+    bool m_uses_colors; // ANSI colors for warnings and errors, for a screen logger on a terminal only
+    bool m_uses_coarse_clock;
+    bool m_is_thread_safe;
+    enum_kv_format m_kv_format;
+    mutex m_output_lock; // used in thread-safe mode only
+    time_t m_now_sec;
+    long m_now_usec;
+    struct tm m_now;
+    char m_prefix[LOG_PREFIX_LEN + 1];
 };
 
 CA_LIB_NAMESPACE_END
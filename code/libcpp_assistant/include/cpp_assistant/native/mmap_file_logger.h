@@ -0,0 +1,162 @@
+/*
+ * Copyright (c) 2026, Wen Xiongchang <udc577 at 126 dot com>
+ * All rights reserved.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any
+ * damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any
+ * purpose, including commercial applications, and to alter it and
+ * redistribute it freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must
+ * not claim that you wrote the original software. If you use this
+ * software in a product, an acknowledgment in the product documentation
+ * would be appreciated but is not required.
+ *
+ * 2. Altered source versions must be plainly marked as such, and
+ * must not be misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source
+ * distribution.
+ */
+
+// NOTE: The original author also uses (short/code) names listed below,
+//       for convenience or for a certain purpose, at different places:
+//       wenxiongchang, wxc, Damon Wen, udc577
+
+/*
+ * mmap_file_logger.h
+ *
+ *  Created on: 2026-10-17
+ *      Author: wenxiongchang
+ * Description: File logger writing log lines into a shared memory mapping of the log file.
+ */
+
+#ifndef __CPP_ASSISTANT_MMAP_FILE_LOGGER_H__
+#define __CPP_ASSISTANT_MMAP_FILE_LOGGER_H__
+
+#include <stdint.h>
+
+#include "file_logger.h"
+
+CA_LIB_NAMESPACE_BEGIN
+
+/*
+ * A file logger which writes log lines into a MAP_SHARED window of the log file instead of a stdio buffer,
+ * so that the lines written are in the page cache at once and survive a crash of the process,
+ * without flushing anything per line.
+ * The file is extended window by window, and truncated to the length written when a fragment is finished.
+ * After a crash, the file ends with zeros filling up the last window,
+ * and the length written is where the zeros start, for log lines contain no '\0'.
+ * NOTE: Like other loggers, it is supposed to be called by one thread only unless it is in thread-safe mode.
+ *     Only formatted logging goes into the mapping: do not use stream-style logging on it,
+ *     nor redirect the inner debug output to it.
+ */
+class mmap_file_logger : public file_logger
+{
+/* ===================================
+ * constructors:
+ * =================================== */
+public:
+    mmap_file_logger();
+
+/* ===================================
+ * copy control:
+ * =================================== */
+private:
+    mmap_file_logger(const mmap_file_logger& src);
+    mmap_file_logger& operator=(const mmap_file_logger& src);
+
+/* ===================================
+ * destructor:
+ * =================================== */
+public:
+    ~mmap_file_logger();
+
+/* ===================================
+ * types:
+ * =================================== */
+public:
+    enum enum_window_size
+    {
+        MIN_WINDOW_SIZE = 64 * 1024,
+        MAX_WINDOW_SIZE = 1024 * 1024 * 1024
+    };
+
+    enum
+    {
+        MAX_LINE_LEN = 8 * 1024 // longer lines are truncated
+    };
+
+/* ===================================
+ * abilities:
+ * =================================== */
+public:
+    // Opens the log file, @cache_buf_size is used as the size of the mapping window,
+    // which is rounded into [MIN_WINDOW_SIZE, MAX_WINDOW_SIZE] and up to a multiple of the page size.
+    virtual int open(int cache_buf_size = DEFAULT_LOG_CACHE_SIZE);
+
+    using file_logger::output; // the variadic one, which would be hidden otherwise
+
+    virtual int output(bool has_prefix,
+        enum_log_level log_level,
+        const char *fmt,
+        va_list args) CA_NOTNULL(4);
+
+    virtual int output_formatted(bool has_prefix,
+        enum_log_level log_level,
+        const char *line,
+        int len) CA_NOTNULL(4);
+
+/* ===================================
+ * attributes:
+ * =================================== */
+public:
+    inline int window_size(void) const
+    {
+        return m_window_size;
+    }
+
+/* ===================================
+ * private methods:
+ * =================================== */
+protected:
+    // Maps the new fragment from its beginning.
+    virtual int __start_fragment(void);
+
+    // Unmaps the finished fragment, and truncates it to the length written.
+    virtual void __end_fragment(void);
+
+    // Writes a log line, whose contents are formatted already if @formatted is not null.
+    int __write_mapped_line(bool has_prefix,
+        enum_log_level log_level,
+        const char *formatted,
+        int formatted_len,
+        const char *fmt,
+        va_list args);
+
+    // Maps the window containing file offset @offset, extending the file if needed.
+    int __map_window(int64_t offset);
+
+    inline int64_t __room_in_window(void) const
+    {
+        return m_map_offset + m_map_len - m_write_offset;
+    }
+
+/* ===================================
+ * data:
+ * =================================== */
+protected:
+    int m_window_size;
+    int m_fd;
+    char *m_map;
+    int64_t m_map_offset; // file offset of the window
+    int64_t m_map_len;
+    int64_t m_write_offset; // file offset where the next line is written
+};
+
+CA_LIB_NAMESPACE_END
+
+#endif // __CPP_ASSISTANT_MMAP_FILE_LOGGER_H__
@@ -95,6 +95,41 @@ enum
 class sequential_buffer;
 typedef sequential_buffer buffer;
 
+// A packet shared by all connections it is queued to, and freed after the last one sends it,
+// so that a packet sent to many connections is copied only once, see tcp_base::enqueue_to_connection().
+typedef struct shared_packet
+{
+    int ref_count;
+    int len;
+    char data[1]; // @len bytes actually
+}shared_packet;
+
+// Returns a packet holding a copy of @data with one reference, or nullptr on failure.
+CA_REENTRANT shared_packet *create_shared_packet(const void *data, int len);
+CA_REENTRANT void retain_shared_packet(shared_packet *packet);
+// Drops a reference, and frees the packet if it is the last one.
+CA_REENTRANT void release_shared_packet(shared_packet **packet);
+
+// A node of a send queue holds either a shared packet, or a span of bytes in send_buf
+// written before the packets after it, see push_send_queue().
+typedef struct send_queue_node
+{
+    shared_packet *packet; // nullptr for a span of send_buf
+    int offset; // bytes of the packet sent already
+    int buf_len; // bytes of the span not sent yet
+    struct send_queue_node *next;
+}send_queue_node;
+
+struct net_connection;
+
+// Connections which have data left to send, linked through their pending_prev and pending_next,
+// so that a round of flushing visits them only instead of all connections, see mark_send_pending().
+typedef struct send_pending_list
+{
+    struct net_connection *head;
+    int count;
+}send_pending_list;
+
 typedef struct net_connection
 {
     int fd;
@@ -107,7 +142,24 @@ typedef struct net_connection
     int conn_status; // connection status defined by enum ConnectionStatus
     bool is_blocking;
     bool is_validated;
+    // Set if the last receive operation stopped before the socket was drained,
+    // which means more data is pending, mainly for edge-triggered monitoring.
+    bool is_still_readable;
+    // Set if outgoing data should be held in send_buf until the connection is uncorked,
+    // see tcp_base::cork_connection().
+    bool is_corked;
     buffer *send_buf;
+    // Packets and spans of send_buf to be sent in order, followed by the rest of send_buf,
+    // see tcp_base::enqueue_to_connection().
+    send_queue_node *send_queue_head;
+    send_queue_node *send_queue_tail;
+    int queued_bytes; // bytes of packets in the send queue not sent yet
+    int queued_buf_bytes; // bytes of send_buf covered by spans in the send queue
+    // The list of its tcp manager that it is in while it has data to send, see tcp_base::send_pending_head().
+    send_pending_list *pending_list;
+    struct net_connection *pending_prev;
+    struct net_connection *pending_next;
+    bool is_send_pending;
     buffer *recv_buf;
     // last operation time, including but not limited to:
     // connected time, heart-beat time, send time, receive time
@@ -116,9 +168,26 @@ typedef struct net_connection
 }net_connection;
 typedef net_connection net_conn;
 
+// Resets all fields of @conn to their initial values, without releasing anything.
+CA_REENTRANT void init_net_connection(net_conn &conn);
 CA_REENTRANT net_conn *create_net_connection(int send_buf_size, int recv_buf_size);
 CA_REENTRANT void destroy_net_connection(net_conn **conn);
 
+// Appends @packet to the send queue of @conn, taking a reference to it.
+// Bytes in send_buf not covered by the queue yet are written before @packet,
+// and are appended as a span first, so that they are not overtaken by it.
+CA_REENTRANT int push_send_queue(net_conn &conn, shared_packet *packet);
+// Marks @len bytes sent in the order of the send queue of @conn and then the rest of send_buf,
+// and drops nodes sent completely.
+CA_REENTRANT void consume_send_queue(net_conn &conn, int len);
+CA_REENTRANT void clear_send_queue(net_conn &conn);
+
+// Links @conn into its pending_list if it has one and is not in it yet,
+// which should be done whenever data is left in its send buffer or send queue.
+CA_REENTRANT void mark_send_pending(net_conn &conn);
+// Unlinks @conn from its pending_list if it is in it.
+CA_REENTRANT void unmark_send_pending(net_conn &conn);
+
 CA_REENTRANT bool is_valid_ipv4(const char *ip);
 
 CA_LIB_NAMESPACE_END
@@ -57,7 +57,7 @@ class net_poller
  * =================================== */
 public:
     net_poller();
-    net_poller(int max_conn_count, int timeout);
+    net_poller(int max_conn_count, int timeout, int event_batch_size = DEFAULT_EVENT_BATCH_SIZE);
 
 /* ===================================
  * copy control:
@@ -92,8 +92,16 @@ public:
 
     enum enum_conn_count
     {
-        DEFAULT_CONNECTION_COUNT = 1024,
-        MAX_CONNECTION_COUNT = 10000
+        DEFAULT_CONNECTION_COUNT = 1024
+    };
+
+    // Count of events fetched by one poll, which has nothing to do with the count of
+    // monitored connections. It grows automatically if a poll fills the whole batch.
+    enum enum_event_batch_size
+    {
+        MIN_EVENT_BATCH_SIZE = 16,
+        DEFAULT_EVENT_BATCH_SIZE = 256,
+        MAX_EVENT_BATCH_SIZE = 8192
     };
 
     enum enum_event
@@ -120,9 +128,10 @@ protected:
  * abilities:
  * =================================== */
 public:
-    // Creates a poller instance which can monitor at most @max_conn_count
-    // or MAX_CONNECTION_COUNT connections and limits poll timeout to @timeout milliseconds.
-    int create(int max_conn_count, int timeout);
+    // Creates a poller instance which can monitor at most @max_conn_count connections,
+    // limits poll timeout to @timeout milliseconds, and fetches at most @event_batch_size events
+    // (which may grow later, see set_event_batch_size()) in a single poll.
+    int create(int max_conn_count, int timeout, int event_batch_size = DEFAULT_EVENT_BATCH_SIZE);
 
     // Destroys the current poller instance.
     void destroy(void);
@@ -186,6 +195,22 @@ public:
         return m_current_connection_count;
     }
 
+    inline int event_batch_size(void) const
+    {
+        return m_event_batch_size;
+    }
+
+    // Sets the current event batch size to @size, and the batch can grow up to @max_size
+    // when a poll returns as many events as the batch size.
+    // A non-positive @max_size means the default limit MAX_EVENT_BATCH_SIZE.
+    // DO NOT call it while iterating active_connections(), since they'll be invalidated.
+    int set_event_batch_size(int size, int max_size = 0);
+
+    inline int max_event_batch_size(void) const
+    {
+        return m_max_event_batch_size;
+    }
+
     inline conn_info_array& active_connections(void)
     {
         return m_active_connections;
@@ -216,15 +241,11 @@ protected:
     void clear(void);
     inline void set_max_connection_count(int count)
     {
-        if (count <= 0)
-            m_max_connection_count = DEFAULT_CONNECTION_COUNT;
-        else if (count > MAX_CONNECTION_COUNT)
-            m_max_connection_count = MAX_CONNECTION_COUNT;
-        else
-            m_max_connection_count = count;
+        m_max_connection_count = (count > 0) ? count : DEFAULT_CONNECTION_COUNT;
     }
     bool test_single_event(int fd, int event);
     int handle_monitored_connection(const struct net_connection *conn, int events, int op_type);
+    int resize_events_holder(int size);
 
 /* ===================================
  * data:
@@ -238,6 +259,9 @@ private:
 #endif
     conn_info_array m_active_connections;
     poll_event_t *m_epoll_events_holder;
+    int m_event_batch_size; // also the capacity of m_epoll_events_holder
+    int m_max_event_batch_size;
+    bool m_needs_growing; // the last poll filled the whole batch
     int m_timeout; // in milliseconds
 };
 
@@ -0,0 +1,209 @@
+/*
+ * Copyright (c) 2026, Wen Xiongchang <udc577 at 126 dot com>
+ * All rights reserved.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any
+ * damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any
+ * purpose, including commercial applications, and to alter it and
+ * redistribute it freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must
+ * not claim that you wrote the original software. If you use this
+ * software in a product, an acknowledgment in the product documentation
+ * would be appreciated but is not required.
+ *
+ * 2. Altered source versions must be plainly marked as such, and
+ * must not be misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source
+ * distribution.
+ */
+
+// NOTE: The original author also uses (short/code) names listed below,
+//       for convenience or for a certain purpose, at different places:
+//       wenxiongchang, wxc, Damon Wen, udc577
+
+/*
+ * ring_buffer.h
+ *
+ *  Created on: 2026-10-17
+ *      Author: wenxiongchang
+ * Description: Ring buffer which never moves its data.
+ */
+
+#ifndef __CPP_ASSISTANT_RING_BUFFER_H__
+#define __CPP_ASSISTANT_RING_BUFFER_H__
+
+#include <sys/uio.h>
+
+#include "base/ca_inner_necessities.h"
+
+CA_LIB_NAMESPACE_BEGIN
+
+/*
+ * A counterpart of sequential_buffer whose data wraps around at the end of the buffer
+ * instead of being moved to the header, so both data and free space may consist of two regions,
+ * which are exposed as iovec structures for readv()/writev()/sendmsg().
+ *
+ * In mirrored mode, the buffer memory is mapped twice and back to back, so what wraps around
+ * is still contiguous in address, and get_read/write_pointer() always covers
+ * all data/free space, which suits those who parse packets in place.
+ * The total size is rounded up to a multiple of the page size in this mode.
+ */
+class ring_buffer
+{
+/* ===================================
+ * constructors:
+ * =================================== */
+public:
+    ring_buffer();
+    explicit ring_buffer(int size, bool is_mirrored = false);
+
+/* ===================================
+ * copy control:
+ * =================================== */
+private:
+    ring_buffer(const ring_buffer& src);
+    ring_buffer& operator=(const ring_buffer& src);
+
+/* ===================================
+ * destructor:
+ * =================================== */
+public:
+    ~ring_buffer();
+
+/* ===================================
+ * types:
+ * =================================== */
+public:
+    enum enum_bufsize
+    {
+        MIN_BUF_SIZE = 1024,
+        DEFAULT_BUF_SIZE = 1024 * 4,
+    };
+
+/* ===================================
+ * abilities:
+ * =================================== */
+public:
+    // Creates a buffer whose total size is @size or MIN_BUF_SIZE,
+    // mirrored or not according to @is_mirrored.
+    int create(int size, bool is_mirrored = false);
+
+    // Destroys the buffer, and create() afterwards is allowed.
+    void destroy(void);
+
+    /*
+     * Reads/Writes data from/into buffer, and read/write pointer also moves.
+     * Returns bytes read/written on success, or a negative number on failure.
+     */
+    int read(const int len, void *data);
+    int write(const int len, const void *data);
+
+    /*
+     * Gets/Moves read/write pointer, like those of sequential_buffer.
+     * The region starting from get_read_pointer() holds contiguous_data_size() bytes,
+     * and the one starting from get_write_pointer() holds contiguous_free_size() bytes.
+     * Returns nullptr if the buffer is not created, or how many bytes
+     * that the read/write pointer just actually moved.
+     */
+    void *get_read_pointer(void) const;
+    int move_read_pointer(const int offset);
+    void *get_write_pointer(void) const;
+    int move_write_pointer(const int offset);
+
+    /*
+     * Fills @iov with regions of data/free space, in their logical order.
+     * Returns count of regions filled, 0, 1 or 2.
+     */
+    int get_data_regions(struct iovec iov[2]) const;
+    int get_free_regions(struct iovec iov[2]) const;
+
+    // Resets read and write pointers, data is discarded.
+    void reset(void);
+
+/* ===================================
+ * attributes:
+ * =================================== */
+public:
+    inline const int data_size(void) const
+    {
+        return m_data_size;
+    }
+
+    inline const int total_size(void) const
+    {
+        return m_total_size;
+    }
+
+    inline const int free_size(void) const
+    {
+        return m_total_size - m_data_size;
+    }
+
+    inline const int contiguous_data_size(void) const
+    {
+        if (m_is_mirrored || m_read_pos + m_data_size <= m_total_size)
+            return m_data_size;
+
+        return m_total_size - m_read_pos;
+    }
+
+    inline const int contiguous_free_size(void) const
+    {
+        int write_pos = this->write_position();
+
+        if (m_is_mirrored || write_pos < m_read_pos || full())
+            return free_size();
+
+        return m_total_size - write_pos;
+    }
+
+    inline const bool is_mirrored(void) const
+    {
+        return m_is_mirrored;
+    }
+
+/* ===================================
+ * status:
+ * =================================== */
+public:
+    inline const bool empty(void) const
+    {
+        return m_data_size <= 0;
+    }
+
+    inline const bool full(void) const
+    {
+        return m_data_size >= m_total_size;
+    }
+
+/* ===================================
+ * private methods:
+ * =================================== */
+protected:
+    inline int write_position(void) const
+    {
+        int pos = m_read_pos + m_data_size;
+
+        return (pos < m_total_size) ? pos : (pos - m_total_size);
+    }
+    int create_mirrored(int size);
+
+/* ===================================
+ * data:
+ * =================================== */
+protected:
+    char *m_data;
+    int m_total_size;
+    int m_read_pos;
+    int m_data_size;
+    bool m_is_mirrored;
+};
+
+CA_LIB_NAMESPACE_END
+
+#endif // __CPP_ASSISTANT_RING_BUFFER_H__
@@ -74,6 +74,14 @@ public:
 
     virtual int close(bool release_buffer = true)/*  = 0 */;
 
+    /*
+     * Checks where stdout and stderr go, which is done by open() too, call it again after they're redirected,
+     * e.g., after daemon::daemonize(). Colors are used only if both of them are terminals,
+     * and the logger is muted if both of them are discarded (/dev/null or closed),
+     * so that lines are dropped before being formatted. It never unmutes the logger.
+     */
+    void refresh_output_status(void);
+
 /* ===================================
  * attributes:
  * =================================== */
@@ -119,6 +127,18 @@ public:
         return CA_RET_OK;
     }
 
+    // Whether stdout is a terminal, updated by refresh_output_status().
+    inline bool is_terminal(void) const
+    {
+        return m_is_terminal;
+    }
+
+    // Whether both stdout and stderr are discarded, updated by refresh_output_status().
+    inline bool output_is_discarded(void) const
+    {
+        return m_output_is_discarded;
+    }
+
 /* ===================================
  * status:
  * =================================== */
@@ -133,11 +153,14 @@ public:
  * private methods:
  * =================================== */
 protected:
+    static bool __is_discarded(int fd);
 
 /* ===================================
  * data:
  * =================================== */
 protected:
+    bool m_is_terminal;
+    bool m_output_is_discarded;
 };
 
 typedef screen_logger terminal_logger;
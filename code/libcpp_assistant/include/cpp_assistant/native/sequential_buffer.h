@@ -115,6 +115,11 @@ public:
     // Creates a buffer whose total size is @size or MIN_BUF_SIZE.
     int create(int size);
 
+    // Creates a growable buffer, which allocates @initial_size bytes at first (nothing if it's 0),
+    // and grows on demand until its total size reaches @max_size (or MIN_BUF_SIZE).
+    // Growth happens within write() and reserve().
+    int create_growable(int initial_size, int max_size);
+
     // Destroys the buffer, all resources and structures within it will be released,
     // and Create() afterwards is allowed.
     // If you just want to clear data and status values within buffer, use Reset().
@@ -149,6 +154,16 @@ public:
     // Returns bytes moved.
     int move_data_to_header(void);
 
+    // Makes sure there are at least @len bytes of continuous free space after the write pointer,
+    // by moving data to the header, or by growing the buffer if it's growable.
+    // Returns the size of continuous free space after that, which may be less than @len,
+    // or a negative number on failure.
+    int reserve(int len);
+
+    // Releases the memory of a growable buffer if it holds no data,
+    // and it will grow again on demand. Returns bytes released.
+    int release_memory(void);
+
     // Resets all status values(read pointer, write pointer, etc.),
     // and data will be set 0 if @zero_all_data is true.
     // If you want to release the buffer completely, use Destroy().
@@ -186,6 +201,12 @@ public:
         return (m_total_size >= 0) ? m_total_size : 0;
     }
 
+    // The size the buffer can grow to, the same as total_size() if it's not growable.
+    inline const int max_size(void) const
+    {
+        return m_max_size;
+    }
+
     inline const int free_size(void) const
     {
         int free_size = total_size() - data_size();
@@ -212,9 +233,15 @@ public:
         return data_size() <= 0;
     }
 
+    // A growable buffer is full only when it can not grow any more.
     inline const bool full(void) const
     {
-        return (data_size() >= total_size());
+        return (data_size() >= (m_is_growable ? m_max_size : total_size()));
+    }
+
+    inline const bool is_growable(void) const
+    {
+        return m_is_growable;
     }
 
     inline const bool has_overflown_pointer(void) const
@@ -247,6 +274,8 @@ protected:
     int m_total_size;
     int m_read_pos;
     int m_write_pos;
+    int m_max_size;
+    bool m_is_growable;
 
 public:
     static const void* OVERFLOW_PTR;
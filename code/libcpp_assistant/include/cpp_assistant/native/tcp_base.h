@@ -39,16 +39,23 @@
 
 #include <stdint.h>
 #include <string.h>
+#include <sys/uio.h>
 
 #include <map>
 #include <vector>
 #include <string>
 
+#include "base/ca_return_code.h"
 #include "net_common.h"
 #include "net_poller.h"
+#include "connection_table.h"
+#include "connection_pool.h"
+#include "logger.h"
 
 CA_LIB_NAMESPACE_BEGIN
 
+class ring_buffer;
+
 class tcp_base
 {
 /* ===================================
@@ -77,7 +84,7 @@ public:
  * types:
  * =================================== */
 public:
-    typedef std::map<int, net_conn*> connection_map;
+    typedef connection_table connection_map;
     typedef connection_map conn_map;
 
     typedef net_poller::conn_info_array conn_info_array;
@@ -93,6 +100,12 @@ protected:
         CHK_OP_ABNORMAL = 3
     };
 
+    enum
+    {
+        // Beyond it enqueue_to_connection() fails, so that a stuck peer can not eat up memory.
+        MAX_QUEUED_BYTES = 64 * 1024 * 1024
+    };
+
 /* ===================================
  * abilities:
  * =================================== */
@@ -107,21 +120,106 @@ public:
     static CA_REENTRANT int send_fragment(int fd, const void *buf, int len);
     static CA_REENTRANT int recv_fragment(int fd, void *buf, int len);
 
+    /*
+     * Like send_fragment() above, except that data is gathered from @iov_count segments
+     * described by @iov, such as a header and a body, or several small packets,
+     * and sent by as few sendmsg() calls as possible.
+     */
+    static CA_REENTRANT int send_fragments(int fd, const struct iovec *iov, int iov_count);
+
+    /*
+     * Sends data from/Receives data into @buf through connection @fd,
+     * covering both regions of a wrapped ring buffer in one syscall, read/write pointer also moves.
+     * Returns bytes sent/received on success, or a negative number on failure.
+     */
+    static CA_REENTRANT int send_from_ring_buffer(int fd, ring_buffer *buf);
+    static CA_REENTRANT int recv_to_ring_buffer(int fd, ring_buffer *buf);
+
     /*
      * Like xx_fragment() above, except that the target is the connection
-     * specified by @conn or @fd.
+     * specified by @conn or @fd. Data in the send buffer and the send queue is sent
+     * by one syscall, in the order it was written or queued, see enqueue_to_connection().
      */
     static CA_REENTRANT int send_from_connection(net_connection *conn);
     static CA_REENTRANT int recv_to_connection(net_connection *conn);
     int send_from_connection(int fd);
     int recv_to_connection(int fd);
 
+    /*
+     * Sends @len bytes of @data to @conn, following data pending in its send buffer:
+     * both of them are sent by one syscall, and what is left unsent is appended
+     * to the send buffer, which is flushed by send_from_connection() later.
+     * If @conn is corked, or its send queue is not empty, @data is just appended to the send buffer.
+     * Returns @len on success, which means all data was either sent or buffered,
+     * or a negative number on failure. If the unsent tail of @data can not be buffered
+     * after its head has been sent, @conn is marked broken since its stream is cut.
+     */
+    static CA_REENTRANT int send_to_connection(net_connection *conn, const void *data, int len);
+
+    /*
+     * Queues @packet to @conn after data pending in its send buffer and send queue,
+     * taking a reference to it instead of copying it, so that a packet sent to
+     * many connections is shared by all of them. Nothing is sent at once,
+     * and send_from_connection() sends it later, e.g., in the next round of the event loop.
+     * Data written into the send buffer afterwards, by send_to_connection() or directly
+     * through its write pointer, is sent after @packet.
+     * Returns the length of @packet on success, or a negative number on failure.
+     */
+    static CA_REENTRANT int enqueue_to_connection(net_connection *conn, shared_packet *packet);
+
+    // Whether @conn has data in its send buffer or send queue.
+    static CA_REENTRANT bool has_data_to_send(const net_connection *conn);
+
+    /*
+     * Corks @conn so that send_to_connection() holds data in the send buffer,
+     * then uncorks it to flush all data held by one syscall, which is useful
+     * for a batch of small packets, e.g., heart-beats or short replies.
+     * uncork_connection() returns what send_from_connection() returns.
+     */
+    static inline void cork_connection(net_connection *conn)
+    {
+        if (nullptr != conn)
+            conn->is_corked = true;
+    }
+    static CA_REENTRANT int uncork_connection(net_connection *conn);
+
+    /*
+     * Like recv_to_connection() above, except that it keeps receiving until
+     * the socket is drained(EAGAIN) or the receive buffer is full, moving unread data
+     * to the header of the buffer when necessary. This is what edge-triggered monitoring needs.
+     * conn->is_still_readable is set if the drain stops because of a full buffer,
+     * in which case the caller should consume some data and call it again,
+     * or call rearm_connection() to get notified in the next poll.
+     * Returns bytes received on success, or a negative number on failure.
+     */
+    static CA_REENTRANT int drain_to_connection(net_connection *conn);
+    int drain_to_connection(int fd);
+
+    // Receives data into @conn in the way specified by is_edge_triggered().
+    inline int receive(net_connection *conn)
+    {
+        return m_is_edge_triggered ? drain_to_connection(conn) : recv_to_connection(conn);
+    }
+
+    // Re-arms the monitored events of @conn so that the next poll reports it again
+    // if it's still readable, for edge-triggered mode only.
+    int rearm_connection(net_connection *conn);
+
+    // Releases memory of empty growable buffers of peers which have been idle
+    // for at least @idle_usec microseconds, see connection_pool::set_initial_buffer_size().
+    // Returns bytes released.
+    int release_idle_buffers(int64_t idle_usec);
+
     // Shows contents of a TCP instance, such as IP, port, its peers, etc.
     // By default, these contents will be copied into @result_holder if it's not null, otherwise,
     // they'll be printed or logged by logger or by system print function, depending on how
     // @logger is like.
     virtual void has_what(std::string *result_holder = nullptr, format_output_func logger = nullptr);
 
+    // Like has_what() above, except that each connection is logged by @target as a key-value line,
+    // see logger::kv().
+    void log_connections(logger &target, enum_log_level log_level = LOG_LEVEL_INFO);
+
     net_connection *find_peer(int fd);
 
     conn_info_array& get_active_peers(void) const;
@@ -160,11 +258,60 @@ public:
         return m_peers;
     }
 
+    // Returns the first of peers which have data left to send, whose pending_next leads to the others,
+    // so that flushing them costs nothing for idle peers. A peer joins the list when data is left
+    // by send_to_connection() or enqueue_to_connection(), or by mark_send_pending() after
+    // writing into its send buffer directly, and leaves it once send_from_connection() drains it.
+    inline net_connection *send_pending_head(void) const
+    {
+        return m_send_pending.head;
+    }
+
+    inline int send_pending_count(void) const
+    {
+        return m_send_pending.count;
+    }
+
+    // Returns the pool where connection nodes and buffers of peers come from and go back.
+    inline connection_pool *conn_pool(void) const
+    {
+        return m_conn_pool;
+    }
+
     inline int timeout(void) const
     {
         return m_timeout;
     }
 
+    // See net_poller::set_event_batch_size().
+    inline int set_event_batch_size(int size, int max_size = 0)
+    {
+        return (nullptr != m_poller) ? m_poller->set_event_batch_size(size, max_size) : CA_RET(RESOURCE_NOT_AVAILABLE);
+    }
+
+    inline int event_batch_size(void) const
+    {
+        return (nullptr != m_poller) ? m_poller->event_batch_size() : 0;
+    }
+
+    inline bool is_edge_triggered(void) const
+    {
+        return m_is_edge_triggered;
+    }
+
+    // Switches the monitoring mode of peer connections between level-triggered(by default)
+    // and edge-triggered. Existent peers are updated too. The listening connection of a server
+    // is always level-triggered.
+    int set_edge_triggered(bool enabled);
+
+    // Returns events for monitoring peer connections.
+    inline int monitored_events(void) const
+    {
+        return m_is_edge_triggered
+            ? (net_poller::EVENT_READ | net_poller::EVENT_EDGE_TRIGGERED)
+            : net_poller::EVENT_READ;
+    }
+
     inline void set_timeout(int timeout)
     {
         if (m_timeout < 0 && net_poller::INIFITE_POLL_TIMEOUT != m_timeout)
@@ -215,6 +362,24 @@ public:
         return is_ready(fd, CHK_OP_READABLE, timeout_usec);
     }
 
+    /*
+     * Batch forms of the two above: tests @fd_count file descriptors in @fds by one syscall,
+     * and sets @results[i] to true if fds[i] is writable/readable without any error.
+     * Returns the count of ready ones, or a negative number on failure.
+     */
+
+    static inline CA_REENTRANT int are_writable(const int *fds, int fd_count, bool *results,
+        int timeout_usec = net_poller::DEFAULT_POLL_TIMEOUT)
+    {
+        return are_ready(fds, fd_count, CHK_OP_WRITEABLE, results, timeout_usec);
+    }
+
+    static inline CA_REENTRANT int are_readable(const int *fds, int fd_count, bool *results,
+        int timeout_usec = net_poller::DEFAULT_POLL_TIMEOUT)
+    {
+        return are_ready(fds, fd_count, CHK_OP_READABLE, results, timeout_usec);
+    }
+
 /* ===================================
  * operators:
  * =================================== */
@@ -235,6 +400,8 @@ protected:
     int delete_connection(net_connection *conn, bool delete_peer_node_now = false);
 
     static CA_REENTRANT bool is_ready(int fd, enum_check_operation check_type, int timeout_usec);
+    static CA_REENTRANT int are_ready(const int *fds, int fd_count, enum_check_operation check_type,
+        bool *results, int timeout_usec);
 
 /* ===================================
  * data:
@@ -245,7 +412,10 @@ protected:
     connection_map *m_peers;
     int m_max_peer_count;
     net_poller *m_poller;
+    connection_pool *m_conn_pool;
     int m_timeout; // in milliseconds
+    bool m_is_edge_triggered;
+    send_pending_list m_send_pending;
 };
 
 CA_LIB_NAMESPACE_END
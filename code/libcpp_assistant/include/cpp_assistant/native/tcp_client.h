@@ -86,6 +86,28 @@ public:
         int recv_buf_size,
         bool is_nonblocking = true);
 
+    /*
+     * Starts connecting to a server without waiting: the connection is added to peers
+     * with status CONN_STATUS_CONNECTING and monitored for writability, and data sent
+     * to it by send_to_connection() is held in the send buffer in the meantime.
+     * When poll() reports it, call finish_connecting() to complete it.
+     * The status is CONN_STATUS_CONNECTED instead if connect() succeeds at once.
+     * Returns a file descriptor on success, or a negative number on failure.
+     */
+    int start_connecting(const char *ip,
+        uint16_t port,
+        int send_buf_size,
+        int recv_buf_size);
+
+    /*
+     * Checks the result of start_connecting() for @conn, and on success,
+     * turns its status into CONN_STATUS_CONNECTED, monitors it for reading
+     * and flushes the data held.
+     * Returns CA_RET_OK on success, or a negative number on failure, in which case
+     * its status becomes CONN_STATUS_BROKEN and it should be disconnected.
+     */
+    int finish_connecting(net_connection *conn);
+
     inline int disconnect_server(net_connection *conn)
     {
         return delete_connection(conn);
@@ -117,6 +139,15 @@ public:
  * private methods:
  * =================================== */
 protected:
+    int do_connect(const char *ip,
+        uint16_t port,
+        int send_buf_size,
+        int recv_buf_size,
+        bool is_nonblocking,
+        bool waits_for_completion);
+
+    // Gets the local address of @conn, and checks if it's a self-connection.
+    int fill_self_address(net_connection *conn);
 
 /* ===================================
  * data:
@@ -38,6 +38,9 @@
 #define __CPP_ASSISTANT_TCP_SERVER_H__
 
 #include <stdint.h>
+#include <sys/socket.h>
+
+#include <vector>
 
 #include "tcp_base.h"
 
@@ -65,14 +68,27 @@ private:
 public:
     ~tcp_server();
 
+/* ===================================
+ * types:
+ * =================================== */
+public:
+    enum enum_listen_backlog
+    {
+        DEFAULT_LISTEN_BACKLOG = SOMAXCONN, // the kernel truncates a larger one to net.core.somaxconn silently
+    };
+
 /* ===================================
  * abilities:
  * =================================== */
 public:
-    static CA_REENTRANT bool can_be_listened(const char *ip, const uint16_t port);
+    static CA_REENTRANT bool can_be_listened(const char *ip, const uint16_t port,
+        int backlog = DEFAULT_LISTEN_BACKLOG);
 
     // Starts listening on the address of @ip:@port.
     // Returns a socket fd for listening on success, or a negative number on failure.
+    // To run multiple reactors, each owning a server instance and a poller in its own thread
+    // or process, enable set_reuses_port() on all of them before starting,
+    // then the kernel distributes new connections among them.
     int start(const char *ip, uint16_t port);
 
     int end(void);
@@ -84,6 +100,21 @@ public:
     // or a negative number on failure.
     int accept_new_connection(int send_buf_size, int recv_buf_size, bool is_nonblocking = true);
 
+    // Accepts pending connections until none is left (EAGAIN), or until @max_count ones
+    // are accepted if @max_count is positive. New sockets are made non-blocking and close-on-exec
+    // by accept4() directly. File descriptors of new connections are appended to @new_fds if it's not null.
+    // Returns the count of new connections (0 if none is pending),
+    // or a negative number if it failed before any connection was accepted.
+    int accept_new_connections(int send_buf_size, int recv_buf_size,
+        std::vector<int> *new_fds = nullptr, int max_count = 0);
+
+    // Takes over a connection with file descriptor @fd which was accepted somewhere else,
+    // e.g., by an acceptor thread which hands off new connections to reactors round-robin.
+    // Other parameters and return value are the same as accept_new_connection().
+    // NOTE: It's not thread-safe, call it in the thread which polls this server,
+    //     and pass @fd to that thread by a queue or a pipe.
+    int adopt_connection(int fd, int send_buf_size, int recv_buf_size, bool is_nonblocking = true);
+
     inline int shutdown_client(net_connection *conn)
     {
         return delete_connection(conn);
@@ -123,6 +154,28 @@ public:
         return m_listening_conn->self_port;
     }
 
+    inline bool reuses_port(void) const
+    {
+        return m_reuses_port;
+    }
+
+    inline int listen_backlog(void) const
+    {
+        return m_listen_backlog;
+    }
+
+    // Sets the maximum length of the queue of pending connections, effective on the next start().
+    inline void set_listen_backlog(int backlog)
+    {
+        m_listen_backlog = (backlog > 0) ? backlog : DEFAULT_LISTEN_BACKLOG;
+    }
+
+    // Enables SO_REUSEPORT for the listening socket, effective on the next start().
+    inline void set_reuses_port(bool enabled)
+    {
+        m_reuses_port = enabled;
+    }
+
 /* ===================================
  * status:
  * =================================== */
@@ -138,12 +191,16 @@ public:
  * =================================== */
 protected:
     void destroy_listening_connection(void);
+    int do_adopt_connection(int fd, int send_buf_size, int recv_buf_size,
+        bool is_nonblocking, bool sets_nonblocking);
 
 /* ===================================
  * data:
  * =================================== */
 protected:
     net_connection *m_listening_conn;
+    bool m_reuses_port;
+    int m_listen_backlog;
 };
 
 CA_LIB_NAMESPACE_END
@@ -0,0 +1,411 @@
+/*
+ * Copyright (c) 2026, Wen Xiongchang <udc577 at 126 dot com>
+ * All rights reserved.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any
+ * damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any
+ * purpose, including commercial applications, and to alter it and
+ * redistribute it freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must
+ * not claim that you wrote the original software. If you use this
+ * software in a product, an acknowledgment in the product documentation
+ * would be appreciated but is not required.
+ *
+ * 2. Altered source versions must be plainly marked as such, and
+ * must not be misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source
+ * distribution.
+ */
+
+// NOTE: The original author also uses (short/code) names listed below,
+//       for convenience or for a certain purpose, at different places:
+//       wenxiongchang, wxc, Damon Wen, udc577
+
+#include "async_file_logger.h"
+
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <time.h>
+
+#include "private/debug.h"
+
+CA_LIB_NAMESPACE_BEGIN
+
+// Each log line is queued as a record: a header followed by the line, aligned to 8 bytes.
+struct queue_record_header
+{
+    int32_t len; // length of the line
+    int32_t flags;
+};
+
+enum enum_record_flag
+{
+    RECORD_IS_PADDING = 0x1, // the rest of the queue is skipped, and the next record starts from the beginning
+    RECORD_SWITCHES_FILE = 0x2 // the log file is switched before the line is written
+};
+
+static const int S_RECORD_ALIGNMENT = 8;
+static const int S_MAX_RECORD_SIZE = sizeof(struct queue_record_header) + async_file_logger::MAX_LINE_LEN;
+static const int S_FLUSHER_WAIT_MSEC = 50;
+
+static inline int64_t __aligned_record_size(int line_len)
+{
+    return (sizeof(struct queue_record_header) + line_len + S_RECORD_ALIGNMENT - 1) & ~(int64_t)(S_RECORD_ALIGNMENT - 1);
+}
+
+async_file_logger::async_file_logger()
+    : file_logger()
+    , m_overflow_policy(OVERFLOW_BLOCKS)
+    , m_queue_size(DEFAULT_QUEUE_SIZE)
+    , m_queue(nullptr)
+    , m_write_pos(0)
+    , m_read_pos(0)
+    , m_dropped_count(0)
+    , m_queued_lines(0)
+    , m_queued_bytes(0)
+    , m_queued_mday(0)
+    , m_flush_requested(false)
+    , m_stop_requested(false)
+    , m_flusher_running(false)
+{
+    pthread_condattr_t cond_attr;
+
+    pthread_mutex_init(&m_wakeup_mutex, nullptr);
+    pthread_condattr_init(&cond_attr);
+    pthread_condattr_setclock(&cond_attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&m_wakeup_cond, &cond_attr);
+    pthread_condattr_destroy(&cond_attr);
+}
+
+async_file_logger::~async_file_logger()
+{
+    close(); // must be done here, or ~file_logger() calls file_logger::close() with the flusher running
+
+    if (nullptr != m_queue)
+    {
+        free(m_queue);
+        m_queue = nullptr;
+    }
+
+    pthread_cond_destroy(&m_wakeup_cond);
+    pthread_mutex_destroy(&m_wakeup_mutex);
+}
+
+/*virtual */int async_file_logger::open(int cache_buf_size/* = DEFAULT_LOG_CACHE_SIZE*/)
+{
+    if (m_flusher_running)
+        return CA_RET_OK;
+
+    int ret = file_logger::open(cache_buf_size);
+
+    if (CA_RET_OK != ret)
+        return ret;
+
+    if (nullptr == m_queue && nullptr == (m_queue = (char *)malloc(m_queue_size)))
+    {
+        cerror("malloc() for log queue failed\n");
+        file_logger::close();
+        return CA_RET(MEMORY_ALLOC_FAILED);
+    }
+
+    m_write_pos = 0;
+    m_read_pos = 0;
+    m_queued_lines = 0;
+    m_queued_bytes = 0;
+    m_queued_mday = m_date.tm_mday;
+    m_flush_requested = false;
+    m_stop_requested = false;
+
+    if (0 != (ret = pthread_create(&m_flusher, nullptr, flusher_routine, this)))
+    {
+        cerror("pthread_create() for log flusher failed, ret = %d\n", ret);
+        file_logger::close();
+        return -ret;
+    }
+    m_flusher_running = true;
+
+    return CA_RET_OK;
+}
+
+/*virtual */int async_file_logger::close(bool release_buffer/* = true*/)
+{
+    if (m_flusher_running)
+    {
+        pthread_mutex_lock(&m_wakeup_mutex);
+        m_stop_requested = true;
+        pthread_cond_signal(&m_wakeup_cond);
+        pthread_mutex_unlock(&m_wakeup_mutex);
+
+        pthread_join(m_flusher, nullptr); // everything queued has been written then
+        m_flusher_running = false;
+    }
+
+    if (release_buffer && nullptr != m_queue)
+    {
+        free(m_queue);
+        m_queue = nullptr;
+    }
+
+    return file_logger::close(release_buffer);
+}
+
+/*virtual */void async_file_logger::flush(void)
+{
+    if (!m_flusher_running)
+    {
+        file_logger::flush();
+        return;
+    }
+
+    pthread_mutex_lock(&m_wakeup_mutex);
+    m_flush_requested = true;
+    pthread_cond_signal(&m_wakeup_cond);
+    pthread_mutex_unlock(&m_wakeup_mutex);
+}
+
+/*virtual */int async_file_logger::output(bool has_prefix,
+    enum_log_level log_level,
+    const char *fmt,
+    va_list args) /* CA_NOTNULL(4) */
+{
+    if (!m_flusher_running)
+        return CA_RET(FILE_OR_STREAM_NOT_OPEN);
+
+    if (log_level < m_log_level)
+        return 0;
+
+    if (!m_is_thread_safe)
+        return __queue_line(has_prefix, log_level, fmt, args);
+
+    // Producers take turns, and the flusher thread never waits for this lock.
+    lock_guard<mutex> lock(m_output_lock);
+
+    return __queue_line(has_prefix, log_level, fmt, args);
+}
+
+/*virtual */int async_file_logger::output_formatted(bool has_prefix,
+    enum_log_level log_level,
+    const char *line,
+    int len) /* CA_NOTNULL(4) */
+{
+    return output(has_prefix, log_level, "%.*s", len, line);
+}
+
+int async_file_logger::__queue_line(bool has_prefix,
+    enum_log_level log_level,
+    const char *fmt,
+    va_list args)
+{
+    /*
+     * Finds room for a line as long as MAX_LINE_LEN first, the actual length is unknown until it's formatted.
+     */
+
+    const int64_t kMask = m_queue_size - 1;
+    int64_t write_pos = m_write_pos;
+    int64_t tail_room = m_queue_size - (write_pos & kMask);
+    int64_t needed_size = S_MAX_RECORD_SIZE + ((tail_room < S_MAX_RECORD_SIZE) ? tail_room : 0);
+    int64_t used_size = write_pos - __atomic_load_n(&m_read_pos, __ATOMIC_ACQUIRE);
+
+    if (m_queue_size - used_size < needed_size)
+    {
+        wake_flusher();
+
+        if (OVERFLOW_DROPS == m_overflow_policy
+            || (OVERFLOW_DROPS_LOW_LEVELS == m_overflow_policy && log_level < LOG_LEVEL_WARNING))
+        {
+            __atomic_add_fetch(&m_dropped_count, 1, __ATOMIC_RELAXED);
+            return 0;
+        }
+
+        do
+        {
+            usleep(100);
+            used_size = write_pos - __atomic_load_n(&m_read_pos, __ATOMIC_ACQUIRE);
+        } while (m_queue_size - used_size < needed_size);
+    }
+
+    if (tail_room < S_MAX_RECORD_SIZE)
+    {
+        struct queue_record_header *padding = (struct queue_record_header *)(m_queue + (write_pos & kMask));
+
+        padding->len = tail_room - sizeof(struct queue_record_header);
+        padding->flags = RECORD_IS_PADDING;
+        write_pos += tail_room;
+    }
+
+    /*
+     * Then formats the line into the queue directly.
+     */
+
+    struct queue_record_header *header = (struct queue_record_header *)(m_queue + (write_pos & kMask));
+    char *line = (char *)(header + 1);
+    int line_len = 0;
+
+    __update_log_time();
+
+    header->flags = 0;
+    if (m_queued_lines >= log_line_limit()
+        || (m_size_limit > 0 && m_queued_bytes >= m_size_limit)
+        || m_now.tm_mday != m_queued_mday)
+    {
+        header->flags |= RECORD_SWITCHES_FILE;
+        m_queued_lines = 0;
+        m_queued_bytes = 0;
+        m_queued_mday = m_now.tm_mday;
+    }
+
+    if (has_prefix)
+    {
+        memcpy(line, __log_prefix(log_level), LOG_PREFIX_LEN);
+        line_len = LOG_PREFIX_LEN;
+    }
+
+    int body_len = vsnprintf(line + line_len, MAX_LINE_LEN - line_len, fmt, args);
+
+    if (body_len > 0)
+        line_len += body_len;
+    if (line_len >= MAX_LINE_LEN) // truncated
+    {
+        line_len = MAX_LINE_LEN - 1;
+        line[line_len - 1] = '\n';
+    }
+
+    header->len = line_len;
+    __atomic_store_n(&m_write_pos, write_pos + __aligned_record_size(line_len), __ATOMIC_RELEASE);
+    ++m_queued_lines;
+    m_queued_bytes += line_len;
+
+    // The flusher wakes up by itself periodically, only a queue filling up needs to wake it at once.
+    if (used_size + needed_size > m_queue_size / 4)
+        wake_flusher();
+
+    return line_len;
+}
+
+int async_file_logger::set_queue_size(int size)
+{
+    if (m_flusher_running)
+        return CA_RET(DEVICE_BUSY);
+
+    int actual_size = MIN_QUEUE_SIZE;
+
+    // a power of 2, so that positions are mapped into the queue by a mask
+    while (actual_size < size && actual_size < MAX_QUEUE_SIZE)
+        actual_size *= 2;
+
+    if (actual_size != m_queue_size && nullptr != m_queue)
+    {
+        free(m_queue);
+        m_queue = nullptr;
+    }
+    m_queue_size = actual_size;
+
+    return CA_RET_OK;
+}
+
+/*static */void *async_file_logger::flusher_routine(void *arg)
+{
+    async_file_logger *self = (async_file_logger *)arg;
+    int64_t reported_dropped_count = 0;
+
+    while (true)
+    {
+        bool stops = false;
+        bool flushes = false;
+
+        pthread_mutex_lock(&(self->m_wakeup_mutex));
+        if (!(self->m_stop_requested) && !(self->m_flush_requested)
+            && self->queued_size() <= self->m_queue_size / 4)
+        {
+            struct timespec deadline;
+
+            clock_gettime(CLOCK_MONOTONIC, &deadline);
+            deadline.tv_nsec += S_FLUSHER_WAIT_MSEC * 1000000L;
+            if (deadline.tv_nsec >= 1000000000L)
+            {
+                deadline.tv_sec += 1;
+                deadline.tv_nsec -= 1000000000L;
+            }
+            pthread_cond_timedwait(&(self->m_wakeup_cond), &(self->m_wakeup_mutex), &deadline);
+        }
+        stops = self->m_stop_requested;
+        flushes = self->m_flush_requested;
+        self->m_flush_requested = false;
+        pthread_mutex_unlock(&(self->m_wakeup_mutex));
+
+        // The logging thread has stopped producing when it requests stopping, so one more round finishes all.
+        self->write_queued_records();
+
+        int64_t dropped_count = self->dropped_count();
+
+        if (dropped_count != reported_dropped_count && nullptr != self->m_output_holder)
+        {
+            fprintf(self->m_output_holder, "%ld log lines dropped because of a full queue so far\n", dropped_count);
+            reported_dropped_count = dropped_count;
+        }
+
+        if ((flushes || stops) && nullptr != self->m_output_holder)
+            fflush(self->m_output_holder);
+
+        if (stops)
+            break;
+    }
+
+    return nullptr;
+}
+
+int64_t async_file_logger::write_queued_records(void)
+{
+    const int64_t kMask = m_queue_size - 1;
+    int64_t read_pos = m_read_pos;
+    int64_t write_pos = __atomic_load_n(&m_write_pos, __ATOMIC_ACQUIRE);
+    int64_t start_pos = read_pos;
+
+    while (read_pos < write_pos)
+    {
+        struct queue_record_header *header = (struct queue_record_header *)(m_queue + (read_pos & kMask));
+
+        if (0 != (RECORD_IS_PADDING & header->flags))
+        {
+            read_pos += sizeof(struct queue_record_header) + header->len;
+            continue;
+        }
+
+        if (0 != (RECORD_SWITCHES_FILE & header->flags))
+        {
+            int ret = __switch_logger_status();
+
+            if (CA_RET_OK != ret)
+                cerror("failed to switch log file, ret = %d\n", ret);
+        }
+
+        if (nullptr != m_output_holder)
+        {
+            fwrite(header + 1, 1, header->len, m_output_holder);
+            ++m_cur_line;
+            m_cur_size += header->len;
+        }
+
+        read_pos += __aligned_record_size(header->len);
+        __atomic_store_n(&m_read_pos, read_pos, __ATOMIC_RELEASE); // makes room as soon as possible
+    }
+
+    return read_pos - start_pos;
+}
+
+void async_file_logger::wake_flusher(void)
+{
+    pthread_mutex_lock(&m_wakeup_mutex);
+    pthread_cond_signal(&m_wakeup_cond);
+    pthread_mutex_unlock(&m_wakeup_mutex);
+}
+
+CA_LIB_NAMESPACE_END
@@ -0,0 +1,473 @@
+/*
+ * Copyright (c) 2026, Wen Xiongchang <udc577 at 126 dot com>
+ * All rights reserved.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any
+ * damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any
+ * purpose, including commercial applications, and to alter it and
+ * redistribute it freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must
+ * not claim that you wrote the original software. If you use this
+ * software in a product, an acknowledgment in the product documentation
+ * would be appreciated but is not required.
+ *
+ * 2. Altered source versions must be plainly marked as such, and
+ * must not be misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source
+ * distribution.
+ */
+
+// NOTE: The original author also uses (short/code) names listed below,
+//       for convenience or for a certain purpose, at different places:
+//       wenxiongchang, wxc, Damon Wen, udc577
+
+#include "binary_logger.h"
+
+#include <stdlib.h>
+#include <stdarg.h>
+#include <ctype.h>
+#include <time.h>
+
+#include <map>
+#include <vector>
+
+#include "private/debug.h"
+
+CA_LIB_NAMESPACE_BEGIN
+
+static const char S_FILE_MAGIC[8] = { 'C', 'A', 'B', 'L', 'O', 'G', '0', '1' };
+static const uint32_t S_NULL_STRING_LEN = 0xFFFFFFFF;
+
+// Shared by all instances, so that a site is defined again in the log file of another logger.
+static int32_t s_site_count = 0;
+static int32_t s_file_count = 0;
+
+binary_logger::binary_logger()
+    : file_logger()
+    , m_file_serial(0)
+{
+    ;
+}
+
+binary_logger::~binary_logger()
+{
+    ;
+}
+
+/*virtual */int binary_logger::__start_fragment(void)
+{
+    if (1 != fwrite(S_FILE_MAGIC, sizeof(S_FILE_MAGIC), 1, m_output_holder))
+    {
+        cerror("failed to write the file header\n");
+        return CA_RET(UNDERLYING_ERROR);
+    }
+    m_cur_size += sizeof(S_FILE_MAGIC);
+
+    // Sites are defined again in each new file, so that every file can be decoded by itself.
+    m_file_serial = __atomic_add_fetch(&s_file_count, 1, __ATOMIC_RELAXED);
+
+    return CA_RET_OK;
+}
+
+/*virtual */int binary_logger::output(bool has_prefix,
+    enum_log_level log_level,
+    const char *fmt,
+    va_list args) /* CA_NOTNULL(4) */
+{
+    return CA_RET(OPERATION_NOT_PERMITTED);
+}
+
+/*virtual */int binary_logger::output_formatted(bool has_prefix,
+    enum_log_level log_level,
+    const char *line,
+    int len) /* CA_NOTNULL(4) */
+{
+    return CA_RET(OPERATION_NOT_PERMITTED);
+}
+
+int binary_logger::__write_entry(site_t &site, char *record, int record_len)
+{
+    if (!m_is_thread_safe)
+        return __write_entry_unlocked(site, record, record_len);
+
+    // The arguments are encoded in the stack of each thread already, only writing is done in the lock.
+    lock_guard<mutex> lock(m_output_lock);
+
+    if (!is_open())
+        return CA_RET(FILE_OR_STREAM_NOT_OPEN);
+
+    return __write_entry_unlocked(site, record, record_len);
+}
+
+int binary_logger::__write_entry_unlocked(site_t &site, char *record, int record_len)
+{
+    __update_log_time();
+
+    if (__needs_switching())
+    {
+        int switch_ret = __switch_logger_status();
+
+        if (CA_RET_OK != switch_ret)
+            return switch_ret;
+    }
+
+    if (0 == site.id)
+        site.id = __atomic_add_fetch(&s_site_count, 1, __ATOMIC_RELAXED);
+
+    if (site.file_serial != m_file_serial)
+    {
+        int def_ret = __write_site_definition(site);
+
+        if (CA_RET_OK != def_ret)
+            return def_ret;
+        site.file_serial = m_file_serial;
+    }
+
+    record_header_t header;
+
+    header.type = RECORD_LOG_ENTRY;
+    header.level = site.level;
+    header.site_id = site.id;
+    header.len = record_len;
+    header.reserved = 0;
+    header.time_usec = (int64_t)m_now_sec * 1000000 + m_now_usec;
+    memcpy(record, &header, sizeof(header)); // the record may be not aligned
+
+    if (1 != fwrite(record, record_len, 1, m_output_holder))
+        return CA_RET(UNDERLYING_ERROR);
+    ++m_cur_line;
+    m_cur_size += record_len;
+
+    return record_len;
+}
+
+int binary_logger::__write_site_definition(const site_t &site)
+{
+    record_header_t header;
+    int fmt_len = strlen(site.fmt);
+
+    header.type = RECORD_SITE_DEFINITION;
+    header.level = site.level;
+    header.site_id = site.id;
+    header.len = sizeof(header) + fmt_len;
+    header.reserved = 0;
+    header.time_usec = 0;
+
+    if (1 != fwrite(&header, sizeof(header), 1, m_output_holder)
+        || (fmt_len > 0 && 1 != fwrite(site.fmt, fmt_len, 1, m_output_holder)))
+        return CA_RET(UNDERLYING_ERROR);
+    m_cur_size += header.len;
+
+    return CA_RET_OK;
+}
+
+/*static */void binary_logger::encode_arg(char *&pos, const char *end, const char *value)
+{
+    uint32_t len = S_NULL_STRING_LEN;
+
+    if (nullptr == value)
+    {
+        encode_raw(pos, end, &len, sizeof(len));
+        return;
+    }
+
+    if (end - pos < (int)sizeof(len))
+        return;
+
+    len = strnlen(value, end - pos - sizeof(len));
+    memcpy(pos, &len, sizeof(len));
+    memcpy(pos + sizeof(len), value, len);
+    pos += sizeof(len) + len;
+}
+
+/*
+ * Decoding functions below.
+ */
+
+static inline bool __read_raw(const char *&pos, const char *end, void *value, int len)
+{
+    if (end - pos < len)
+        return false;
+
+    memcpy(value, pos, len);
+    pos += len;
+
+    return true;
+}
+
+static bool __read_string(const char *&pos, const char *end, std::string &value, bool &is_null)
+{
+    uint32_t len = 0;
+
+    if (!__read_raw(pos, end, &len, sizeof(len)))
+        return false;
+
+    is_null = (S_NULL_STRING_LEN == len);
+    if (is_null)
+        return true;
+
+    if ((uint32_t)(end - pos) < len)
+        return false;
+
+    value.assign(pos, len);
+    pos += len;
+
+    return true;
+}
+
+template<typename T>
+static void __append_formatted(std::string &text, const std::string &spec, T value)
+{
+    char buf[256];
+    int len = snprintf(buf, sizeof(buf), spec.c_str(), value);
+
+    if (len < 0)
+        return;
+
+    if (len < (int)sizeof(buf))
+    {
+        text.append(buf, len);
+        return;
+    }
+
+    std::vector<char> long_buf(len + 1);
+
+    snprintf(&long_buf[0], long_buf.size(), spec.c_str(), value);
+    text.append(&long_buf[0], len);
+}
+
+/*static */int binary_logger::format_args(const char *fmt, const char *args, int args_len, std::string &text)
+{
+    const char *pos = args;
+    const char *end = args + args_len;
+    const char *cur = fmt;
+    const char *MISSING_ARG = "<?>";
+
+    while ('\0' != *cur)
+    {
+        if ('%' != *cur)
+        {
+            const char *next = strchr(cur, '%');
+            size_t len = (nullptr == next) ? strlen(cur) : (size_t)(next - cur);
+
+            text.append(cur, len);
+            cur += len;
+            continue;
+        }
+
+        if ('%' == cur[1])
+        {
+            text += '%';
+            cur += 2;
+            continue;
+        }
+
+        /*
+         * A conversion specification: %[flags][width][.precision][length]conversion,
+         * length modifiers are replaced according to how arguments are stored.
+         */
+
+        std::string spec("%");
+        const char *spec_end = cur + 1;
+        int64_t int_value = 0;
+        char num_buf[32];
+
+        while ('\0' != *spec_end && nullptr != strchr("-+ #0'", *spec_end))
+            spec += *spec_end++;
+
+        for (int i = 0; i < 2; ++i) // width, then precision
+        {
+            if (1 == i)
+            {
+                if ('.' != *spec_end)
+                    break;
+                spec += *spec_end++;
+            }
+
+            if ('*' == *spec_end)
+            {
+                if (!__read_raw(pos, end, &int_value, sizeof(int_value)))
+                    int_value = 0;
+                snprintf(num_buf, sizeof(num_buf), "%d", (int)int_value);
+                spec += num_buf;
+                ++spec_end;
+            }
+            while (isdigit(*spec_end))
+                spec += *spec_end++;
+        }
+
+        const char *length_start = spec_end;
+
+        while ('\0' != *spec_end && nullptr != strchr("hlLqjzt", *spec_end))
+            ++spec_end;
+
+        std::string length(length_start, spec_end);
+        char conversion = *spec_end;
+
+        if ('\0' == conversion)
+        {
+            text.append(cur);
+            break;
+        }
+        ++spec_end;
+
+        switch (conversion)
+        {
+        case 'd':
+        case 'i':
+            if (!__read_raw(pos, end, &int_value, sizeof(int_value)))
+            {
+                text += MISSING_ARG;
+                break;
+            }
+            if ("hh" == length)
+                int_value = (signed char)int_value;
+            else if ("h" == length)
+                int_value = (short)int_value;
+            else if (length.empty())
+                int_value = (int)int_value;
+            __append_formatted(text, spec + "lld", (long long)int_value);
+            break;
+        case 'u':
+        case 'x':
+        case 'X':
+        case 'o':
+            if (!__read_raw(pos, end, &int_value, sizeof(int_value)))
+            {
+                text += MISSING_ARG;
+                break;
+            }
+            if ("hh" == length)
+                int_value = (unsigned char)int_value;
+            else if ("h" == length)
+                int_value = (unsigned short)int_value;
+            else if (length.empty())
+                int_value = (unsigned int)int_value;
+            __append_formatted(text, spec + "ll" + conversion, (unsigned long long)int_value);
+            break;
+        case 'c':
+            if (!__read_raw(pos, end, &int_value, sizeof(int_value)))
+            {
+                text += MISSING_ARG;
+                break;
+            }
+            __append_formatted(text, spec + conversion, (int)int_value);
+            break;
+        case 'p':
+            if (!__read_raw(pos, end, &int_value, sizeof(int_value)))
+            {
+                text += MISSING_ARG;
+                break;
+            }
+            __append_formatted(text, spec + conversion, (void *)(intptr_t)int_value);
+            break;
+        case 'f':
+        case 'F':
+        case 'e':
+        case 'E':
+        case 'g':
+        case 'G':
+        case 'a':
+        case 'A':
+            {
+                double double_value = 0;
+
+                if (!__read_raw(pos, end, &double_value, sizeof(double_value)))
+                {
+                    text += MISSING_ARG;
+                    break;
+                }
+                __append_formatted(text, spec + conversion, double_value);
+            }
+            break;
+        case 's':
+            {
+                std::string str_value;
+                bool is_null = false;
+
+                if (!__read_string(pos, end, str_value, is_null))
+                {
+                    text += MISSING_ARG;
+                    break;
+                }
+                __append_formatted(text, spec + conversion, is_null ? "(null)" : str_value.c_str());
+            }
+            break;
+        default: // unsupported, such as %n, kept as it is
+            text.append(cur, spec_end - cur);
+            break;
+        }
+
+        cur = spec_end;
+    }
+
+    return CA_RET_OK;
+}
+
+/*static */int binary_logger::decode(FILE *input, FILE *output)
+{
+    char magic[sizeof(S_FILE_MAGIC)] = {0};
+
+    if (1 != fread(magic, sizeof(magic), 1, input) || 0 != memcmp(magic, S_FILE_MAGIC, sizeof(magic)))
+        return CA_RET(OBJECT_MISMATCHED);
+
+    std::map<uint32_t, std::string> formats;
+    std::vector<char> payload;
+    std::string text;
+    record_header_t header;
+    int line_count = 0;
+
+    while (1 == fread(&header, sizeof(header), 1, input))
+    {
+        if (header.len < sizeof(header))
+            return CA_RET(INNER_DATA_STRUCT_ERROR);
+
+        payload.resize(header.len - sizeof(header) + 1); // one more for the null terminator
+        if (header.len > sizeof(header) && 1 != fread(&payload[0], header.len - sizeof(header), 1, input))
+            break; // truncated, e.g. the process crashed while writing
+
+        int payload_len = header.len - sizeof(header);
+
+        if (RECORD_SITE_DEFINITION == header.type)
+        {
+            formats[header.site_id].assign(&payload[0], payload_len);
+            continue;
+        }
+
+        if (RECORD_LOG_ENTRY != header.type)
+            continue; // skipped for compatibility
+
+        time_t sec = header.time_usec / 1000000;
+        struct tm date;
+
+        localtime_r(&sec, &date);
+        fprintf(output, "%s%02d%02d %02d:%02d:%02d.%06ld ",
+            G_LOG_LEVEL_STRINGS[header.level % LOG_LEVEL_COUNT], date.tm_mon + 1, date.tm_mday,
+            date.tm_hour, date.tm_min, date.tm_sec, (long)(header.time_usec % 1000000));
+
+        std::map<uint32_t, std::string>::iterator it = formats.find(header.site_id);
+
+        text.clear();
+        if (formats.end() == it)
+        {
+            char undefined[64];
+
+            snprintf(undefined, sizeof(undefined), "<undefined log site %u>\n", header.site_id);
+            text = undefined;
+        }
+        else
+            format_args(it->second.c_str(), &payload[0], payload_len, text);
+
+        fwrite(text.data(), 1, text.length(), output);
+        ++line_count;
+    }
+
+    return line_count;
+}
+
+CA_LIB_NAMESPACE_END
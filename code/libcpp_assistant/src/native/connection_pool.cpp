@@ -0,0 +1,244 @@
+/*
+ * Copyright (c) 2026, Wen Xiongchang <udc577 at 126 dot com>
+ * All rights reserved.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any
+ * damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any
+ * purpose, including commercial applications, and to alter it and
+ * redistribute it freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must
+ * not claim that you wrote the original software. If you use this
+ * software in a product, an acknowledgment in the product documentation
+ * would be appreciated but is not required.
+ *
+ * 2. Altered source versions must be plainly marked as such, and
+ * must not be misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source
+ * distribution.
+ */
+
+// NOTE: The original author also uses (short/code) names listed below,
+//       for convenience or for a certain purpose, at different places:
+//       wenxiongchang, wxc, Damon Wen, udc577
+
+#include "connection_pool.h"
+
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <new>
+
+#include "base/ca_return_code.h"
+#include "private/debug.h"
+#include "sequential_buffer.h"
+
+CA_LIB_NAMESPACE_BEGIN
+
+connection_pool::connection_pool(int max_idle_count/* = DEFAULT_MAX_IDLE_COUNT*/)
+    : m_max_idle_count((max_idle_count >= 0) ? max_idle_count : DEFAULT_MAX_IDLE_COUNT),
+      m_initial_buf_size(-1)
+{
+    ;
+}
+
+connection_pool::~connection_pool()
+{
+    shrink();
+    m_idle_nodes.clear();
+    for (size_t i = 0; i < m_slabs.size(); ++i)
+    {
+        free(m_slabs[i].first);
+    }
+    m_slabs.clear();
+}
+
+net_connection *connection_pool::acquire(int send_buf_size, int recv_buf_size)
+{
+    if (m_idle_nodes.empty() && grow_slabs() < 0)
+        return nullptr;
+
+    net_connection *conn = m_idle_nodes.back();
+
+    init_net_connection(*conn);
+
+    if ((send_buf_size > 0 && nullptr == (conn->send_buf = acquire_buffer(send_buf_size)))
+        || (recv_buf_size > 0 && nullptr == (conn->recv_buf = acquire_buffer(recv_buf_size))))
+    {
+        cerror("failed to acquire connection buffer\n");
+        release_buffer(conn->send_buf);
+        conn->send_buf = nullptr;
+
+        return nullptr; // the node stays idle
+    }
+
+    m_idle_nodes.pop_back();
+
+    return conn;
+}
+
+void connection_pool::release(net_connection *conn)
+{
+    if (nullptr == conn)
+        return;
+
+    if (!owns(conn))
+    {
+        destroy_net_connection(&conn);
+        return;
+    }
+
+    if (conn->fd >= 0)
+        close(conn->fd);
+    conn->fd = INVALID_SOCK_FD;
+
+    unmark_send_pending(*conn);
+    clear_send_queue(*conn);
+    release_buffer(conn->send_buf);
+    conn->send_buf = nullptr;
+    release_buffer(conn->recv_buf);
+    conn->recv_buf = nullptr;
+
+    m_idle_nodes.push_back(conn);
+}
+
+buffer *connection_pool::acquire_buffer(int size)
+{
+    if (size <= 0)
+        return nullptr;
+
+    if (size < buffer::MIN_BUF_SIZE)
+        size = buffer::MIN_BUF_SIZE;
+
+    bool is_growable = (m_initial_buf_size >= 0 && m_initial_buf_size < size);
+    std::map<int, std::vector<buffer*> > &idle_buffers = is_growable ? m_idle_growable_buffers : m_idle_buffers;
+    std::map<int, std::vector<buffer*> >::iterator it = idle_buffers.find(size);
+
+    if (idle_buffers.end() != it && !(it->second.empty()))
+    {
+        buffer *buf = it->second.back();
+
+        it->second.pop_back();
+        buf->reset();
+
+        return buf;
+    }
+
+    buffer *buf = new (std::nothrow) buffer;
+
+    if (nullptr == buf)
+        return nullptr;
+
+    int ret = is_growable ? buf->create_growable(m_initial_buf_size, size) : buf->create(size);
+
+    if (ret < 0)
+    {
+        delete buf;
+        buf = nullptr;
+    }
+
+    return buf;
+}
+
+void connection_pool::release_buffer(buffer *buf)
+{
+    if (nullptr == buf)
+        return;
+
+    if (buf->is_growable())
+        buf->reset();
+    buf->release_memory(); // only for a growable one
+
+    std::vector<buffer*> &idle_list = buf->is_growable()
+        ? m_idle_growable_buffers[buf->max_size()] : m_idle_buffers[buf->total_size()];
+
+    if ((int)idle_list.size() < m_max_idle_count)
+        idle_list.push_back(buf);
+    else
+        delete buf;
+}
+
+void connection_pool::shrink(void)
+{
+    std::map<int, std::vector<buffer*> > *buffer_maps[] = {
+        &m_idle_buffers,
+        &m_idle_growable_buffers
+    };
+
+    for (size_t i = 0; i < sizeof(buffer_maps) / sizeof(buffer_maps[0]); ++i)
+    {
+        std::map<int, std::vector<buffer*> >::iterator it = buffer_maps[i]->begin();
+
+        for (; it != buffer_maps[i]->end(); ++it)
+        {
+            for (size_t j = 0; j < it->second.size(); ++j)
+            {
+                delete it->second[j];
+            }
+        }
+        buffer_maps[i]->clear();
+    }
+}
+
+int connection_pool::idle_buffer_count(void) const
+{
+    int count = 0;
+    std::map<int, std::vector<buffer*> >::const_iterator it = m_idle_buffers.begin();
+
+    for (; it != m_idle_buffers.end(); ++it)
+    {
+        count += (int)it->second.size();
+    }
+    for (it = m_idle_growable_buffers.begin(); it != m_idle_growable_buffers.end(); ++it)
+    {
+        count += (int)it->second.size();
+    }
+
+    return count;
+}
+
+int connection_pool::grow_slabs(void)
+{
+    int node_count = m_slabs.empty() ? MIN_SLAB_NODE_COUNT : (m_slabs.back().second * 2);
+
+    if (node_count > MAX_SLAB_NODE_COUNT)
+        node_count = MAX_SLAB_NODE_COUNT;
+
+    net_connection *nodes = (net_connection *)malloc(sizeof(net_connection) * node_count);
+
+    if (nullptr == nodes)
+    {
+        cerror("malloc() for %d connection nodes failed\n", node_count);
+        return CA_RET(MEMORY_ALLOC_FAILED);
+    }
+
+    m_slabs.push_back(slab_t(nodes, node_count));
+    m_idle_nodes.reserve(m_idle_nodes.size() + node_count);
+    // In reverse order, so that nodes are handed out by their addresses.
+    for (int i = node_count - 1; i >= 0; --i)
+    {
+        m_idle_nodes.push_back(nodes + i);
+    }
+
+    return node_count;
+}
+
+bool connection_pool::owns(const net_connection *conn) const
+{
+    // Slabs grow geometrically, so there are not many of them.
+    for (size_t i = 0; i < m_slabs.size(); ++i)
+    {
+        const net_connection *nodes = m_slabs[i].first;
+
+        if (conn >= nodes && conn < nodes + m_slabs[i].second)
+            return true;
+    }
+
+    return false;
+}
+
+CA_LIB_NAMESPACE_END
@@ -0,0 +1,121 @@
+/*
+ * Copyright (c) 2026, Wen Xiongchang <udc577 at 126 dot com>
+ * All rights reserved.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any
+ * damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any
+ * purpose, including commercial applications, and to alter it and
+ * redistribute it freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must
+ * not claim that you wrote the original software. If you use this
+ * software in a product, an acknowledgment in the product documentation
+ * would be appreciated but is not required.
+ *
+ * 2. Altered source versions must be plainly marked as such, and
+ * must not be misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source
+ * distribution.
+ */
+
+// NOTE: The original author also uses (short/code) names listed below,
+//       for convenience or for a certain purpose, at different places:
+//       wenxiongchang, wxc, Damon Wen, udc577
+
+#include "connection_table.h"
+
+CA_LIB_NAMESPACE_BEGIN
+
+connection_table::connection_table()
+{
+    ;
+}
+
+connection_table::~connection_table()
+{
+    clear();
+}
+
+connection_table::iterator connection_table::find(int fd)
+{
+    int pos = position_of(fd);
+
+    return (INVALID_POSITION == pos) ? m_elements.end() : (m_elements.begin() + pos);
+}
+
+connection_table::const_iterator connection_table::find(int fd) const
+{
+    int pos = position_of(fd);
+
+    return (INVALID_POSITION == pos) ? m_elements.end() : (m_elements.begin() + pos);
+}
+
+std::pair<connection_table::iterator, bool> connection_table::insert(int fd, net_connection *conn)
+{
+    if (fd < 0)
+        return std::make_pair(m_elements.end(), false);
+
+    int pos = position_of(fd);
+
+    if (INVALID_POSITION != pos)
+        return std::make_pair(m_elements.begin() + pos, false);
+
+    if (fd >= (int)m_positions.size())
+    {
+        size_t new_size = (m_positions.size() > 0) ? m_positions.size() : 64;
+
+        while ((int)new_size <= fd)
+            new_size *= 2;
+        m_positions.resize(new_size, INVALID_POSITION);
+    }
+
+    m_positions[fd] = m_elements.size();
+    m_elements.push_back(std::make_pair(fd, conn));
+
+    return std::make_pair(m_elements.end() - 1, true);
+}
+
+size_t connection_table::erase(int fd)
+{
+    int pos = position_of(fd);
+
+    if (INVALID_POSITION == pos)
+        return 0;
+
+    int last_pos = m_elements.size() - 1;
+
+    if (pos != last_pos)
+    {
+        m_elements[pos] = m_elements[last_pos];
+        m_positions[m_elements[pos].first] = pos;
+    }
+    m_elements.pop_back();
+    m_positions[fd] = INVALID_POSITION;
+
+    return 1;
+}
+
+void connection_table::clear(void)
+{
+    m_elements.clear();
+    m_positions.clear();
+}
+
+void connection_table::reserve(int count)
+{
+    if (count <= 0)
+        return;
+
+    m_elements.reserve(count);
+}
+
+net_connection*& connection_table::operator[](int fd)
+{
+    return insert(fd, nullptr).first->second;
+}
+
+CA_LIB_NAMESPACE_END
@@ -32,14 +32,21 @@
 #include <stdarg.h>
 #include <string.h>
 #include <errno.h>
+#include <dirent.h>
+#include <spawn.h>
 #include <sys/time.h>
 #include <sys/stat.h>
+#include <sys/wait.h>
 
 #include <typeinfo>
+#include <vector>
+#include <algorithm>
 
 #include "private/debug.h"
 #include "base/platforms/os_specific.h"
 
+extern char **environ;
+
 CA_LIB_NAMESPACE_BEGIN
 
 static const int S_INITIAL_FILE_LOG_NUM = 0;
@@ -51,14 +58,28 @@ file_logger::file_logger()
     , m_log_name(nullptr)
     , m_log_directory(nullptr)
     , m_buffer(nullptr)
+    , m_cache_buf_size(DEFAULT_LOG_CACHE_SIZE)
+    , m_size_limit(0)
+    , m_rotates_in_background(false)
+    , m_max_fragments(0)
+    , m_housekeeper_running(false)
+    , m_stop_requested(false)
+    , m_next_holder(nullptr)
+    , m_next_buffer(nullptr)
+    , m_preopen_error(0)
+    , m_rotation_error(0)
     //, m_to_screen(false) // error??
 {
     m_to_screen = false;
+    pthread_mutex_init(&m_housekeeping_mutex, nullptr);
+    pthread_cond_init(&m_housekeeping_cond, nullptr);
 }
 
 file_logger::~file_logger()
 {
     close();
+    pthread_cond_destroy(&m_housekeeping_cond);
+    pthread_mutex_destroy(&m_housekeeping_mutex);
 
     if (nullptr != m_log_name)
     {
@@ -87,13 +108,61 @@ file_logger::~file_logger()
     if ('\0' == m_log_name[0] || '\0' == m_log_directory[0])
         return CA_RET(INVALID_PATH);
 
+    int ret = __open_fragment(cache_buf_size);
+
+    if (CA_RET_OK != ret)
+        return ret;
+
+    if (CA_RET_OK != (ret = __start_fragment()))
+    {
+        __close_fragment(true);
+        return ret;
+    }
+
+    if (__needs_housekeeper() && CA_RET_OK != (ret = __start_housekeeper()))
+    {
+        cerror("failed to start the housekeeping thread, ret = %d\n", ret);
+        __close_fragment(true);
+        return ret;
+    }
+
+    return CA_RET_OK;
+}
+
+/*virtual */int file_logger::close(bool release_buffer/* = true*/)/*  = 0 */
+{
+    if (!is_open())
+        return CA_RET(OK);
+
+    bool had_housekeeper = m_housekeeper_running;
+
+    __stop_housekeeper();
+
+    std::string final_path = __fragment_path("");
+    int ret = __close_fragment(release_buffer);
+
+    // The last fragment is finished here, for there is no housekeeping thread any more.
+    if (CA_RET_OK == ret && had_housekeeper)
+    {
+        if (!m_compression_command.empty())
+            __compress_fragment(final_path);
+
+        if (m_max_fragments > 0)
+            __remove_old_fragments();
+    }
+
+    return ret;
+}
+
+int file_logger::__open_fragment(int cache_buf_size)
+{
     int err = 0;
     int path_len = directory_length_limit() + name_length_limit() + 1;
     char *file = (char *)calloc(path_len, sizeof(char));
 
     snprintf(file, path_len, "%s%c%s.tmp", m_log_directory, get_directory_delimiter(), m_log_name);
     cdebug("opening %s ...\n", file);
-    m_output_holder = fopen(file, "w");
+    m_output_holder = fopen(file, "w+"); // readable as well, for a shared memory mapping of it
     free(file);
     file = nullptr;
     if (nullptr == m_output_holder)
@@ -137,15 +206,15 @@ file_logger::~file_logger()
 
     m_is_open = true;
     m_cur_line = 0;
+    m_cur_size = 0;
+    m_cache_buf_size = cache_buf_size;
 
     return CA_RET_OK;
 }
 
-/*virtual */int file_logger::close(bool release_buffer/* = true*/)/*  = 0 */
+int file_logger::__close_fragment(bool release_buffer)
 {
-    if (!is_open())
-        return CA_RET(OK);
-
+    __end_fragment();
     fflush(m_output_holder);
     fclose(m_output_holder);
     m_output_holder = nullptr;
@@ -300,16 +369,65 @@ file_logger::~file_logger()
     return CA_RET_OK;
 }
 
+int file_logger::set_log_size_limit(int64_t limit)
+{
+    if (is_open())
+        return CA_RET(DEVICE_BUSY);
+
+    if (limit < 0)
+        return CA_RET(INVALID_PARAM_VALUE);
+
+    m_size_limit = (limit > 0 && limit < LOG_SIZE_LIMIT_MIN) ? LOG_SIZE_LIMIT_MIN : limit;
+
+    return CA_RET_OK;
+}
+
+int file_logger::set_rotates_in_background(bool enabled)
+{
+    if (is_open())
+        return CA_RET(DEVICE_BUSY);
+
+    m_rotates_in_background = enabled;
+
+    return CA_RET_OK;
+}
+
+int file_logger::set_compression_command(const char *command) /* CA_NOTNULL(2) */
+{
+    if (is_open())
+        return CA_RET(DEVICE_BUSY);
+
+    m_compression_command = command;
+
+    return CA_RET_OK;
+}
+
+int file_logger::set_max_fragments(int count)
+{
+    if (is_open())
+        return CA_RET(DEVICE_BUSY);
+
+    if (count < 0)
+        return CA_RET(INVALID_PARAM_VALUE);
+
+    m_max_fragments = count;
+
+    return CA_RET_OK;
+}
+
 /*virtual */int file_logger::__switch_logger_status(void)
 {
+    if (m_housekeeper_running)
+        return __swap_in_next_fragment();
+
     int ret = CA_RET_OK;
     bool is_used_by_inner_debug = (m_output_holder == __get_debug_output_holder());
     bool is_used_by_inner_error = (m_output_holder == __get_error_output_holder());
 
-    if (CA_RET_OK != (ret = close(NOT_RELEASE_LOG_BUF_ON_CLOSE))) // Closes it first.
+    if (CA_RET_OK != (ret = __close_fragment(NOT_RELEASE_LOG_BUF_ON_CLOSE))) // Closes it first.
         return ret;
 
-    if (CA_RET_OK != (ret = open())) // Re-opens the logger to start a new log file.
+    if (CA_RET_OK != (ret = __open_fragment(m_cache_buf_size))) // Re-opens the logger to start a new log file.
         return ret;
 
     if (is_used_by_inner_debug)
@@ -318,30 +436,376 @@ file_logger::~file_logger()
     if (is_used_by_inner_error)
         __set_error_output(m_output_holder); // Recovers inner error report.
 
-    m_cur_line = 0;
+    return __start_fragment();
+}
 
-    return ret;
+int file_logger::__swap_in_next_fragment(void)
+{
+    int ret = CA_RET_OK;
+    bool is_used_by_inner_debug = (m_output_holder == __get_debug_output_holder());
+    bool is_used_by_inner_error = (m_output_holder == __get_error_output_holder());
+    finished_fragment_t fragment;
+
+    pthread_mutex_lock(&m_housekeeping_mutex);
+
+    // Waits only if fragments are switched faster than they are finished.
+    while (nullptr == m_next_holder && 0 == m_preopen_error)
+        pthread_cond_wait(&m_housekeeping_cond, &m_housekeeping_mutex);
+
+    if (nullptr == m_next_holder)
+    {
+        // The housekeeping thread is idle when pre-opening fails, so it's safe to switch synchronously,
+        // and the finished fragment is still handed over for compression and so on.
+        // NOTE: m_preopen_error is kept until the next pre-opening is requested, or switching would wait forever.
+        cerror("failed to pre-open the next log fragment, ret = %d, switch synchronously\n", m_preopen_error);
+        pthread_mutex_unlock(&m_housekeeping_mutex);
+
+        fragment.holder = nullptr;
+        fragment.buffer = nullptr;
+        fragment.final_path = __fragment_path("");
+        if (CA_RET_OK != (ret = __close_fragment(NOT_RELEASE_LOG_BUF_ON_CLOSE)))
+            return ret;
+        if (CA_RET_OK != (ret = __open_fragment(m_cache_buf_size)))
+            return ret;
+        fragment.next_path = __fragment_path(".next");
+
+        pthread_mutex_lock(&m_housekeeping_mutex);
+        m_preopen_error = 0;
+    }
+    else
+    {
+        __end_fragment();
+        fragment.holder = m_output_holder;
+        fragment.buffer = m_buffer;
+        fragment.tmp_path = __fragment_path(".tmp");
+        fragment.final_path = __fragment_path("");
+        fragment.current_src_path = m_next_path;
+
+        __update_log_num();
+        fragment.current_dst_path = __fragment_path(".tmp");
+        fragment.next_path = __fragment_path(".next");
+
+        m_output_holder = m_next_holder;
+        m_buffer = m_next_buffer;
+        m_next_holder = nullptr;
+        m_next_buffer = nullptr;
+        m_next_path.clear();
+        m_cur_line = 0;
+        m_cur_size = 0;
+    }
+
+    m_finished_fragments.push_back(fragment);
+    pthread_cond_broadcast(&m_housekeeping_cond);
+    pthread_mutex_unlock(&m_housekeeping_mutex);
+
+    if (is_used_by_inner_debug)
+        __set_debug_output(m_output_holder);
+
+    if (is_used_by_inner_error)
+        __set_error_output(m_output_holder);
+
+    return __start_fragment();
 }
 
-// NOTE: The main purpose of this function is to update log number,
-//     and the whole log name is also updated relatively.
-int file_logger::__update_log_num(void)
+int file_logger::__start_housekeeper(void)
+{
+    finished_fragment_t first_job;
+
+    first_job.holder = nullptr;
+    first_job.buffer = nullptr;
+    first_job.next_path = __fragment_path(".next"); // nothing finished, only pre-opens the next fragment
+
+    m_base_name = __base_name();
+    m_stop_requested = false;
+    m_preopen_error = 0;
+    m_rotation_error = 0;
+    m_finished_fragments.clear();
+    m_finished_fragments.push_back(first_job);
+
+    int ret = pthread_create(&m_housekeeper, nullptr, housekeeper_routine, this);
+
+    if (0 != ret)
+    {
+        m_finished_fragments.clear();
+        return -ret;
+    }
+    m_housekeeper_running = true;
+
+    return CA_RET_OK;
+}
+
+void file_logger::__stop_housekeeper(void)
+{
+    if (!m_housekeeper_running)
+        return;
+
+    pthread_mutex_lock(&m_housekeeping_mutex);
+    m_stop_requested = true;
+    pthread_cond_broadcast(&m_housekeeping_cond);
+    pthread_mutex_unlock(&m_housekeeping_mutex);
+
+    pthread_join(m_housekeeper, nullptr); // every finished fragment has been handled then
+    m_housekeeper_running = false;
+
+    if (nullptr != m_next_holder)
+    {
+        fclose(m_next_holder);
+        unlink(m_next_path.c_str());
+        m_next_holder = nullptr;
+        m_next_path.clear();
+    }
+
+    if (nullptr != m_next_buffer)
+    {
+        free(m_next_buffer);
+        m_next_buffer = nullptr;
+    }
+    m_preopen_error = 0;
+}
+
+/*static */void *file_logger::housekeeper_routine(void *arg)
+{
+    file_logger *self = (file_logger *)arg;
+
+    pthread_mutex_lock(&(self->m_housekeeping_mutex));
+    while (true)
+    {
+        while (self->m_finished_fragments.empty() && !(self->m_stop_requested))
+            pthread_cond_wait(&(self->m_housekeeping_cond), &(self->m_housekeeping_mutex));
+
+        if (self->m_finished_fragments.empty()) // stop requested, and nothing left
+            break;
+
+        finished_fragment_t fragment = self->m_finished_fragments.front();
+
+        self->m_finished_fragments.pop_front();
+        pthread_mutex_unlock(&(self->m_housekeeping_mutex));
+
+        self->__finish_fragment(fragment);
+
+        pthread_mutex_lock(&(self->m_housekeeping_mutex));
+    }
+    pthread_mutex_unlock(&(self->m_housekeeping_mutex));
+
+    return nullptr;
+}
+
+void file_logger::__finish_fragment(const finished_fragment_t &fragment)
+{
+    int err = 0;
+
+    // NOTE: No cdebug() or cerror() here, for the inner debug output may be the current fragment,
+    //     which is being written by the logging thread. Errors are reported by rotation_error().
+
+    if (!fragment.current_src_path.empty()
+        && rename(fragment.current_src_path.c_str(), fragment.current_dst_path.c_str()) < 0)
+    {
+        err = errno;
+        __atomic_store_n(&m_rotation_error, (0 != err) ? (-err) : CA_RET_GENERAL_FAILURE, __ATOMIC_RELAXED);
+    }
+
+    // Gets the next fragment ready first, the logging thread may be waiting for it.
+    if (!fragment.next_path.empty())
+        __preopen_next_fragment(fragment.next_path);
+
+    if (nullptr != fragment.holder)
+        fclose(fragment.holder); // the buffered contents are written here
+
+    if (nullptr != fragment.buffer)
+        free(fragment.buffer);
+
+    if (!fragment.tmp_path.empty()
+        && rename(fragment.tmp_path.c_str(), fragment.final_path.c_str()) < 0)
+    {
+        err = errno;
+        __atomic_store_n(&m_rotation_error, (0 != err) ? (-err) : CA_RET_GENERAL_FAILURE, __ATOMIC_RELAXED);
+        return;
+    }
+
+    if (fragment.final_path.empty())
+        return;
+
+    if (!m_compression_command.empty())
+        __compress_fragment(fragment.final_path);
+
+    if (m_max_fragments > 0)
+        __remove_old_fragments();
+}
+
+void file_logger::__preopen_next_fragment(const std::string &path)
+{
+    int ret = CA_RET_OK;
+    char *buffer = nullptr;
+    FILE *holder = fopen(path.c_str(), "w+");
+
+    if (nullptr == holder)
+    {
+        int err = errno;
+
+        ret = (0 != err) ? (-err) : CA_RET_GENERAL_FAILURE;
+    }
+    else if (nullptr == (buffer = (char *)malloc(m_cache_buf_size)))
+        ret = CA_RET(MEMORY_ALLOC_FAILED);
+    else if (0 != setvbuf(holder, buffer, _IOFBF, m_cache_buf_size))
+        ret = CA_RET(UNDERLYING_ERROR);
+
+    if (CA_RET_OK != ret)
+    {
+        if (nullptr != holder)
+        {
+            fclose(holder);
+            unlink(path.c_str());
+            holder = nullptr;
+        }
+
+        if (nullptr != buffer)
+        {
+            free(buffer);
+            buffer = nullptr;
+        }
+
+        __atomic_store_n(&m_rotation_error, ret, __ATOMIC_RELAXED);
+    }
+
+    pthread_mutex_lock(&m_housekeeping_mutex);
+    if (nullptr != holder)
+    {
+        m_next_holder = holder;
+        m_next_buffer = buffer;
+        m_next_path = path;
+    }
+    else
+        m_preopen_error = ret;
+    pthread_cond_broadcast(&m_housekeeping_cond);
+    pthread_mutex_unlock(&m_housekeeping_mutex);
+}
+
+void file_logger::__compress_fragment(const std::string &path)
+{
+    // The path is passed as $0 of the script, so that it needs no quoting.
+    std::string script = m_compression_command + " \"$0\"";
+    char *argv[] = {
+        (char *)"sh",
+        (char *)"-c",
+        (char *)script.c_str(),
+        (char *)path.c_str(),
+        nullptr
+    };
+    pid_t pid = -1;
+    int ret = posix_spawn(&pid, "/bin/sh", nullptr, nullptr, argv, environ);
+
+    if (0 != ret)
+    {
+        __atomic_store_n(&m_rotation_error, -ret, __ATOMIC_RELAXED);
+        return;
+    }
+
+    int status = 0;
+
+    // NOTE: It fails with ECHILD if SIGCHLD is ignored or the child is reaped by somebody else,
+    //     the exit status is unknown then.
+    if (waitpid(pid, &status, 0) == pid && (!WIFEXITED(status) || 0 != WEXITSTATUS(status)))
+        __atomic_store_n(&m_rotation_error, CA_RET(UNDERLYING_ERROR), __ATOMIC_RELAXED);
+}
+
+void file_logger::__remove_old_fragments(void)
+{
+    DIR *dir = opendir(m_log_directory);
+
+    if (nullptr == dir)
+        return;
+
+    // A fragment is named as <base name>_YYYYMMDD_<PID>_<number>.log, maybe followed by a compression suffix,
+    // and a fragment being written ends with ".tmp" or ".next".
+    // Only fragments of this process are counted, as other processes (e.g.: reactor workers)
+    // may write fragments with the same base name into the same directory.
+    const std::string kPrefix = m_base_name + "_";
+    const int kDateLen = 8;
+    char pid_part[32] = {0};
+    const int kPidPartLen = snprintf(pid_part, sizeof(pid_part), "_%d_", (int)getpid());
+    const char DIR_DELIM = get_directory_delimiter();
+    std::vector<std::pair<struct timespec, std::string> > fragments;
+    struct dirent *entry = nullptr;
+
+    while (nullptr != (entry = readdir(dir)))
+    {
+        const char *name = entry->d_name;
+        int name_len = strlen(name);
+
+        if (0 != strncmp(name, kPrefix.c_str(), kPrefix.length())
+            || name_len < (int)kPrefix.length() + kDateLen + kPidPartLen
+            || 0 != strncmp(name + kPrefix.length() + kDateLen, pid_part, kPidPartLen)
+            || nullptr == strstr(name + kPrefix.length(), ".log"))
+            continue;
+
+        bool is_date = true;
+
+        for (int i = 0; i < kDateLen && is_date; ++i)
+            is_date = (name[kPrefix.length() + i] >= '0' && name[kPrefix.length() + i] <= '9');
+
+        if (!is_date
+            || (name_len > 4 && 0 == strcmp(name + name_len - 4, ".tmp"))
+            || (name_len > 5 && 0 == strcmp(name + name_len - 5, ".next")))
+            continue;
+
+        std::string path = std::string(m_log_directory) + DIR_DELIM + name;
+        struct stat file_stat;
+
+        if (0 == stat(path.c_str(), &file_stat) && S_ISREG(file_stat.st_mode))
+            fragments.push_back(std::make_pair(file_stat.st_mtim, path));
+    }
+    closedir(dir);
+
+    if ((int)fragments.size() <= m_max_fragments)
+        return;
+
+    struct older_first
+    {
+        bool operator()(const std::pair<struct timespec, std::string> &a,
+            const std::pair<struct timespec, std::string> &b) const
+        {
+            if (a.first.tv_sec != b.first.tv_sec)
+                return a.first.tv_sec < b.first.tv_sec;
+
+            return a.first.tv_nsec < b.first.tv_nsec;
+        }
+    };
+
+    std::sort(fragments.begin(), fragments.end(), older_first());
+    for (int i = 0; i < (int)fragments.size() - m_max_fragments; ++i)
+        unlink(fragments[i].second.c_str());
+}
+
+std::string file_logger::__fragment_path(const char *suffix) const
+{
+    std::string path(m_log_directory);
+
+    path += get_directory_delimiter();
+    path += m_log_name;
+    path += suffix;
+
+    return path;
+}
+
+std::string file_logger::__base_name(void) const
 {
-    int max_name_len = name_length_limit() + 1;
-    char *base_name = (char *)calloc(max_name_len, sizeof(char));
     char date[16] = {0};
-    char *date_ptr = nullptr;
 
     snprintf(date, sizeof(date), "_%04d%02d%02d",
         m_date.tm_year + 1900, m_date.tm_mon + 1, m_date.tm_mday);
-    date_ptr = strstr(m_log_name, date);
 
-    if (nullptr == date_ptr)
-        strncpy(base_name, m_log_name, max_name_len);
-    else
-        strncpy(base_name, m_log_name, (size_t)(date_ptr - m_log_name));
+    const char *date_ptr = strstr(m_log_name, date);
+
+    return (nullptr == date_ptr) ? std::string(m_log_name) : std::string(m_log_name, date_ptr - m_log_name);
+}
+
+// NOTE: The main purpose of this function is to update log number,
+//     and the whole log name is also updated relatively.
+int file_logger::__update_log_num(void)
+{
+    std::string base_name = __base_name();
 
-    __innerly_set_log_name(base_name, true); // Refreshes the whole name.
+    __innerly_set_log_name(base_name.c_str(), true); // Refreshes the whole name.
 
     return CA_RET_OK;
 }
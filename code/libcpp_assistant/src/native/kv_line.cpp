@@ -0,0 +1,286 @@
+/*
+ * Copyright (c) 2026, Wen Xiongchang <udc577 at 126 dot com>
+ * All rights reserved.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any
+ * damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any
+ * purpose, including commercial applications, and to alter it and
+ * redistribute it freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must
+ * not claim that you wrote the original software. If you use this
+ * software in a product, an acknowledgment in the product documentation
+ * would be appreciated but is not required.
+ *
+ * 2. Altered source versions must be plainly marked as such, and
+ * must not be misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source
+ * distribution.
+ */
+
+// NOTE: The original author also uses (short/code) names listed below,
+//       for convenience or for a certain purpose, at different places:
+//       wenxiongchang, wxc, Damon Wen, udc577
+
+#include "kv_line.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+CA_LIB_NAMESPACE_BEGIN
+
+static const int S_RESERVED_LEN = 8; // for the endings of a line, which are always appended
+
+kv_line::kv_line(enum_kv_format format)
+    : m_format(format)
+    , m_len(0)
+    , m_field_start(0)
+    , m_field_count(0)
+    , m_has_message(false)
+    , m_is_full(false)
+{
+    m_buf[0] = '\0';
+}
+
+void kv_line::begin(const char *level_str, const char *message)
+{
+    m_len = 0;
+    m_field_count = 0;
+    m_is_full = false;
+    m_has_message = (nullptr != message && '\0' != message[0]);
+
+    if (KV_FORMAT_TEXT == m_format)
+    {
+        if (m_has_message)
+            __append(message, strlen(message));
+        return;
+    }
+
+    struct timespec now;
+
+    clock_gettime(CLOCK_REALTIME, &now);
+    __append("{\"ts\":", 6);
+    __append_integer((unsigned long long)now.tv_sec * 1000000 + now.tv_nsec / 1000, false);
+    __append(",\"level\":\"", 10);
+    __append_escaped(level_str);
+    __append("\",\"msg\":\"", 9);
+    if (m_has_message)
+        __append_escaped(message);
+    __force_append("\"", 1);
+}
+
+void kv_line::add(const char *key, long long value)
+{
+    if (!__begin_field(key))
+        return;
+
+    if (value < 0)
+        __append_integer((unsigned long long)(-(value + 1)) + 1, true);
+    else
+        __append_integer((unsigned long long)value, false);
+
+    __end_field();
+}
+
+void kv_line::add(const char *key, unsigned long long value)
+{
+    if (!__begin_field(key))
+        return;
+
+    __append_integer(value, false);
+
+    __end_field();
+}
+
+void kv_line::add(const char *key, double value)
+{
+    if (!__begin_field(key))
+        return;
+
+    if (KV_FORMAT_JSON == m_format && !isfinite(value))
+        __append("null", 4); // not supported by JSON
+    else
+    {
+        char buf[32];
+        int len = snprintf(buf, sizeof(buf), "%.15g", value);
+
+        __append(buf, len);
+    }
+
+    __end_field();
+}
+
+void kv_line::add(const char *key, bool value)
+{
+    if (!__begin_field(key))
+        return;
+
+    if (value)
+        __append("true", 4);
+    else
+        __append("false", 5);
+
+    __end_field();
+}
+
+void kv_line::add(const char *key, const char *value)
+{
+    if (!__begin_field(key))
+        return;
+
+    if (KV_FORMAT_TEXT == m_format)
+    {
+        if (nullptr == value)
+            __append("(null)", 6);
+        else
+            __append(value, strlen(value)); // as it is, no formatting at all
+    }
+    else
+    {
+        if (nullptr == value)
+            __append("null", 4);
+        else
+        {
+            __append("\"", 1);
+            __append_escaped(value);
+            __append("\"", 1);
+        }
+    }
+
+    __end_field();
+}
+
+void kv_line::end(void)
+{
+    if (KV_FORMAT_TEXT == m_format)
+        __force_append("\n", 1);
+    else
+        __force_append("}\n", 2);
+
+    m_buf[m_len] = '\0';
+}
+
+bool kv_line::__begin_field(const char *key)
+{
+    if (m_is_full)
+        return false;
+
+    m_field_start = m_len;
+
+    if (KV_FORMAT_TEXT == m_format)
+    {
+        if (m_field_count > 0)
+            __append(" | ", 3);
+        else if (m_has_message)
+            __append(": ", 2);
+        __append(key, strlen(key));
+        __append("[", 1);
+    }
+    else
+    {
+        __append(",\"", 2);
+        __append_escaped(key);
+        __append("\":", 2);
+    }
+
+    return true;
+}
+
+void kv_line::__end_field(void)
+{
+    if (KV_FORMAT_TEXT == m_format)
+        __append("]", 1);
+
+    if (m_is_full)
+        m_len = m_field_start; // and the fields after it are dropped too
+    else
+        ++m_field_count;
+}
+
+void kv_line::__append(const char *str, int len)
+{
+    int room = MAX_LEN - S_RESERVED_LEN - m_len;
+
+    if (len > room)
+    {
+        len = (room > 0) ? room : 0;
+        m_is_full = true;
+    }
+
+    memcpy(m_buf + m_len, str, len);
+    m_len += len;
+}
+
+void kv_line::__force_append(const char *str, int len)
+{
+    memcpy(m_buf + m_len, str, len);
+    m_len += len;
+}
+
+void kv_line::__append_escaped(const char *str)
+{
+    static const char HEX_DIGITS[] = "0123456789abcdef";
+    const char *span_start = str;
+    const char *pos = str;
+
+    for (; '\0' != *pos; ++pos)
+    {
+        unsigned char c = (unsigned char)*pos;
+
+        if (c >= 0x20 && '"' != c && '\\' != c)
+            continue;
+
+        __append(span_start, pos - span_start); // the characters needing no escaping
+        span_start = pos + 1;
+
+        char escaped[6] = { '\\', (char)c, 0, 0, 0, 0 };
+        int escaped_len = 2;
+
+        if ('\n' == c)
+            escaped[1] = 'n';
+        else if ('\r' == c)
+            escaped[1] = 'r';
+        else if ('\t' == c)
+            escaped[1] = 't';
+        else if (c < 0x20)
+        {
+            memcpy(escaped + 1, "u00", 3);
+            escaped[4] = HEX_DIGITS[c >> 4];
+            escaped[5] = HEX_DIGITS[c & 0xF];
+            escaped_len = 6;
+        }
+
+        if (MAX_LEN - S_RESERVED_LEN - m_len < escaped_len) // never cut off an escape sequence
+        {
+            m_is_full = true;
+            return;
+        }
+        __append(escaped, escaped_len);
+    }
+    __append(span_start, pos - span_start);
+}
+
+void kv_line::__append_integer(unsigned long long value, bool is_negative)
+{
+    char buf[24];
+    char *pos = buf + sizeof(buf);
+
+    do
+    {
+        *(--pos) = '0' + (value % 10);
+        value /= 10;
+    } while (value > 0);
+
+    if (is_negative)
+        *(--pos) = '-';
+
+    __append(pos, buf + sizeof(buf) - pos);
+}
+
+CA_LIB_NAMESPACE_END
@@ -52,14 +52,25 @@ const bool NOT_RELEASE_LOG_BUF_ON_CLOSE = false;
 
 logger::logger()
     : m_log_level(LOG_LEVEL_ALL)
+    , m_unmuted_level(LOG_LEVEL_ALL)
     , m_instant_level(LOG_LEVEL_ALL)
+    , m_is_muted(false)
     , m_is_open(false)
     , m_output_holder(nullptr)
     , m_cur_line(0)
+    , m_cur_size(0)
     , m_log_num(0)
     , m_to_screen(false) // has to be initialized again in the constructor of a specified derived class
+    , m_uses_colors(false)
+    , m_uses_coarse_clock(false)
+    , m_is_thread_safe(false)
+    , m_kv_format(KV_FORMAT_TEXT)
+    , m_now_sec(0)
+    , m_now_usec(0)
 {
     memset(&m_date, 0, sizeof(struct tm));
+    memset(&m_now, 0, sizeof(struct tm));
+    memset(m_prefix, 0, sizeof(m_prefix));
 }
 
 logger::~logger()
@@ -146,17 +157,26 @@ logger::~logger()
     return CA_RET_OK;
 }
 
-void logger::flush(void)
+/*virtual */void logger::flush(void)
 {
-    if (!is_open())
+    if (!m_is_thread_safe)
+    {
+        if (is_open())
+            fflush(m_output_holder);
         return;
+    }
+
+    lock_guard<mutex> lock(m_output_lock);
 
-    fflush(m_output_holder);
+    if (is_open())
+        fflush(m_output_holder);
 }
 
 const char *G_LOG_LEVEL_STRINGS[] = { "D", "I", "W", "E", "C" };
 
-int logger::output(bool has_prefix,
+static const int S_THREAD_LINE_BUF_SIZE = 8 * 1024;
+
+/*virtual */int logger::output(bool has_prefix,
     enum_log_level log_level,
     const char *fmt,
     va_list args) /* CA_NOTNULL(4) */
@@ -166,30 +186,102 @@ int logger::output(bool has_prefix,
         return CA_RET(NULL_PARAM);
     */
 
+    if (!m_is_thread_safe)
+    {
+        if (!is_open())
+            return CA_RET(FILE_OR_STREAM_NOT_OPEN);
+
+        if (log_level < m_log_level)
+            return 0;
+
+        return __write_line(has_prefix, log_level, nullptr, 0, fmt, args);
+    }
+
+    if (log_level < m_log_level)
+        return 0;
+
+    // Formats the line out of the lock, into a buffer of the calling thread.
+    // NOTE: The open status is checked in the lock, for the logger is closed for a moment when it switches.
+    static __thread char s_line_buf[S_THREAD_LINE_BUF_SIZE];
+    va_list args_copy;
+
+    va_copy(args_copy, args);
+    int body_len = vsnprintf(s_line_buf, sizeof(s_line_buf), fmt, args_copy);
+    va_end(args_copy);
+
+    lock_guard<mutex> lock(m_output_lock);
+
     if (!is_open())
         return CA_RET(FILE_OR_STREAM_NOT_OPEN);
 
+    if (body_len >= 0 && body_len < (int)sizeof(s_line_buf))
+        return __write_line(has_prefix, log_level, s_line_buf, body_len, fmt, args);
+
+    return __write_line(has_prefix, log_level, nullptr, 0, fmt, args); // too long, formatted in the lock then
+}
+
+/*virtual */int logger::output_formatted(bool has_prefix,
+    enum_log_level log_level,
+    const char *line,
+    int len) /* CA_NOTNULL(4) */
+{
+    if (!m_is_thread_safe)
+    {
+        if (!is_open())
+            return CA_RET(FILE_OR_STREAM_NOT_OPEN);
+
+        if (log_level < m_log_level)
+            return 0;
+
+        return __write_formatted_line(has_prefix, log_level, line, len);
+    }
+
     if (log_level < m_log_level)
         return 0;
 
-    bool needs_color = (m_to_screen && log_level >= LOG_LEVEL_WARNING);
-    FILE *destination = needs_color ? stderr : m_output_holder;
-    struct timeval tv;
-    struct tm now;
+    lock_guard<mutex> lock(m_output_lock);
 
-    gettimeofday(&tv, nullptr);
-    localtime_r((time_t *)&(tv.tv_sec), &now);
+    if (!is_open())
+        return CA_RET(FILE_OR_STREAM_NOT_OPEN);
+
+    return __write_formatted_line(has_prefix, log_level, line, len);
+}
+
+int logger::__write_formatted_line(bool has_prefix, enum_log_level log_level, const char *line, int len, ...)
+{
+    va_list args;
+
+    va_start(args, len);
+    int ret = __write_line(has_prefix, log_level, line, len, "", args); // the format is not used
+    va_end(args);
+
+    return ret;
+}
+
+int logger::__write_line(bool has_prefix,
+    enum_log_level log_level,
+    const char *formatted,
+    int formatted_len,
+    const char *fmt,
+    va_list args)
+{
+    bool to_stderr = (m_to_screen && log_level >= LOG_LEVEL_WARNING);
+    bool needs_color = (to_stderr && m_uses_colors);
+    FILE *destination = to_stderr ? stderr : m_output_holder;
+
+    __update_log_time();
 
     /*
      * If the logger needs to switch, save previous contents first and do switching.
      */
-    if (m_cur_line >= log_line_limit() || now.tm_mday != m_date.tm_mday)
+    if (__needs_switching())
     {
         /*cdebug("m_to_screen: %d, needs_color: %d, converted destination fd: %d\n",
             m_to_screen, needs_color, fileno(destination));*/
 
-        fflush(m_output_holder);
-        if (needs_color)
+        // NOTE: Contents of the current fragment are flushed by the switching itself,
+        //     which may be done in another thread, see file_logger::set_rotates_in_background().
+        if (to_stderr)
             fflush(stderr);
 
         int switch_ret = __switch_logger_status();
@@ -197,7 +289,7 @@ int logger::output(bool has_prefix,
         if (CA_RET_OK != switch_ret)
             return switch_ret;
 
-        destination = needs_color ? stderr : m_output_holder; // NOTE: MUST refresh the file handle after switching.
+        destination = to_stderr ? stderr : m_output_holder; // NOTE: MUST refresh the file handle after switching.
     }
 
     /*
@@ -216,28 +308,73 @@ int logger::output(bool has_prefix,
 
     if (has_prefix)
     {
-        const char *LEVEL_STR = G_LOG_LEVEL_STRINGS[log_level % LOG_LEVEL_COUNT];
-
 #if 0 // Enable it when you want to test the "wired problem" in unittest/test_file_logger.cpp.
         if (debug_is_enabled())
             fprintf(destination, "%08d: ", m_cur_line + 1);
 #endif
 
-        /*write_ret += */fprintf(destination, "%s%02d%02d %02d:%02d:%02d.%06ld ",
-            LEVEL_STR, now.tm_mon + 1, now.tm_mday,
-            now.tm_hour, now.tm_min, now.tm_sec, tv.tv_usec);
+        /*write_ret += */fwrite(__log_prefix(log_level), 1, LOG_PREFIX_LEN, destination);
+        m_cur_size += LOG_PREFIX_LEN;
     }
 
-    write_ret += vfprintf(destination, fmt, args);
+    if (nullptr != formatted)
+        write_ret += fwrite(formatted, 1, formatted_len, destination);
+    else
+        write_ret += vfprintf(destination, fmt, args);
 
     if (needs_color)
         fprintf(destination, NO_PRINT_ATTRIBUTES);
 
     ++m_cur_line;
+    if (write_ret > 0)
+        m_cur_size += write_ret;
 
     return write_ret;
 }
 
+void logger::__update_log_time(void)
+{
+    struct timespec ts;
+
+#ifdef CLOCK_REALTIME_COARSE
+    clock_gettime(m_uses_coarse_clock ? CLOCK_REALTIME_COARSE : CLOCK_REALTIME, &ts);
+#else
+    clock_gettime(CLOCK_REALTIME, &ts);
+#endif
+
+    if (ts.tv_sec != m_now_sec)
+    {
+        m_now_sec = ts.tv_sec;
+        localtime_r(&m_now_sec, &m_now);
+        // The level and the microseconds are filled later.
+        // Fields are written by hand, since each of them fits in its two digits.
+        const int kFields[] = { m_now.tm_mon + 1, m_now.tm_mday, m_now.tm_hour, m_now.tm_min, m_now.tm_sec };
+        const char kSeparators[] = { '\0', '\0', ' ', ':', ':' }; // before each field
+        char *pos = m_prefix;
+
+        *pos++ = 'L';
+        for (size_t i = 0; i < sizeof(kFields) / sizeof(kFields[0]); ++i)
+        {
+            if ('\0' != kSeparators[i])
+                *pos++ = kSeparators[i];
+            *pos++ = '0' + kFields[i] / 10 % 10;
+            *pos++ = '0' + kFields[i] % 10;
+        }
+        memcpy(pos, ".000000 ", sizeof(".000000 ")); // with the null terminator
+    }
+
+    m_now_usec = ts.tv_nsec / 1000;
+
+    long usec = m_now_usec;
+    char *digit = m_prefix + LOG_PREFIX_LEN - 2; // the last digit, followed by a space
+
+    for (int i = 0; i < 6; ++i)
+    {
+        *digit-- = '0' + usec % 10;
+        usec /= 10;
+    }
+}
+
 #define CALL_FORMATED_OUTPUT(has_prefix, level, contents)   \
     va_list args; \
     int ret; \
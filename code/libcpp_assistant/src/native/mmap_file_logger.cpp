@@ -0,0 +1,256 @@
+/*
+ * Copyright (c) 2026, Wen Xiongchang <udc577 at 126 dot com>
+ * All rights reserved.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any
+ * damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any
+ * purpose, including commercial applications, and to alter it and
+ * redistribute it freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must
+ * not claim that you wrote the original software. If you use this
+ * software in a product, an acknowledgment in the product documentation
+ * would be appreciated but is not required.
+ *
+ * 2. Altered source versions must be plainly marked as such, and
+ * must not be misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source
+ * distribution.
+ */
+
+// NOTE: The original author also uses (short/code) names listed below,
+//       for convenience or for a certain purpose, at different places:
+//       wenxiongchang, wxc, Damon Wen, udc577
+
+#include "mmap_file_logger.h"
+
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include "private/debug.h"
+
+CA_LIB_NAMESPACE_BEGIN
+
+mmap_file_logger::mmap_file_logger()
+    : file_logger()
+    , m_window_size(DEFAULT_LOG_CACHE_SIZE)
+    , m_fd(-1)
+    , m_map(nullptr)
+    , m_map_offset(0)
+    , m_map_len(0)
+    , m_write_offset(0)
+{
+    ;
+}
+
+mmap_file_logger::~mmap_file_logger()
+{
+    close(); // here but not only in ~file_logger(), where __end_fragment() of this class is not called any more
+}
+
+/*virtual */int mmap_file_logger::open(int cache_buf_size/* = DEFAULT_LOG_CACHE_SIZE*/)
+{
+    if (is_open())
+        return CA_RET_OK;
+
+    int page_size = getpagesize();
+    int window_size = cache_buf_size;
+
+    if (window_size < MIN_WINDOW_SIZE)
+        window_size = MIN_WINDOW_SIZE;
+    else if (window_size > MAX_WINDOW_SIZE)
+        window_size = MAX_WINDOW_SIZE;
+    else
+        window_size = (window_size + page_size - 1) / page_size * page_size;
+    m_window_size = window_size;
+
+    // The stdio buffer holds nothing but possible inner debug output, a small one is enough.
+    return file_logger::open(BUFSIZ);
+}
+
+/*virtual */int mmap_file_logger::output(bool has_prefix,
+    enum_log_level log_level,
+    const char *fmt,
+    va_list args) /* CA_NOTNULL(4) */
+{
+    if (!m_is_thread_safe)
+    {
+        if (!is_open())
+            return CA_RET(FILE_OR_STREAM_NOT_OPEN);
+
+        if (log_level < m_log_level)
+            return 0;
+
+        return __write_mapped_line(has_prefix, log_level, nullptr, 0, fmt, args);
+    }
+
+    if (log_level < m_log_level)
+        return 0;
+
+    // Formats the line out of the lock, into a buffer of the calling thread.
+    static __thread char s_line_buf[MAX_LINE_LEN];
+    int body_len = vsnprintf(s_line_buf, sizeof(s_line_buf), fmt, args);
+
+    if (body_len < 0)
+        body_len = 0;
+    else if (body_len >= (int)sizeof(s_line_buf)) // truncated
+    {
+        body_len = sizeof(s_line_buf) - 1;
+        s_line_buf[body_len - 1] = '\n';
+    }
+
+    lock_guard<mutex> lock(m_output_lock);
+
+    if (!is_open())
+        return CA_RET(FILE_OR_STREAM_NOT_OPEN);
+
+    return __write_mapped_line(has_prefix, log_level, s_line_buf, body_len, fmt, args);
+}
+
+/*virtual */int mmap_file_logger::output_formatted(bool has_prefix,
+    enum_log_level log_level,
+    const char *line,
+    int len) /* CA_NOTNULL(4) */
+{
+    return output(has_prefix, log_level, "%.*s", len, line);
+}
+
+/*virtual */int mmap_file_logger::__start_fragment(void)
+{
+    m_fd = fileno(m_output_holder);
+    m_map = nullptr;
+    m_map_offset = 0;
+    m_map_len = 0;
+    m_write_offset = 0;
+
+    return __map_window(0);
+}
+
+/*virtual */void mmap_file_logger::__end_fragment(void)
+{
+    if (m_fd < 0)
+        return;
+
+    // The kernel writes the pages back by itself, nothing to be synchronized here.
+    if (nullptr != m_map)
+    {
+        munmap(m_map, m_map_len);
+        m_map = nullptr;
+        m_map_len = 0;
+    }
+
+    if (ftruncate(m_fd, m_write_offset) < 0)
+        cerror("ftruncate() failed, errno = %d\n", errno);
+    m_fd = -1;
+}
+
+int mmap_file_logger::__write_mapped_line(bool has_prefix,
+    enum_log_level log_level,
+    const char *formatted,
+    int formatted_len,
+    const char *fmt,
+    va_list args)
+{
+    __update_log_time();
+
+    if (__needs_switching())
+    {
+        int switch_ret = __switch_logger_status();
+
+        if (CA_RET_OK != switch_ret)
+            return switch_ret;
+    }
+
+    if (__room_in_window() < LOG_PREFIX_LEN + MAX_LINE_LEN)
+    {
+        int map_ret = __map_window(m_write_offset);
+
+        if (CA_RET_OK != map_ret)
+            return map_ret;
+    }
+
+    char *line = m_map + (m_write_offset - m_map_offset);
+    int line_len = 0;
+    int body_len = 0;
+
+    if (has_prefix)
+    {
+        memcpy(line, __log_prefix(log_level), LOG_PREFIX_LEN);
+        line_len = LOG_PREFIX_LEN;
+    }
+
+    if (nullptr != formatted)
+    {
+        memcpy(line + line_len, formatted, formatted_len);
+        body_len = formatted_len;
+    }
+    else
+    {
+        // NOTE: The terminating '\0' is overwritten by the next line, or is a part of the zero fill.
+        body_len = vsnprintf(line + line_len, MAX_LINE_LEN, fmt, args);
+        if (body_len < 0)
+            body_len = 0;
+        else if (body_len >= MAX_LINE_LEN) // truncated
+        {
+            body_len = MAX_LINE_LEN - 1;
+            line[line_len + body_len - 1] = '\n';
+        }
+    }
+    line_len += body_len;
+
+    m_write_offset += line_len;
+    m_cur_size += line_len;
+    ++m_cur_line;
+
+    return body_len;
+}
+
+int mmap_file_logger::__map_window(int64_t offset)
+{
+    int64_t window_offset = offset - offset % getpagesize();
+
+    if (nullptr != m_map)
+    {
+        munmap(m_map, m_map_len);
+        m_map = nullptr;
+    }
+    m_map_offset = offset;
+    m_map_len = 0;
+
+    // Allocates the blocks, rather than only extending the file by ftruncate(),
+    // or writing into a hole of a full disk would raise SIGBUS.
+    int ret = posix_fallocate(m_fd, window_offset, m_window_size);
+
+    if (0 != ret)
+    {
+        cerror("posix_fallocate() failed, ret = %d\n", ret);
+        return -ret;
+    }
+
+    void *addr = mmap(nullptr, m_window_size, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, window_offset);
+
+    if (MAP_FAILED == addr)
+    {
+        int err = errno;
+
+        cerror("mmap() failed\n");
+        return (0 != err) ? (-err) : CA_RET_GENERAL_FAILURE;
+    }
+
+    m_map = (char *)addr;
+    m_map_offset = window_offset;
+    m_map_len = m_window_size;
+
+    return CA_RET_OK;
+}
+
+CA_LIB_NAMESPACE_END
@@ -28,11 +28,13 @@
 
 #include "net_common.h"
 
+#include <stddef.h>
 #include <stdlib.h>
 #include <unistd.h>
 #include <string.h>
 #include <arpa/inet.h>
 
+#include "base/ca_return_code.h"
 #include "private/debug.h"
 #include "sequential_buffer.h"
 
@@ -86,7 +88,7 @@ CA_REENTRANT const char *desc_of_connection_type(int src_value)
     return desc[src_value - 1];
 }
 
-static void init_net_connection(net_conn &conn)
+CA_REENTRANT void init_net_connection(net_conn &conn)
 {
     conn.fd = INVALID_SOCK_FD;
     memset(conn.self_ip, 0, sizeof(conn.self_ip));
@@ -98,7 +100,17 @@ static void init_net_connection(net_conn &conn)
     conn.conn_status = CONN_STATUS_DISCONNECTED;
     conn.is_blocking = true;
     conn.is_validated = false;
+    conn.is_still_readable = false;
+    conn.is_corked = false;
     conn.send_buf = nullptr;
+    conn.send_queue_head = nullptr;
+    conn.send_queue_tail = nullptr;
+    conn.queued_bytes = 0;
+    conn.queued_buf_bytes = 0;
+    conn.pending_list = nullptr;
+    conn.pending_prev = nullptr;
+    conn.pending_next = nullptr;
+    conn.is_send_pending = false;
     conn.recv_buf = nullptr;
     conn.last_op_time = 0;
     conn.owner = nullptr;
@@ -171,6 +183,9 @@ CA_REENTRANT void destroy_net_connection(net_conn **conn)
         if ((*conn)->fd >= 0)
             close((*conn)->fd);
 
+        unmark_send_pending(**conn);
+        clear_send_queue(**conn);
+
         if (nullptr != (*conn)->send_buf)
         {
             delete((*conn)->send_buf);
@@ -188,6 +203,168 @@ CA_REENTRANT void destroy_net_connection(net_conn **conn)
     }
 }
 
+CA_REENTRANT shared_packet *create_shared_packet(const void *data, int len)
+{
+    if (len < 0 || (nullptr == data && len > 0))
+        return nullptr;
+
+    shared_packet *packet = (shared_packet *)malloc(offsetof(shared_packet, data) + len);
+
+    if (nullptr == packet)
+        return nullptr;
+
+    packet->ref_count = 1;
+    packet->len = len;
+    if (len > 0)
+        memcpy(packet->data, data, len);
+
+    return packet;
+}
+
+CA_REENTRANT void retain_shared_packet(shared_packet *packet)
+{
+    if (nullptr != packet)
+        __atomic_add_fetch(&(packet->ref_count), 1, __ATOMIC_RELAXED);
+}
+
+CA_REENTRANT void release_shared_packet(shared_packet **packet)
+{
+    if ((shared_packet **)nullptr == packet || nullptr == *packet)
+        return;
+
+    if (0 == __atomic_sub_fetch(&((*packet)->ref_count), 1, __ATOMIC_ACQ_REL))
+        free(*packet);
+    *packet = nullptr;
+}
+
+CA_REENTRANT int push_send_queue(net_conn &conn, shared_packet *packet)
+{
+    if (nullptr == packet)
+        return CA_RET(NULL_PARAM);
+
+    int uncovered_buf_len = ((nullptr == conn.send_buf) ? 0 : conn.send_buf->data_size()) - conn.queued_buf_bytes;
+    send_queue_node *span = nullptr;
+    send_queue_node *node = (send_queue_node *)malloc(sizeof(send_queue_node));
+
+    if (nullptr == node ||
+        (uncovered_buf_len > 0 && nullptr == (span = (send_queue_node *)malloc(sizeof(send_queue_node)))))
+    {
+        free(node);
+        return CA_RET(MEMORY_ALLOC_FAILED);
+    }
+
+    retain_shared_packet(packet);
+    node->packet = packet;
+    node->offset = 0;
+    node->buf_len = 0;
+    node->next = nullptr;
+    conn.queued_bytes += packet->len;
+    if (nullptr != span)
+    {
+        span->packet = nullptr;
+        span->offset = 0;
+        span->buf_len = uncovered_buf_len;
+        span->next = node;
+        conn.queued_buf_bytes += uncovered_buf_len;
+    }
+
+    send_queue_node *first = (nullptr != span) ? span : node;
+
+    if (nullptr == conn.send_queue_tail)
+        conn.send_queue_head = first;
+    else
+        conn.send_queue_tail->next = first;
+    conn.send_queue_tail = node;
+
+    return CA_RET_OK;
+}
+
+CA_REENTRANT void consume_send_queue(net_conn &conn, int len)
+{
+    while (len > 0 && nullptr != conn.send_queue_head)
+    {
+        send_queue_node *node = conn.send_queue_head;
+        bool is_span = (nullptr == node->packet);
+        int unsent_len = is_span ? node->buf_len : (node->packet->len - node->offset);
+        int sent_len = (len < unsent_len) ? len : unsent_len;
+
+        if (is_span)
+        {
+            conn.send_buf->move_read_pointer(sent_len);
+            node->buf_len -= sent_len;
+            conn.queued_buf_bytes -= sent_len;
+        }
+        else
+        {
+            node->offset += sent_len;
+            conn.queued_bytes -= sent_len;
+        }
+        len -= sent_len;
+        if (sent_len < unsent_len)
+            return;
+
+        conn.send_queue_head = node->next;
+        if (nullptr == conn.send_queue_head)
+            conn.send_queue_tail = nullptr;
+        release_shared_packet(&(node->packet));
+        free(node);
+    }
+
+    // data written into send_buf after the last packet
+    if (len > 0 && nullptr != conn.send_buf)
+        conn.send_buf->move_read_pointer(len);
+}
+
+CA_REENTRANT void clear_send_queue(net_conn &conn)
+{
+    while (nullptr != conn.send_queue_head)
+    {
+        send_queue_node *node = conn.send_queue_head;
+
+        conn.send_queue_head = node->next;
+        release_shared_packet(&(node->packet));
+        free(node);
+    }
+    conn.send_queue_tail = nullptr;
+    conn.queued_bytes = 0;
+    conn.queued_buf_bytes = 0;
+}
+
+CA_REENTRANT void mark_send_pending(net_conn &conn)
+{
+    send_pending_list *list = conn.pending_list;
+
+    if (nullptr == list || conn.is_send_pending)
+        return;
+
+    conn.pending_prev = nullptr;
+    conn.pending_next = list->head;
+    if (nullptr != list->head)
+        list->head->pending_prev = &conn;
+    list->head = &conn;
+    ++(list->count);
+    conn.is_send_pending = true;
+}
+
+CA_REENTRANT void unmark_send_pending(net_conn &conn)
+{
+    send_pending_list *list = conn.pending_list;
+
+    if (nullptr == list || !conn.is_send_pending)
+        return;
+
+    if (nullptr == conn.pending_prev)
+        list->head = conn.pending_next;
+    else
+        conn.pending_prev->pending_next = conn.pending_next;
+    if (nullptr != conn.pending_next)
+        conn.pending_next->pending_prev = conn.pending_prev;
+    conn.pending_prev = nullptr;
+    conn.pending_next = nullptr;
+    --(list->count);
+    conn.is_send_pending = false;
+}
+
 CA_REENTRANT bool is_valid_ipv4(const char *ip)
 {
     if (nullptr == ip)
@@ -46,10 +46,10 @@ net_poller::net_poller()
     init();
 }
 
-net_poller::net_poller(int max_conn_count, int timeout)
+net_poller::net_poller(int max_conn_count, int timeout, int event_batch_size/* = DEFAULT_EVENT_BATCH_SIZE*/)
 {
     init();
-    create(max_conn_count, timeout);
+    create(max_conn_count, timeout, event_batch_size);
 }
 
 net_poller::~net_poller()
@@ -57,7 +57,7 @@ net_poller::~net_poller()
     clear();
 }
 
-int net_poller::create(int max_conn_count, int timeout)
+int net_poller::create(int max_conn_count, int timeout, int event_batch_size/* = DEFAULT_EVENT_BATCH_SIZE*/)
 {
     if (nullptr != m_epoll_events_holder)
         return CA_RET(OBJECT_ALREADY_EXISTS);
@@ -75,14 +75,11 @@ int net_poller::create(int max_conn_count, int timeout)
         goto CREATE_FAILED;
     }
 
-    if (nullptr == (m_epoll_events_holder = (poll_event_t *)malloc(sizeof(poll_event_t) * m_max_connection_count)))
+    if ((ret = set_event_batch_size(event_batch_size)) < 0)
     {
-        ret = CA_RET(MEMORY_ALLOC_FAILED);
-        cerror("malloc() for m_epoll_events_holder failed\n");
+        cerror("set_event_batch_size(%d) failed\n", event_batch_size);
         goto CREATE_FAILED;
     }
-    m_active_connections.elements = m_epoll_events_holder;
-    m_active_connections.count = 0;
 
     return CA_RET_OK;
 
@@ -100,16 +97,29 @@ void net_poller::destroy(void)
 
 int net_poller::poll(void)
 {
+    if (m_needs_growing)
+    {
+        // Failure is not fatal, the current batch still works.
+        if (resize_events_holder(m_event_batch_size * 2) < 0)
+            cerror("failed to grow event batch from %d\n", m_event_batch_size);
+        m_needs_growing = false;
+    }
+
     // The result containing active connections will be put into m_epoll_events_holder,
     // and m_epoll_events_holder is a member of m_active_connections.
-    int ret = epoll_wait(m_fd, m_epoll_events_holder, m_current_connection_count, m_timeout);
+    int ret = epoll_wait(m_fd, m_epoll_events_holder, m_event_batch_size, m_timeout);
 
     if (ret < 0)
     {
         ret = -errno;
+        m_active_connections.count = 0;
         return ret;
     }
 
+    // Events left in the kernel will be fetched next time, with a larger batch if possible.
+    if (ret >= m_event_batch_size && m_event_batch_size < m_max_event_batch_size)
+        m_needs_growing = true;
+
 #ifdef SAVE_ALL_POLLER_CONNECTIONS
     /*
      * Synchronizes the changes.
@@ -127,6 +137,20 @@ int net_poller::poll(void)
     return m_active_connections.count;
 }
 
+int net_poller::set_event_batch_size(int size, int max_size/* = 0*/)
+{
+    m_max_event_batch_size = (max_size > 0) ? max_size : MAX_EVENT_BATCH_SIZE;
+    if (m_max_event_batch_size < MIN_EVENT_BATCH_SIZE)
+        m_max_event_batch_size = MIN_EVENT_BATCH_SIZE;
+
+    if (size <= 0)
+        size = DEFAULT_EVENT_BATCH_SIZE;
+
+    m_needs_growing = false;
+
+    return resize_events_holder(size);
+}
+
 bool net_poller::is_readable(int fd)
 {
     return test_single_event(fd, EVENT_READ);
@@ -147,6 +171,9 @@ void net_poller::init(void)
 #endif
     memset(&m_active_connections, 0, sizeof(conn_info_array));
     m_epoll_events_holder = nullptr;
+    m_event_batch_size = 0;
+    m_max_event_batch_size = MAX_EVENT_BATCH_SIZE;
+    m_needs_growing = false;
     m_timeout = 0;
 }
 
@@ -173,6 +200,9 @@ void net_poller::clear(void)
         m_epoll_events_holder = nullptr;
         //DEBUG_PRINT_C("m_epoll_events_holder released\n");
     }
+    m_event_batch_size = 0;
+    m_max_event_batch_size = MAX_EVENT_BATCH_SIZE;
+    m_needs_growing = false;
     m_timeout = 0;
 }
 
@@ -263,4 +293,30 @@ int net_poller::handle_monitored_connection(const struct net_connection *conn, i
     return CA_RET_OK;
 }
 
+int net_poller::resize_events_holder(int size)
+{
+    if (size < MIN_EVENT_BATCH_SIZE)
+        size = MIN_EVENT_BATCH_SIZE;
+    else if (size > m_max_event_batch_size)
+        size = m_max_event_batch_size;
+
+    if (size == m_event_batch_size && nullptr != m_epoll_events_holder)
+        return CA_RET_OK;
+
+    poll_event_t *new_holder = (poll_event_t *)realloc(m_epoll_events_holder, sizeof(poll_event_t) * size);
+
+    if (nullptr == new_holder)
+    {
+        cerror("realloc() for m_epoll_events_holder failed, size = %d\n", size);
+        return CA_RET(MEMORY_ALLOC_FAILED);
+    }
+
+    m_epoll_events_holder = new_holder;
+    m_event_batch_size = size;
+    m_active_connections.elements = m_epoll_events_holder;
+    m_active_connections.count = 0;
+
+    return CA_RET_OK;
+}
+
 CA_LIB_NAMESPACE_END
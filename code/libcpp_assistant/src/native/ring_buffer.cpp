@@ -0,0 +1,304 @@
+/*
+ * Copyright (c) 2026, Wen Xiongchang <udc577 at 126 dot com>
+ * All rights reserved.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any
+ * damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any
+ * purpose, including commercial applications, and to alter it and
+ * redistribute it freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must
+ * not claim that you wrote the original software. If you use this
+ * software in a product, an acknowledgment in the product documentation
+ * would be appreciated but is not required.
+ *
+ * 2. Altered source versions must be plainly marked as such, and
+ * must not be misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source
+ * distribution.
+ */
+
+// NOTE: The original author also uses (short/code) names listed below,
+//       for convenience or for a certain purpose, at different places:
+//       wenxiongchang, wxc, Damon Wen, udc577
+
+#include "ring_buffer.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include "base/ca_return_code.h"
+#include "private/debug.h"
+
+CA_LIB_NAMESPACE_BEGIN
+
+ring_buffer::ring_buffer()
+    : m_data(nullptr),
+      m_total_size(0),
+      m_read_pos(0),
+      m_data_size(0),
+      m_is_mirrored(false)
+{
+    ;
+}
+
+ring_buffer::ring_buffer(int size, bool is_mirrored/* = false*/)
+    : m_data(nullptr),
+      m_total_size(0),
+      m_read_pos(0),
+      m_data_size(0),
+      m_is_mirrored(false)
+{
+    create(size, is_mirrored);
+}
+
+ring_buffer::~ring_buffer()
+{
+    destroy();
+}
+
+int ring_buffer::create(int size, bool is_mirrored/* = false*/)
+{
+    if (nullptr != m_data)
+        return CA_RET(OBJECT_ALREADY_EXISTS);
+
+    if (size <= 0)
+        return CA_RET(INVALID_PARAM_VALUE);
+
+    if (size < MIN_BUF_SIZE)
+        size = MIN_BUF_SIZE;
+
+    if (is_mirrored)
+        return create_mirrored(size);
+
+    if (nullptr == (m_data = (char *)malloc(size)))
+        return CA_RET(MEMORY_ALLOC_FAILED);
+
+    m_total_size = size;
+    m_read_pos = 0;
+    m_data_size = 0;
+    m_is_mirrored = false;
+
+    return CA_RET_OK;
+}
+
+void ring_buffer::destroy(void)
+{
+    if (nullptr != m_data)
+    {
+        if (m_is_mirrored)
+            munmap(m_data, m_total_size * 2);
+        else
+            free(m_data);
+        m_data = nullptr;
+    }
+    m_total_size = 0;
+    m_read_pos = 0;
+    m_data_size = 0;
+    m_is_mirrored = false;
+}
+
+int ring_buffer::read(const int len, void *data)
+{
+    if (empty() || 0 == len)
+        return 0;
+
+    if (len < 0 || nullptr == data)
+        return CA_RET(INVALID_PARAM_VALUE);
+
+    int read_len = (len <= m_data_size) ? len : m_data_size;
+    int first_len = m_is_mirrored ? read_len : (m_total_size - m_read_pos);
+
+    if (first_len > read_len)
+        first_len = read_len;
+    memcpy(data, m_data + m_read_pos, first_len);
+    if (read_len > first_len)
+        memcpy((char *)data + first_len, m_data, read_len - first_len);
+
+    return move_read_pointer(read_len);
+}
+
+int ring_buffer::write(const int len, const void *data)
+{
+    if (full() || 0 == len)
+        return 0;
+
+    if (len < 0 || nullptr == data)
+        return CA_RET(INVALID_PARAM_VALUE);
+
+    int write_len = (len <= free_size()) ? len : free_size();
+    int write_pos = write_position();
+    int first_len = m_is_mirrored ? write_len : (m_total_size - write_pos);
+
+    if (first_len > write_len)
+        first_len = write_len;
+    memcpy(m_data + write_pos, data, first_len);
+    if (write_len > first_len)
+        memcpy(m_data, (const char *)data + first_len, write_len - first_len);
+
+    return move_write_pointer(write_len);
+}
+
+void *ring_buffer::get_read_pointer(void) const
+{
+    if (nullptr == m_data)
+        return nullptr;
+
+    return m_data + m_read_pos;
+}
+
+int ring_buffer::move_read_pointer(const int offset)
+{
+    if (offset <= 0 ||
+        nullptr == m_data)
+        return 0;
+
+    int distance = (offset <= m_data_size) ? offset : m_data_size;
+
+    m_read_pos += distance;
+    if (m_read_pos >= m_total_size)
+        m_read_pos -= m_total_size;
+    m_data_size -= distance;
+    if (0 == m_data_size)
+        m_read_pos = 0; // not a must, but makes free space contiguous as much as possible
+
+    return distance;
+}
+
+void *ring_buffer::get_write_pointer(void) const
+{
+    if (nullptr == m_data)
+        return nullptr;
+
+    return m_data + write_position();
+}
+
+int ring_buffer::move_write_pointer(const int offset)
+{
+    if (offset <= 0 ||
+        nullptr == m_data)
+        return 0;
+
+    int free_len = free_size();
+    int distance = (offset <= free_len) ? offset : free_len;
+
+    m_data_size += distance;
+
+    return distance;
+}
+
+int ring_buffer::get_data_regions(struct iovec iov[2]) const
+{
+    if (nullptr == iov || empty())
+        return 0;
+
+    int first_len = contiguous_data_size();
+
+    iov[0].iov_base = m_data + m_read_pos;
+    iov[0].iov_len = first_len;
+    if (first_len >= m_data_size)
+        return 1;
+
+    iov[1].iov_base = m_data;
+    iov[1].iov_len = m_data_size - first_len;
+
+    return 2;
+}
+
+int ring_buffer::get_free_regions(struct iovec iov[2]) const
+{
+    if (nullptr == iov || nullptr == m_data || full())
+        return 0;
+
+    int free_len = free_size();
+    int first_len = contiguous_free_size();
+
+    iov[0].iov_base = m_data + write_position();
+    iov[0].iov_len = first_len;
+    if (first_len >= free_len)
+        return 1;
+
+    iov[1].iov_base = m_data;
+    iov[1].iov_len = free_len - first_len;
+
+    return 2;
+}
+
+void ring_buffer::reset(void)
+{
+    m_read_pos = 0;
+    m_data_size = 0;
+}
+
+int ring_buffer::create_mirrored(int size)
+{
+    long page_size = sysconf(_SC_PAGESIZE);
+
+    if (page_size <= 0)
+        page_size = 4096;
+    size = (int)(((size + page_size - 1) / page_size) * page_size);
+
+    int ret = CA_RET_GENERAL_FAILURE;
+    char *addr = (char *)MAP_FAILED;
+    int fd = memfd_create("ca_ring_buffer", MFD_CLOEXEC);
+
+    if (fd < 0)
+    {
+        ret = -errno;
+        cerror("memfd_create() failed\n");
+        goto CREATE_FAILED;
+    }
+
+    if (ftruncate(fd, size) < 0)
+    {
+        ret = -errno;
+        cerror("ftruncate() failed\n");
+        goto CREATE_FAILED;
+    }
+
+    // Reserves address space of double size first, then maps the same file onto both halves.
+    addr = (char *)mmap(nullptr, size * 2, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (MAP_FAILED == addr)
+    {
+        ret = -errno;
+        cerror("mmap() for reservation failed\n");
+        goto CREATE_FAILED;
+    }
+
+    if (MAP_FAILED == mmap(addr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0)
+        || MAP_FAILED == mmap(addr + size, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0))
+    {
+        ret = -errno;
+        cerror("mmap() for mirroring failed\n");
+        goto CREATE_FAILED;
+    }
+
+    close(fd); // mappings keep the memory alive
+
+    m_data = addr;
+    m_total_size = size;
+    m_read_pos = 0;
+    m_data_size = 0;
+    m_is_mirrored = true;
+
+    return CA_RET_OK;
+
+CREATE_FAILED:
+
+    if (MAP_FAILED != addr)
+        munmap(addr, size * 2);
+
+    if (fd >= 0)
+        close(fd);
+
+    return ret;
+}
+
+CA_LIB_NAMESPACE_END
@@ -28,12 +28,17 @@
 
 #include "screen_logger.h"
 
+#include <unistd.h>
+#include <sys/stat.h>
+
 #include <typeinfo>
 
 CA_LIB_NAMESPACE_BEGIN
 
 
 screen_logger::screen_logger()
+    : m_is_terminal(false)
+    , m_output_is_discarded(false)
 {
     m_to_screen = true;
     set_log_name(nullptr);
@@ -53,6 +58,7 @@ screen_logger::~screen_logger()
     m_output_holder = stdout;
     m_is_open = true;
     m_cur_line = 0;
+    refresh_output_status();
 
     return CA_RET_OK;
 }
@@ -65,4 +71,27 @@ screen_logger::~screen_logger()
     return CA_RET_OK;
 }
 
+void screen_logger::refresh_output_status(void)
+{
+    m_is_terminal = (1 == isatty(STDOUT_FILENO));
+    m_uses_colors = (m_is_terminal && 1 == isatty(STDERR_FILENO));
+    m_output_is_discarded = (__is_discarded(STDOUT_FILENO) && __is_discarded(STDERR_FILENO));
+
+    if (m_output_is_discarded)
+        set_muted(true);
+}
+
+/*static */bool screen_logger::__is_discarded(int fd)
+{
+    struct stat fd_stat;
+    struct stat null_stat;
+
+    if (fstat(fd, &fd_stat) < 0)
+        return true; // closed
+
+    return (S_ISCHR(fd_stat.st_mode)
+        && 0 == stat("/dev/null", &null_stat)
+        && fd_stat.st_rdev == null_stat.st_rdev);
+}
+
 CA_LIB_NAMESPACE_END
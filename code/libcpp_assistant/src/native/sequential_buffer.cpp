@@ -77,6 +77,30 @@ int sequential_buffer::create(int size)
     return innerly_create(size);
 }
 
+int sequential_buffer::create_growable(int initial_size, int max_size)
+{
+    if (nullptr != m_data)
+        return CA_RET(OBJECT_ALREADY_EXISTS);
+
+    if (initial_size < 0 || max_size <= 0)
+        return CA_RET(INVALID_PARAM_VALUE);
+
+    if (max_size < MIN_BUF_SIZE)
+        max_size = MIN_BUF_SIZE;
+    if (initial_size > max_size)
+        initial_size = max_size;
+
+    int ret = (initial_size > 0) ? innerly_create(initial_size) : CA_RET_OK;
+
+    if (CA_RET_OK != ret)
+        return ret;
+
+    m_max_size = max_size;
+    m_is_growable = true;
+
+    return CA_RET_OK;
+}
+
 void sequential_buffer::destroy(void)
 {
     clear();
@@ -109,6 +133,8 @@ int sequential_buffer::resize(int new_size)
     m_total_size = new_size;
     m_read_pos = 0;
     m_write_pos = data_size;
+    if (!m_is_growable || new_size > m_max_size)
+        m_max_size = new_size;
 
     return new_size;
 }
@@ -144,6 +170,9 @@ int sequential_buffer::write(const int len, const void *data)
     if (len < 0 || nullptr == data)
         return CA_RET(INVALID_PARAM_VALUE);
 
+    if (m_is_growable && free_size() < len && reserve(len) < 0)
+        return CA_RET(MEMORY_ALLOC_FAILED);
+
     int available_len = this->free_size();
     int write_len = (len <= available_len) ? len : available_len;
     int pos_limit = this->total_size();
@@ -280,6 +309,60 @@ int sequential_buffer::move_data_to_header(void)
     return bytes_to_move;
 }
 
+int sequential_buffer::reserve(int len)
+{
+    if (len < 0)
+        return CA_RET(INVALID_PARAM_VALUE);
+
+    if (nullptr != m_data && has_overflown_pointer())
+        move_data_to_header();
+
+    int tail_free_len = (nullptr == m_data || OVERFLOW_POS == m_write_pos) ? 0 : (total_size() - m_write_pos);
+
+    if (tail_free_len >= len)
+        return tail_free_len;
+
+    if (free_size() >= len || !m_is_growable || m_total_size >= m_max_size)
+    {
+        if (nullptr != m_data && m_read_pos > 0)
+            move_data_to_header();
+
+        return (nullptr == m_data || OVERFLOW_POS == m_write_pos) ? 0 : (total_size() - m_write_pos);
+    }
+
+    // Grows by doubling, so that a stream of small writes does not cause lots of reallocation.
+    int needed_size = data_size() + len;
+    int new_size = (m_total_size > 0) ? m_total_size : MIN_BUF_SIZE;
+
+    while (new_size < needed_size && new_size < m_max_size)
+        new_size *= 2;
+    if (new_size > m_max_size)
+        new_size = m_max_size;
+
+    int ret = resize(new_size);
+
+    if (ret < 0)
+        return ret;
+
+    return (OVERFLOW_POS == m_write_pos) ? 0 : (total_size() - m_write_pos);
+}
+
+int sequential_buffer::release_memory(void)
+{
+    if (!m_is_growable || nullptr == m_data || !empty())
+        return 0;
+
+    int released_size = m_total_size;
+
+    free(m_data);
+    m_data = nullptr;
+    m_total_size = 0;
+    m_read_pos = 0;
+    m_write_pos = 0;
+
+    return released_size;
+}
+
 void sequential_buffer::reset(bool zero_all_data/* = false*/)
 {
     m_write_pos = 0;
@@ -305,6 +388,8 @@ int sequential_buffer::innerly_create(int size)
         return CA_RET(MEMORY_ALLOC_FAILED);
 
     m_total_size = size;
+    m_max_size = size;
+    m_is_growable = false;
 
     return CA_RET_OK;
 }
@@ -316,11 +401,14 @@ int sequential_buffer::copy_from(const sequential_buffer& src)
     if (size_changed)
         clear();
 
-    int ret = size_changed ? innerly_create(src.total_size()) : CA_RET_OK;
+    int ret = (size_changed && src.total_size() > 0) ? innerly_create(src.total_size()) : CA_RET_OK;
 
     if (CA_RET_OK != ret)
         return ret;
 
+    m_max_size = src.m_max_size;
+    m_is_growable = src.m_is_growable;
+
     m_write_pos = src.m_write_pos;
     m_read_pos = src.m_read_pos;
 
@@ -339,6 +427,8 @@ void sequential_buffer::init(void)
     m_total_size = 0;
     m_read_pos = 0;
     m_write_pos = 0;
+    m_max_size = 0;
+    m_is_growable = false;
 }
 
 void sequential_buffer::clear(void)
@@ -351,6 +441,8 @@ void sequential_buffer::clear(void)
     m_total_size = 0;
     m_read_pos = 0;
     m_write_pos = 0;
+    m_max_size = 0;
+    m_is_growable = false;
 }
 
 CA_LIB_NAMESPACE_END
@@ -34,6 +34,8 @@
 #include <errno.h>
 #include <sys/types.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
+#include <poll.h>
 
 #include <typeinfo>
 
@@ -41,6 +43,7 @@
 #include "private/debug.h"
 #include "time_util.h"
 #include "sequential_buffer.h"
+#include "ring_buffer.h"
 
 CA_LIB_NAMESPACE_BEGIN
 
@@ -122,6 +125,134 @@ CA_REENTRANT int tcp_base::send_fragment(int fd, const void *buf, int len)
     return ret;
 }
 
+CA_REENTRANT int tcp_base::send_fragments(int fd, const struct iovec *iov, int iov_count)
+{
+    if (fd < 0 ||
+        iov_count < 0 ||
+        (nullptr == iov && iov_count > 0))
+        return CA_RET(INVALID_PARAM_VALUE);
+
+    // Segments are sent in groups, and what is partially sent stays at the head of a group.
+    const int kMaxSegmentsPerSend = 64;
+    struct iovec pending[kMaxSegmentsPerSend];
+    int pending_count = 0;
+    int next_index = 0;
+    int ret = 0;
+
+    while (1)
+    {
+        while (pending_count < kMaxSegmentsPerSend && next_index < iov_count)
+        {
+            if (iov[next_index].iov_len > 0 && nullptr != iov[next_index].iov_base)
+                pending[pending_count++] = iov[next_index];
+            ++next_index;
+        }
+
+        if (0 == pending_count)
+            break;
+
+        struct msghdr msg;
+
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = pending;
+        msg.msg_iovlen = pending_count;
+
+        ssize_t slen = sendmsg(fd, &msg, 0);
+
+        if (slen < 0)
+        {
+            int err = errno;
+
+            if (EINTR == err)
+                continue;
+            else if (EAGAIN == err || EWOULDBLOCK == err)
+                break;
+            else
+            {
+                ret = -err;
+                break;
+            }
+        }
+
+        ret += slen;
+
+        int sent_count = 0;
+
+        while (sent_count < pending_count && (size_t)slen >= pending[sent_count].iov_len)
+        {
+            slen -= pending[sent_count].iov_len;
+            ++sent_count;
+        }
+        if (sent_count < pending_count)
+        {
+            pending[sent_count].iov_base = (char *)(pending[sent_count].iov_base) + slen;
+            pending[sent_count].iov_len -= slen;
+        }
+        pending_count -= sent_count;
+        memmove(pending, pending + sent_count, pending_count * sizeof(struct iovec));
+    }
+
+    return ret;
+}
+
+CA_REENTRANT int tcp_base::send_from_ring_buffer(int fd, ring_buffer *buf)
+{
+    if (nullptr == buf)
+        return CA_RET(NULL_PARAM);
+
+    struct iovec iov[2];
+    int iov_count = buf->get_data_regions(iov);
+    int ret = send_fragments(fd, iov, iov_count);
+
+    if (ret > 0)
+        buf->move_read_pointer(ret);
+
+    return ret;
+}
+
+CA_REENTRANT int tcp_base::recv_to_ring_buffer(int fd, ring_buffer *buf)
+{
+    if (fd < 0)
+        return CA_RET(INVALID_PARAM_VALUE);
+
+    if (nullptr == buf)
+        return CA_RET(NULL_PARAM);
+
+    struct iovec iov[2];
+    int iov_count = buf->get_free_regions(iov);
+
+    if (iov_count <= 0)
+        return CA_RET(SPACE_NOT_ENOUGH);
+
+    int ret = 0;
+
+    while (1)
+    {
+        ssize_t rlen = readv(fd, iov, iov_count);
+
+        if (0 == rlen)
+        {
+            ret = CA_RET(CONNECTION_BROKEN);
+            break;
+        }
+        else if (rlen < 0)
+        {
+            int err = errno;
+
+            if (EINTR == err)
+                continue;
+            else if (EAGAIN != err && EWOULDBLOCK != err)
+                ret = -err;
+            break;
+        }
+
+        ret = buf->move_write_pointer((int)rlen);
+        break;
+    }
+
+    return ret;
+}
+
 CA_REENTRANT int tcp_base::recv_fragment(int fd, void *buf, int len)
 {
     if (fd < 0 ||
@@ -178,37 +309,223 @@ CA_REENTRANT int tcp_base::send_from_connection(net_connection *conn)
 
     int status = conn->conn_status;
 
-    if ((0 == (CONN_STATUS_CONNECTED & status)) ||
+    if (0 != (CONN_STATUS_CONNECTING & status))
+        return CA_RET(CONNECTION_NOT_READY);
+    else if ((0 == (CONN_STATUS_CONNECTED & status)) ||
         (0 != (CONN_STATUS_DISCONNECTED & status)) ||
         (0 != (CONN_STATUS_DISCONNECTING & status)))
+    {
+        unmark_send_pending(*conn); // nothing can be sent any more
         return CA_RET(CONNECTION_BROKEN);
-    else if (0 != (CONN_STATUS_CONNECTING & status))
-        return CA_RET(CONNECTION_NOT_READY);
+    }
 
-    void *data = buf->get_read_pointer();
+    int data_len = buf->data_size();
 
-    if (seqbuf::OVERFLOW_PTR == data)
-        return CA_RET(POINTER_OUT_OF_BOUND);
+    if (data_len <= 0 && nullptr == conn->send_queue_head)
+    {
+        unmark_send_pending(*conn);
+        return 0; // a growable buffer may have no memory at all then
+    }
 
-    int data_len = buf->data_size();
+    void *data = nullptr;
 
-    if (data_len <= 0)
-        return 0;
+    if (data_len > 0 && seqbuf::OVERFLOW_PTR == (data = buf->get_read_pointer()))
+        return CA_RET(POINTER_OUT_OF_BOUND);
 
-    int ret = send_fragment(conn->fd, data, data_len);
+    int ret = 0;
+
+    if (nullptr == conn->send_queue_head)
+        ret = send_fragment(conn->fd, data, data_len);
+    else
+    {
+        // Spans of send_buf and packets in the order of the queue, then the rest of send_buf.
+        // What does not fit is left to the next call.
+        const int kMaxFragmentsPerSend = 64;
+        struct iovec iov[kMaxFragmentsPerSend];
+        int iov_count = 0;
+        int buf_offset = 0;
+        send_queue_node *node = conn->send_queue_head;
+
+        for (; nullptr != node && iov_count < kMaxFragmentsPerSend; node = node->next)
+        {
+            if (nullptr == node->packet)
+            {
+                iov[iov_count].iov_base = (char *)data + buf_offset;
+                iov[iov_count++].iov_len = node->buf_len;
+                buf_offset += node->buf_len;
+            }
+            else
+            {
+                iov[iov_count].iov_base = node->packet->data + node->offset;
+                iov[iov_count++].iov_len = node->packet->len - node->offset;
+            }
+        }
+        if (nullptr == node && data_len > buf_offset && iov_count < kMaxFragmentsPerSend)
+        {
+            iov[iov_count].iov_base = (char *)data + buf_offset;
+            iov[iov_count++].iov_len = data_len - buf_offset;
+        }
+        ret = send_fragments(conn->fd, iov, iov_count);
+    }
 
     if (CA_RET(CONNECTION_BROKEN) == ret)
         conn->conn_status = CONN_STATUS_BROKEN;
 
     if (ret > 0)
     {
-        buf->move_read_pointer(ret);
+        if (nullptr == conn->send_queue_head)
+            buf->move_read_pointer(ret);
+        else
+            consume_send_queue(*conn, ret);
         conn->last_op_time = time_util::get_utc_microseconds();
     }
 
+    if (ret >= 0 && has_data_to_send(conn))
+        mark_send_pending(*conn);
+    else
+        unmark_send_pending(*conn);
+
     return ret;
 }
 
+CA_REENTRANT int tcp_base::send_to_connection(net_connection *conn, const void *data, int len)
+{
+    if (nullptr == conn)
+        return CA_RET(NULL_PARAM);
+
+    if (len < 0 || (nullptr == data && len > 0))
+        return CA_RET(INVALID_PARAM_VALUE);
+
+    buffer *buf = conn->send_buf;
+
+    if (nullptr == buf)
+        return CA_RET(RESOURCE_NOT_AVAILABLE);
+
+    int status = conn->conn_status;
+    // A connection still connecting is corked, see tcp_client::start_connecting().
+    bool is_connecting = (0 != (CONN_STATUS_CONNECTING & status));
+
+    if (is_connecting && !(conn->is_corked))
+        return CA_RET(CONNECTION_NOT_READY);
+    else if (!is_connecting && ((0 == (CONN_STATUS_CONNECTED & status)) ||
+        (0 != (CONN_STATUS_DISCONNECTED & status)) ||
+        (0 != (CONN_STATUS_DISCONNECTING & status))))
+        return CA_RET(CONNECTION_BROKEN);
+
+    if (0 == len)
+        return 0;
+
+    // Makes sure that what can not be sent can be buffered, or the stream will be broken.
+    // A corked connection is flushed too in this case.
+    // NOTE: max_size() is the same as total_size() unless the buffer is growable.
+    int ret = 0;
+
+    if (buf->max_size() - buf->data_size() < len && !(buf->empty()) && (ret = send_from_connection(conn)) < 0)
+        return ret;
+    if (buf->max_size() - buf->data_size() < len)
+        return CA_RET(SPACE_NOT_ENOUGH);
+
+    // Data must not overtake packets queued before it, and the rest of send_buf is sent after them.
+    if (conn->is_corked || nullptr != conn->send_queue_head)
+    {
+        if ((ret = buf->write(len, data)) > 0)
+            mark_send_pending(*conn);
+
+        return ret;
+    }
+
+    int pending_len = buf->data_size();
+    void *pending_data = nullptr;
+
+    if (pending_len > 0 && seqbuf::OVERFLOW_PTR == (pending_data = buf->get_read_pointer()))
+        return CA_RET(POINTER_OUT_OF_BOUND);
+
+    struct iovec iov[2] = {
+        { pending_data, (size_t)pending_len },
+        { const_cast<void *>(data), (size_t)len }
+    };
+    ret = send_fragments(conn->fd, iov, 2);
+
+    if (CA_RET(CONNECTION_BROKEN) == ret)
+        conn->conn_status = CONN_STATUS_BROKEN;
+
+    if (ret < 0)
+        return ret;
+
+    if (ret > 0)
+        conn->last_op_time = time_util::get_utc_microseconds();
+
+    int pending_sent_len = (ret < pending_len) ? ret : pending_len;
+    int data_sent_len = ret - pending_sent_len;
+
+    if (pending_sent_len > 0)
+        buf->move_read_pointer(pending_sent_len);
+    if (data_sent_len >= len)
+        return len;
+
+    // Space has been checked above, so only a failed growth of the buffer gets here.
+    int buffered_len = buf->write(len - data_sent_len, (const char *)data + data_sent_len);
+
+    if (buffered_len < 0)
+    {
+        // The head of the data is on the wire already, and the stream can not be continued without its tail.
+        if (data_sent_len > 0)
+            conn->conn_status = CONN_STATUS_BROKEN;
+
+        return buffered_len;
+    }
+
+    if (buffered_len > 0)
+        mark_send_pending(*conn);
+
+    return data_sent_len + buffered_len;
+}
+
+CA_REENTRANT int tcp_base::enqueue_to_connection(net_connection *conn, shared_packet *packet)
+{
+    if (nullptr == conn || nullptr == packet)
+        return CA_RET(NULL_PARAM);
+
+    int status = conn->conn_status;
+
+    // Packets queued while connecting are sent once connected, like those held by a corked connection.
+    if (0 == (CONN_STATUS_CONNECTING & status) &&
+        ((0 == (CONN_STATUS_CONNECTED & status)) ||
+        (0 != (CONN_STATUS_DISCONNECTED & status)) ||
+        (0 != (CONN_STATUS_DISCONNECTING & status))))
+        return CA_RET(CONNECTION_BROKEN);
+
+    if (conn->queued_bytes > MAX_QUEUED_BYTES - packet->len)
+        return CA_RET(SPACE_NOT_ENOUGH);
+
+    int ret = push_send_queue(*conn, packet);
+
+    if (ret < 0)
+        return ret;
+
+    mark_send_pending(*conn);
+
+    return packet->len;
+}
+
+CA_REENTRANT bool tcp_base::has_data_to_send(const net_connection *conn)
+{
+    if (nullptr == conn)
+        return false;
+
+    return (nullptr != conn->send_queue_head) || (nullptr != conn->send_buf && !(conn->send_buf->empty()));
+}
+
+CA_REENTRANT int tcp_base::uncork_connection(net_connection *conn)
+{
+    if (nullptr == conn)
+        return CA_RET(NULL_PARAM);
+
+    conn->is_corked = false;
+
+    return send_from_connection(conn);
+}
+
 CA_REENTRANT int tcp_base::recv_to_connection(net_connection *conn)
 {
     if (nullptr == conn)
@@ -221,12 +538,17 @@ CA_REENTRANT int tcp_base::recv_to_connection(net_connection *conn)
 
     int status = conn->conn_status;
 
-    if ((0 == (CONN_STATUS_CONNECTED & status)) ||
+    if (0 != (CONN_STATUS_CONNECTING & status))
+        return CA_RET(CONNECTION_NOT_READY);
+    else if ((0 == (CONN_STATUS_CONNECTED & status)) ||
         (0 != (CONN_STATUS_DISCONNECTED & status)) ||
         (0 != (CONN_STATUS_DISCONNECTING & status)))
         return CA_RET(CONNECTION_BROKEN);
-    else if (0 != (CONN_STATUS_CONNECTING & status))
-        return CA_RET(CONNECTION_NOT_READY);
+
+    int ret = 0;
+
+    if (buf->is_growable() && (ret = buf->reserve(buffer::MIN_BUF_SIZE)) < 0)
+        return ret;
 
     void* write_ptr = buf->get_write_pointer();
     int available_len = buf->total_size() - buf->write_position();
@@ -237,7 +559,7 @@ CA_REENTRANT int tcp_base::recv_to_connection(net_connection *conn)
     if (available_len <= 0)
         return CA_RET(SPACE_NOT_ENOUGH);
 
-    int ret = recv_fragment(conn->fd, write_ptr, available_len);
+    ret = recv_fragment(conn->fd, write_ptr, available_len);
 
     if (CA_RET(CONNECTION_BROKEN) == ret)
         conn->conn_status = CONN_STATUS_BROKEN;
@@ -251,6 +573,77 @@ CA_REENTRANT int tcp_base::recv_to_connection(net_connection *conn)
     return ret;
 }
 
+CA_REENTRANT int tcp_base::drain_to_connection(net_connection *conn)
+{
+    if (nullptr == conn)
+        return CA_RET(NULL_PARAM);
+
+    buffer *buf = conn->recv_buf;
+
+    if (nullptr == buf)
+        return CA_RET(RESOURCE_NOT_AVAILABLE);
+
+    int status = conn->conn_status;
+
+    if (0 != (CONN_STATUS_CONNECTING & status))
+        return CA_RET(CONNECTION_NOT_READY);
+    else if ((0 == (CONN_STATUS_CONNECTED & status)) ||
+        (0 != (CONN_STATUS_DISCONNECTED & status)) ||
+        (0 != (CONN_STATUS_DISCONNECTING & status)))
+        return CA_RET(CONNECTION_BROKEN);
+
+    int total_len = 0;
+
+    conn->is_still_readable = false;
+
+    while (1)
+    {
+        if (buf->is_growable() && buf->reserve(buffer::MIN_BUF_SIZE) < 0)
+            return CA_RET(MEMORY_ALLOC_FAILED);
+
+        if (buf->full())
+        {
+            conn->is_still_readable = true;
+            break;
+        }
+
+        // Makes use of the space before the read pointer.
+        if (buf->read_position() > 0
+            && buf->write_position() >= buf->total_size() - buf->read_position())
+            buf->move_data_to_header();
+
+        void* write_ptr = buf->get_write_pointer();
+        int available_len = buf->total_size() - buf->write_position();
+
+        if (seqbuf::OVERFLOW_PTR == write_ptr || available_len > buf->total_size())
+            return CA_RET(POINTER_OUT_OF_BOUND);
+
+        int ret = recv_fragment(conn->fd, write_ptr, available_len);
+
+        if (ret < 0)
+        {
+            if (CA_RET(CONNECTION_BROKEN) == ret)
+                conn->conn_status = CONN_STATUS_BROKEN;
+
+            return ret;
+        }
+
+        if (ret > 0)
+        {
+            buf->move_write_pointer(ret);
+            total_len += ret;
+        }
+
+        if (ret < available_len) // EAGAIN, drained
+            break;
+    }
+
+    if (total_len > 0)
+        conn->last_op_time = time_util::get_utc_microseconds();
+
+    return total_len;
+}
+
 int tcp_base::send_from_connection(int fd)
 {
     net_connection *conn = find_peer(fd);
@@ -271,6 +664,84 @@ int tcp_base::recv_to_connection(int fd)
     return recv_to_connection(conn);
 }
 
+int tcp_base::drain_to_connection(int fd)
+{
+    net_connection *conn = find_peer(fd);
+
+    if (nullptr == conn)
+        return CA_RET(OBJECT_DOES_NOT_EXIST);
+
+    return drain_to_connection(conn);
+}
+
+int tcp_base::rearm_connection(net_connection *conn)
+{
+    if (nullptr == conn)
+        return CA_RET(NULL_PARAM);
+
+    if (!m_is_edge_triggered)
+        return CA_RET_OK;
+
+    // EPOLL_CTL_MOD re-checks the readiness, and a new event is queued if there is still data.
+    return m_poller->modify_monitored_connection(conn, monitored_events());
+}
+
+int tcp_base::release_idle_buffers(int64_t idle_usec)
+{
+    if (nullptr == m_peers)
+        return 0;
+
+    int64_t threshold = time_util::get_utc_microseconds() - idle_usec;
+    int released_size = 0;
+
+    for (connection_map::iterator it = m_peers->begin(); it != m_peers->end(); ++it)
+    {
+        net_connection *conn = it->second;
+
+        if (nullptr == conn || conn->last_op_time > threshold)
+            continue;
+
+        if (nullptr != conn->send_buf)
+            released_size += conn->send_buf->release_memory();
+        if (nullptr != conn->recv_buf)
+            released_size += conn->recv_buf->release_memory();
+    }
+
+    return released_size;
+}
+
+int tcp_base::set_edge_triggered(bool enabled)
+{
+    if (enabled == m_is_edge_triggered)
+        return CA_RET_OK;
+
+    m_is_edge_triggered = enabled;
+
+    if (nullptr == m_peers || nullptr == m_poller)
+        return CA_RET_OK;
+
+    int events = monitored_events();
+    int ret = CA_RET_OK;
+
+    for (connection_map::iterator it = m_peers->begin(); it != m_peers->end(); ++it)
+    {
+        net_connection *conn = it->second;
+
+        if (nullptr == conn)
+            continue;
+
+        int mod_ret = m_poller->modify_monitored_connection(conn, events);
+
+        if (mod_ret < 0)
+        {
+            cerror("failed to switch monitoring mode of connection[%d], ret = %d\n", conn->fd, mod_ret);
+            ret = mod_ret;
+        }
+    }
+
+    return ret;
+}
+
 /*virtual */void tcp_base::has_what(std::string *result_holder/* = nullptr */, format_output_func logger/* = nullptr */)
 {
     net_connection *conn = nullptr;
@@ -329,6 +800,33 @@ int tcp_base::recv_to_connection(int fd)
     }
 }
 
+void tcp_base::log_connections(logger &target, enum_log_level log_level/* = LOG_LEVEL_INFO */)
+{
+    target.kv(log_level, "connections", "type", desc_of_connection_type(m_connection_type),
+        "count", (nullptr == m_peers) ? 0 : (int)m_peers->size());
+    if (nullptr == m_peers)
+        return;
+
+    for (connection_map::iterator it = m_peers->begin(); it != m_peers->end(); ++it)
+    {
+        net_connection *conn = it->second;
+
+        if (nullptr == conn)
+        {
+            target.kv(log_level, "null connection", "key", it->first);
+            continue;
+        }
+
+        target.kv(log_level, "connection", "fd", conn->fd,
+            "self_ip", conn->self_ip, "self_port", conn->self_port, "self_name", conn->self_name,
+            "peer_ip", conn->peer_ip, "peer_port", conn->peer_port, "peer_name", conn->peer_name,
+            "status", desc_of_connection_status(conn->conn_status),
+            "is_blocking", conn->is_blocking, "is_validated", conn->is_validated,
+            "send_buffer", conn->send_buf->total_size(), "recv_buffer", conn->recv_buf->total_size(),
+            "last_op_time", conn->last_op_time);
+    }
+}
+
 net_connection *tcp_base::find_peer(int fd)
 {
     if (nullptr == m_peers)
@@ -377,22 +875,28 @@ int tcp_base::poll(void)
     m_peers = nullptr;
     m_max_peer_count = max_peer_count;
     m_poller = nullptr;
+    m_conn_pool = nullptr;
     m_timeout = timeout;
+    m_is_edge_triggered = false;
+    m_send_pending.head = nullptr;
+    m_send_pending.count = 0;
 
     try
     {
         m_peers = new connection_map;
         m_poller = new net_poller(m_max_peer_count, m_timeout);
+        m_conn_pool = new connection_pool;
     }
     catch (std::bad_alloc& e)
     {
-        cerror("exception caught during new() for connection map or poller: %s\n", e.what());
+        cerror("exception caught during new() for connection map, poller or pool: %s\n", e.what());
         ret = CA_RET(MEMORY_ALLOC_FAILED);
         goto INIT_FAILED;
     }
 
     if (nullptr == m_peers ||
-        nullptr == m_poller)
+        nullptr == m_poller ||
+        nullptr == m_conn_pool)
     {
         ret = CA_RET(MEMORY_ALLOC_FAILED);
         goto INIT_FAILED;
@@ -400,6 +904,7 @@ int tcp_base::poll(void)
 
     m_max_peer_count = m_poller->max_connection_count();
     m_timeout = m_poller->timeout();
+    m_peers->reserve(m_max_peer_count);
 
     return CA_RET_OK;
 
@@ -416,10 +921,15 @@ INIT_FAILED:
     m_connection_type = CONN_TYPE_NONE;
     if (nullptr != m_peers)
     {
-        //for (connection_map::iterator it = m_peers->begin(); it != m_peers->end(); ++it)
-        for (connection_map::iterator it = m_peers->begin(); it != m_peers->end();  )
+        // Erasure within delete_connection() moves elements, so always takes the last one.
+        while (!m_peers->empty())
         {
-            delete_connection((it++)->second); // erase() within this function may affect increment of it !!
+            int fd = (m_peers->end() - 1)->first;
+            net_connection *conn = (m_peers->end() - 1)->second;
+
+            if (nullptr != conn)
+                delete_connection(conn);
+            m_peers->erase(fd); // in case that it's a null connection
         }
         m_peers->clear();
         delete m_peers;
@@ -433,7 +943,15 @@ INIT_FAILED:
         m_poller = nullptr;
         //cdebug("%s m_poller released\n", typeid(*this).name());
     }
+    if (nullptr != m_conn_pool) // after all peers released
+    {
+        delete m_conn_pool;
+        m_conn_pool = nullptr;
+    }
     m_timeout = 0;
+    m_is_edge_triggered = false;
+    m_send_pending.head = nullptr; // all peers have left it on release
+    m_send_pending.count = 0;
 }
 
 int tcp_base::add_connection(net_connection *conn)
@@ -443,9 +961,13 @@ int tcp_base::add_connection(net_connection *conn)
 
     connection_map::iterator it = m_peers->find(conn->fd);
 
+    conn->pending_list = &m_send_pending;
+    if (has_data_to_send(conn))
+        mark_send_pending(*conn);
+
     if (m_peers->end() == it)
     {
-        if (m_peers->insert(std::make_pair(conn->fd, conn)).second) // (1) insertion for new connections
+        if (m_peers->insert(conn->fd, conn).second) // (1) insertion for new connections
             return CA_RET_OK;
         else
             return CA_RET(INNER_DATA_STRUCT_ERROR);
@@ -464,7 +986,7 @@ int tcp_base::add_connection(net_connection *conn)
     if (CONN_STATUS_BROKEN != status && CONN_STATUS_DISCONNECTED != status)
         return CA_RET(OBJECT_ALREADY_EXISTS);
 
-    destroy_net_connection(&conn_found);
+    m_conn_pool->release(conn_found);
 
     it->second = conn; // (2) replacement for re-connections
 
@@ -489,7 +1011,7 @@ int tcp_base::delete_connection(net_connection *conn, bool delete_peer_node_now/
 
     if (nullptr == cur_conn)
     {
-        m_peers->erase(it);
+        m_peers->erase(fd);
         cdebug("a null connection with fd = %d erased from map\n", fd);
         return CA_RET_OK;
     }
@@ -497,10 +1019,10 @@ int tcp_base::delete_connection(net_connection *conn, bool delete_peer_node_now/
     if (nullptr != m_poller)
         m_poller->delete_monitored_connection(conn); // do not forget to delete monitored event
 
-    destroy_net_connection(&cur_conn);
+    m_conn_pool->release(cur_conn);
     cdebug("node of connection with fd = %d released\n", fd);
 
-    m_peers->erase(it);
+    m_peers->erase(fd);
     cdebug("connection with fd = %d erased from map\n", fd);
 
     return CA_RET_OK;
@@ -508,57 +1030,83 @@ int tcp_base::delete_connection(net_connection *conn, bool delete_peer_node_now/
 
 CA_REENTRANT bool tcp_base::is_ready(int fd, enum_check_operation check_type, int timeout_usec)
 {
-    if (fd < 0 || timeout_usec < 0)
+    bool result = false;
+
+    return (1 == are_ready(&fd, 1, check_type, &result, timeout_usec)) && result;
+}
+
+CA_REENTRANT int tcp_base::are_ready(const int *fds, int fd_count, enum_check_operation check_type,
+    bool *results, int timeout_usec)
+{
+    if (nullptr == fds || nullptr == results || fd_count <= 0 || timeout_usec < 0)
     {
         nserror(tcp_base, "invalid params\n");
-        return false;
+        return CA_RET(INVALID_PARAM_VALUE);
     }
 
-    struct timeval tv;
-    fd_set fdset;
-    int ret = -1;
-
-    tv.tv_sec = timeout_usec / 1000000;
-    tv.tv_usec = timeout_usec % 1000000;
+    // poll() works with any fd number, unlike select() whose fd_set holds FD_SETSIZE(1024) fds at most.
+    const short kEvents = (CHK_OP_READABLE == check_type) ? POLLIN
+        : ((CHK_OP_WRITEABLE == check_type) ? POLLOUT : POLLPRI);
+    struct pollfd fixed_items[16];
+    std::vector<struct pollfd> extra_items;
+    struct pollfd *items = fixed_items;
 
-    FD_ZERO(&fdset);
-    FD_SET(fd, &fdset);
-
-    if (CHK_OP_READABLE == check_type)
-        ret = select(fd + 1, &fdset, nullptr, nullptr, &tv);
-    else if (CHK_OP_WRITEABLE == check_type)
-        ret = select(fd + 1, nullptr, &fdset, nullptr, &tv);
-    else
-        ret = select(fd + 1, nullptr, nullptr, &fdset, &tv);
+    if (fd_count > (int)(sizeof(fixed_items) / sizeof(fixed_items[0])))
+    {
+        extra_items.resize(fd_count);
+        items = &(extra_items[0]);
+    }
 
-    if (ret <= 0 ||
-        !FD_ISSET(fd, &fdset))
+    for (int i = 0; i < fd_count; ++i)
     {
-        nserror(tcp_base, "select() failed, errno = %d\n", errno);
-        return false;
+        items[i].fd = fds[i]; // a negative one is ignored by poll()
+        items[i].events = kEvents;
+        items[i].revents = 0;
+        results[i] = false;
     }
 
-    /*
-     * fd is readable or writable or both in some conditions, say, during connect(),
-     * therefore, getsockopt() is called to determine if there is an error occurring on
-     * the specified fd.
-     */
-    int err = 0;
-    socklen_t errlen = sizeof(err);
+    // rounded up, or a short timeout turns into a busy check
+    int ret = ::poll(items, fd_count, (timeout_usec + 999) / 1000);
 
-    if (getsockopt(fd, SOL_SOCKET, SO_ERROR, &err, &errlen) < 0)
+    if (ret < 0)
     {
-        nserror(tcp_base, "getsockopt() failed, errno = %d\n", errno);
-        return false;
+        ret = -errno;
+        nserror(tcp_base, "poll() failed, errno = %d\n", -ret);
+        return ret;
     }
 
-    if (err)
+    int ready_count = 0;
+
+    for (int i = 0; i < fd_count && ret > 0; ++i)
     {
-        nserror(tcp_base, "error occurred on sock fd, errno = %d\n", err);
-        return false;
+        if (0 == items[i].revents || 0 != (POLLNVAL & items[i].revents))
+            continue;
+
+        /*
+         * fd is readable or writable or both in some conditions, say, during connect(),
+         * therefore, getsockopt() is called to determine if there is an error occurring on
+         * the specified fd.
+         */
+        int err = 0;
+        socklen_t errlen = sizeof(err);
+
+        if (getsockopt(items[i].fd, SOL_SOCKET, SO_ERROR, &err, &errlen) < 0)
+        {
+            nserror(tcp_base, "getsockopt() failed, errno = %d\n", errno);
+            continue;
+        }
+
+        if (err)
+        {
+            nserror(tcp_base, "error occurred on sock fd, errno = %d\n", err);
+            continue;
+        }
+
+        results[i] = true;
+        ++ready_count;
     }
 
-    return true;
+    return ready_count;
 }
 
 CA_LIB_NAMESPACE_END
@@ -36,6 +36,7 @@
 #include <unistd.h>
 
 #include "base/ca_return_code.h"
+#include "time_util.h"
 #include "private/debug.h"
 
 CA_LIB_NAMESPACE_BEGIN
@@ -65,14 +66,109 @@ int tcp_client::connect_server(const char *ip,
     int send_buf_size,
     int recv_buf_size,
     bool is_nonblocking/* = true*/)
+{
+    return do_connect(ip, port, send_buf_size, recv_buf_size, is_nonblocking, true);
+}
+
+int tcp_client::start_connecting(const char *ip,
+    uint16_t port,
+    int send_buf_size,
+    int recv_buf_size)
+{
+    return do_connect(ip, port, send_buf_size, recv_buf_size, true, false);
+}
+
+int tcp_client::finish_connecting(net_connection *conn)
+{
+    if (nullptr == conn)
+        return CA_RET(NULL_PARAM);
+
+    if (CONN_STATUS_CONNECTING != conn->conn_status)
+        return (0 != (CONN_STATUS_CONNECTED & conn->conn_status)) ? CA_RET_OK : CA_RET(CONNECTION_BROKEN);
+
+    int err = 0;
+    socklen_t err_len = sizeof(err);
+    int ret = CA_RET_GENERAL_FAILURE;
+
+    if (getsockopt(conn->fd, SOL_SOCKET, SO_ERROR, &err, &err_len) < 0)
+        err = errno;
+    if (0 != err)
+    {
+        ret = -err;
+        cerror("connecting to %s:%u failed, errno = %d, reason: %s\n",
+            conn->peer_ip, conn->peer_port, err, what(ret).c_str());
+        goto CONNECT_FAILED;
+    }
+
+    if ((ret = fill_self_address(conn)) < 0)
+        goto CONNECT_FAILED;
+
+    conn->conn_status = CONN_STATUS_CONNECTED;
+    conn->last_op_time = time_util::get_utc_microseconds();
+
+    if ((ret = m_poller->modify_monitored_connection(conn, monitored_events())) < 0)
+    {
+        cerror("ModifyMonitoredConnection() failed\n");
+        goto CONNECT_FAILED;
+    }
+
+    // flushes what was sent during connecting
+    if ((ret = uncork_connection(conn)) < 0 && CA_RET(RESOURCE_NOT_AVAILABLE) != ret)
+        goto CONNECT_FAILED;
+
+    return CA_RET_OK;
+
+CONNECT_FAILED:
+
+    conn->conn_status = CONN_STATUS_BROKEN;
+
+    return ret;
+}
+
+int tcp_client::reconnect_server(const char *ip,
+    uint16_t port,
+    int send_buf_size,
+    int recv_buf_size,
+    bool is_nonblocking/* = true*/)
+{
+    if (!is_valid_ipv4(ip))
+        return CA_RET(INVALID_PARAM_VALUE);
+
+    for (connection_map::iterator it = m_peers->begin(); it != m_peers->end(); ++it)
+    {
+        net_connection *conn = it->second;
+
+        if ((0 == memcmp(ip, conn->peer_ip, sizeof(conn->peer_ip))) &&
+            (port == conn->peer_port))
+        {
+            delete_connection(conn);
+            break;
+        }
+    }
+
+    return connect_server(ip, port, send_buf_size, recv_buf_size, is_nonblocking);
+}
+
+int tcp_client::disconnect_all_servers(void)
+{
+    clear();
+
+    return CA_RET_OK;
+}
+
+int tcp_client::do_connect(const char *ip,
+    uint16_t port,
+    int send_buf_size,
+    int recv_buf_size,
+    bool is_nonblocking,
+    bool waits_for_completion)
 {
     int fd = -1;
     struct sockaddr_in server = {0};
-    struct sockaddr_in self = {0};
-    socklen_t self_len = sizeof(self);
     net_connection *conn = nullptr;
     int ret = CA_RET_GENERAL_FAILURE;
     bool ip_ok = is_valid_ipv4(ip);
+    bool is_in_progress = false;
 
     if ((fd = socket(AF_INET, SOCK_STREAM, 0)) < 0)
     {
@@ -110,8 +206,11 @@ int tcp_client::connect_server(const char *ip,
          * (1) fd is writable when connection is done and data do not arrive.
          * (2) fd is writable and readable when connection is done and data arrive.
          * (3) fd is writable and readable when an error occurs on it.
+         * Without waiting, the poller reports it in the same way, see finish_connecting().
          */
-        if (!is_writable(fd, m_timeout * 1000))
+        if (!waits_for_completion)
+            is_in_progress = true;
+        else if (!is_writable(fd, m_timeout * 1000))
         {
             cerror("IsWritable() failed\n");
             ret = CA_RET(CONNECTION_NOT_READY);
@@ -119,35 +218,37 @@ int tcp_client::connect_server(const char *ip,
         }
     }
 
-    conn = create_net_connection(send_buf_size, recv_buf_size);
+    conn = m_conn_pool->acquire(send_buf_size, recv_buf_size);
     if (nullptr == conn)
     {
-        cerror("create_net_connection() failed\n");
+        cerror("failed to acquire a connection node\n");
         ret = CA_RET(MEMORY_ALLOC_FAILED);
         goto CONNECT_FAILED;
     }
 
     strncpy(conn->self_name, self_name(), sizeof(conn->self_name) - 1);
-    getsockname(fd, (struct sockaddr *)&self, &self_len);
-    inet_ntop(AF_INET, &(self.sin_addr.s_addr), conn->self_ip, sizeof(conn->self_ip));
-    conn->self_port = ntohs(self.sin_port);
-    if ((port == conn->self_port)
-        && (0 == strncmp(ip, conn->self_ip, IPV4_LEN)))
-    {
-        cerror("TCP self-connection\n");
-        ret = CA_RET(TCP_SELF_CONNECT);
-        goto CONNECT_FAILED;
-    }
-
-    memcpy(conn->peer_ip, ip, sizeof(conn->peer_ip));
+    strncpy(conn->peer_ip, ip, sizeof(conn->peer_ip) - 1);
     conn->peer_port = port;
-
     conn->fd = fd;
-    conn->conn_status = CONN_STATUS_CONNECTED;
     conn->is_blocking = !(is_nonblocking);
     conn->is_validated = false;
 
-    if ((ret = m_poller->add_monitored_connection(conn, net_poller::EVENT_READ)) < 0)
+    if (is_in_progress)
+    {
+        // Data sent before the connection is established is held in the send buffer.
+        conn->conn_status = CONN_STATUS_CONNECTING;
+        conn->is_corked = true;
+        conn->last_op_time = time_util::get_utc_microseconds();
+    }
+    else
+    {
+        if ((ret = fill_self_address(conn)) < 0)
+            goto CONNECT_FAILED;
+        conn->conn_status = CONN_STATUS_CONNECTED;
+    }
+
+    if ((ret = m_poller->add_monitored_connection(conn,
+        is_in_progress ? (int)net_poller::EVENT_WRITE : monitored_events())) < 0)
     {
         cerror("AddMonitoredConnection() failed\n");
         goto CONNECT_FAILED;
@@ -165,41 +266,36 @@ int tcp_client::connect_server(const char *ip,
 
 CONNECT_FAILED:
 
-    delete_connection(conn);
-
-    if (fd >= 0)
-        close(fd);
-
-    return ret;
-}
-
-int tcp_client::reconnect_server(const char *ip,
-    uint16_t port,
-    int send_buf_size,
-    int recv_buf_size,
-    bool is_nonblocking/* = true*/)
-{
-    if (!is_valid_ipv4(ip))
-        return CA_RET(INVALID_PARAM_VALUE);
-
-    for (connection_map::iterator it = m_peers->begin(); it != m_peers->end(); ++it)
+    if (nullptr != conn && conn == find_peer(fd))
+        delete_connection(conn); // which closes the socket too
+    else
     {
-        net_connection *conn = it->second;
-
-        if ((0 == memcmp(ip, conn->peer_ip, sizeof(conn->peer_ip))) &&
-            (port == conn->peer_port))
+        if (nullptr != conn)
         {
-            delete_connection(conn);
-            break;
+            conn->fd = INVALID_SOCK_FD; // not to be closed twice
+            m_conn_pool->release(conn);
         }
+        if (fd >= 0)
+            close(fd);
     }
 
-    return connect_server(ip, port, send_buf_size, recv_buf_size, is_nonblocking);
+    return ret;
 }
 
-int tcp_client::disconnect_all_servers(void)
+int tcp_client::fill_self_address(net_connection *conn)
 {
-    clear();
+    struct sockaddr_in self = {0};
+    socklen_t self_len = sizeof(self);
+
+    getsockname(conn->fd, (struct sockaddr *)&self, &self_len);
+    inet_ntop(AF_INET, &(self.sin_addr.s_addr), conn->self_ip, sizeof(conn->self_ip));
+    conn->self_port = ntohs(self.sin_port);
+    if ((conn->peer_port == conn->self_port)
+        && (0 == strncmp(conn->peer_ip, conn->self_ip, IPV4_LEN)))
+    {
+        cerror("TCP self-connection\n");
+        return CA_RET(TCP_SELF_CONNECT);
+    }
 
     return CA_RET_OK;
 }
@@ -43,7 +43,9 @@ CA_LIB_NAMESPACE_BEGIN
 
 tcp_server::tcp_server()
     : tcp_base(),
-      m_listening_conn(nullptr)
+      m_listening_conn(nullptr),
+      m_reuses_port(false),
+      m_listen_backlog(DEFAULT_LISTEN_BACKLOG)
 {
     ;
 }
@@ -52,7 +54,9 @@ tcp_server::tcp_server(const char *self_name,
     int max_peer_count/* = net_poller::DEFAULT_CONNECTION_COUNT*/,
     int timeout/* = net_poller::DEFAULT_POLL_TIMEOUT*/)
     : tcp_base(self_name, max_peer_count, timeout),
-      m_listening_conn(nullptr)
+      m_listening_conn(nullptr),
+      m_reuses_port(false),
+      m_listen_backlog(DEFAULT_LISTEN_BACKLOG)
 {
     ;
 }
@@ -63,7 +67,8 @@ tcp_server::~tcp_server()
     //clear(); // Executed by base class later.
 }
 
-CA_REENTRANT bool tcp_server::can_be_listened(const char *ip, const uint16_t port)
+CA_REENTRANT bool tcp_server::can_be_listened(const char *ip, const uint16_t port,
+    int backlog/* = DEFAULT_LISTEN_BACKLOG*/)
 {
     int fd = -1;
     int reuse_addr_flag = 1;
@@ -101,7 +106,7 @@ CA_REENTRANT bool tcp_server::can_be_listened(const char *ip, const uint16_t por
         goto CHECK_FAILED;
     }
 
-    if (listen(fd, 5) < 0)
+    if (listen(fd, backlog) < 0)
     {
         nswarn(tcp_server, "listen() failed\n");
         goto CHECK_FAILED;
@@ -141,6 +146,14 @@ int tcp_server::start(const char *ip, uint16_t port)
         goto START_FAILED;
     }
 
+    if (m_reuses_port
+        && setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, (const void *)&reuse_addr_flag, sizeof(int)) < 0)
+    {
+        ret = -errno;
+        cerror("setsockopt() for SO_REUSEPORT failed\n");
+        goto START_FAILED;
+    }
+
     if ((ret = set_nonblocking(fd)) < 0)
     {
         cerror("SetNonblocking() failed\n");
@@ -161,7 +174,7 @@ int tcp_server::start(const char *ip, uint16_t port)
         goto START_FAILED;
     }
 
-    if (listen(fd, 5) < 0)
+    if (listen(fd, m_listen_backlog) < 0)
     {
         ret = -errno;
         cerror("listen() failed\n");
@@ -214,64 +227,127 @@ int tcp_server::accept_new_connection(int send_buf_size, int recv_buf_size, bool
     if (nullptr == m_listening_conn)
         return CA_RET(RESOURCE_NOT_AVAILABLE);
 
+    int accfd = accept4(m_listening_conn->fd, nullptr, nullptr,
+        is_nonblocking ? (SOCK_NONBLOCK | SOCK_CLOEXEC) : SOCK_CLOEXEC);
+
+    if (accfd < 0)
+        return -errno;
+    cdebug("accept4() ok, fd = %d\n", accfd);
+
+    return do_adopt_connection(accfd, send_buf_size, recv_buf_size, is_nonblocking, false);
+}
+
+int tcp_server::accept_new_connections(int send_buf_size, int recv_buf_size,
+    std::vector<int> *new_fds/* = nullptr*/, int max_count/* = 0*/)
+{
+    if (nullptr == m_listening_conn)
+        return CA_RET(RESOURCE_NOT_AVAILABLE);
+
+    int accepted_count = 0;
+    int ret = CA_RET_OK;
+
+    while (max_count <= 0 || accepted_count < max_count)
+    {
+        int accfd = accept4(m_listening_conn->fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+
+        if (accfd < 0)
+        {
+            int err = errno;
+
+            if (EINTR == err || ECONNABORTED == err) // the latter: reset by peer before being accepted
+                continue;
+
+            if (EAGAIN != err && EWOULDBLOCK != err)
+                ret = -err; // e.g.: EMFILE, ENFILE, ENOBUFS
+
+            break;
+        }
+        cdebug("accept4() ok, fd = %d\n", accfd);
+
+        if ((ret = do_adopt_connection(accfd, send_buf_size, recv_buf_size, true, false)) < 0)
+            break;
+
+        ++accepted_count;
+        if (nullptr != new_fds)
+            new_fds->push_back(accfd);
+    }
+
+    return (accepted_count > 0 || ret >= 0) ? accepted_count : ret;
+}
+
+int tcp_server::adopt_connection(int fd, int send_buf_size, int recv_buf_size, bool is_nonblocking/* = true*/)
+{
+    return do_adopt_connection(fd, send_buf_size, recv_buf_size, is_nonblocking, is_nonblocking);
+}
+
+int tcp_server::do_adopt_connection(int fd, int send_buf_size, int recv_buf_size,
+    bool is_nonblocking, bool sets_nonblocking)
+{
+    if (fd < 0)
+        return CA_RET(INVALID_PARAM_VALUE);
+
     struct sockaddr_in client = {0};
-    uint32_t len = sizeof(client);
+    socklen_t len = sizeof(client);
     struct sockaddr_in self = {0};
     socklen_t self_len = sizeof(self);
-    int accfd = -1;
     net_connection *conn = nullptr;
     int ret = CA_RET_GENERAL_FAILURE;
 
-    if ((accfd = accept(m_listening_conn->fd, (struct sockaddr *)&client, &len)) < 0)
-    {
-        ret = -errno;
-        goto ACCEPT_FAILED;
-    }
-    cdebug("accept() ok, fd = %d\n", accfd);
-
-    conn = create_net_connection(send_buf_size, recv_buf_size);
+    conn = m_conn_pool->acquire(send_buf_size, recv_buf_size);
     if (nullptr == conn)
     {
-        cerror("create_net_connection() failed\n");
+        cerror("failed to acquire a connection node\n");
         ret = CA_RET(MEMORY_ALLOC_FAILED);
-        goto ACCEPT_FAILED;
+        goto ADOPT_FAILED;
     }
 
-    conn->fd = accfd;
-    getsockname(accfd, (struct sockaddr *)&self, &self_len);
+    conn->fd = fd;
+    getsockname(fd, (struct sockaddr *)&self, &self_len);
     inet_ntop(AF_INET, &(self.sin_addr.s_addr), conn->self_ip, sizeof(conn->self_ip));
     conn->self_port = ntohs(self.sin_port);
+    getpeername(fd, (struct sockaddr *)&client, &len);
     inet_ntop(AF_INET, &(client.sin_addr.s_addr), conn->peer_ip, sizeof(conn->peer_ip));
     conn->peer_port = ntohs(client.sin_port);
     conn->conn_status = CONN_STATUS_CONNECTED;
     conn->is_blocking = !(is_nonblocking);
 
-    if ((ret = m_poller->add_monitored_connection(conn, net_poller::EVENT_READ)) < 0)
+    if ((ret = m_poller->add_monitored_connection(conn, monitored_events())) < 0)
     {
         cerror("AddMonitoredConnection() failed\n");
-        goto ACCEPT_FAILED;
+        goto ADOPT_FAILED;
     }
 
     if ((ret = add_connection(conn)) < 0)
     {
         cerror("AddConnection() failed\n");
-        goto ACCEPT_FAILED;
+        goto ADOPT_FAILED;
     }
 
-    if (is_nonblocking && (ret = set_nonblocking(accfd)) < 0)
+    if (sets_nonblocking && (ret = set_nonblocking(fd)) < 0)
     {
-        cerror("SetNonblocking(%d) failed: %s\n", accfd, strerror(-ret));
-        goto ACCEPT_FAILED;
+        cerror("SetNonblocking(%d) failed: %s\n", fd, strerror(-ret));
+        goto ADOPT_FAILED;
     }
 
-    return accfd;
+    if (CONN_TYPE_NONE == m_connection_type) // a reactor which is fed by others and never listens
+        m_connection_type = CONN_TYPE_SERVER;
 
-ACCEPT_FAILED:
+    return fd;
 
-    delete_connection(conn);
+ADOPT_FAILED:
 
-    if (accfd >= 0)
-        close(accfd);
+    if (nullptr != conn && conn == find_peer(fd))
+        delete_connection(conn); // which closes the socket too
+    else
+    {
+        if (nullptr != conn)
+        {
+            conn->fd = INVALID_SOCK_FD; // not to be closed twice
+            m_conn_pool->release(conn);
+        }
+        if (fd >= 0)
+            close(fd);
+    }
 
     return ret;
 }
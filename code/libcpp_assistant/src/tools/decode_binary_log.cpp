@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) 2017-2020, Wen Xiongchang <udc577 at 126 dot com>
+ * All rights reserved.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any
+ * damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any
+ * purpose, including commercial applications, and to alter it and
+ * redistribute it freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must
+ * not claim that you wrote the original software. If you use this
+ * software in a product, an acknowledgment in the product documentation
+ * would be appreciated but is not required.
+ *
+ * 2. Altered source versions must be plainly marked as such, and
+ * must not be misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source
+ * distribution.
+ */
+
+// NOTE: The original author also uses (short/code) names listed below,
+//       for convenience or for a certain purpose, at different places:
+//       wenxiongchang, wxc, Damon Wen, udc577
+
+/*
+ * decode_binary_log.cpp
+ *
+ *  Created on: 2026-10-17
+ *      Author: wenxiongchang
+ * Description: Decodes log files written by binary_logger into text.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "binary_logger.h"
+
+namespace calib = CA_LIB_NAMESPACE;
+
+int main(int argc, char **argv)
+{
+    if (argc < 2 || 0 == strcmp("-h", argv[1]) || 0 == strcmp("--help", argv[1]))
+    {
+        printf("Usage: %s <binary log file> ...\n", argv[0]);
+        printf("Decoded lines are written to stdout, and \"-\" stands for stdin.\n");
+        return (argc < 2) ? 1 : 0;
+    }
+
+    int exit_code = 0;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        bool is_stdin = (0 == strcmp("-", argv[i]));
+        FILE *input = is_stdin ? stdin : fopen(argv[i], "rb");
+
+        if (nullptr == input)
+        {
+            fprintf(stderr, "failed to open %s\n", argv[i]);
+            exit_code = 1;
+            continue;
+        }
+
+        int ret = calib::binary_logger::decode(input, stdout);
+
+        if (ret < 0)
+        {
+            fprintf(stderr, "failed to decode %s: %s\n", argv[i], calib::what(ret).c_str());
+            exit_code = 1;
+        }
+
+        if (!is_stdin)
+            fclose(input);
+    }
+
+    return exit_code;
+}
@@ -0,0 +1,145 @@
+/*
+ * Copyright (c) 2017-2020, Wen Xiongchang <udc577 at 126 dot com>
+ * All rights reserved.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any
+ * damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any
+ * purpose, including commercial applications, and to alter it and
+ * redistribute it freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must
+ * not claim that you wrote the original software. If you use this
+ * software in a product, an acknowledgment in the product documentation
+ * would be appreciated but is not required.
+ *
+ * 2. Altered source versions must be plainly marked as such, and
+ * must not be misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source
+ * distribution.
+ */
+
+// NOTE: The original author also uses (short/code) names listed below,
+//       for convenience or for a certain purpose, at different places:
+//       wenxiongchang, wxc, Damon Wen, udc577
+
+#include "async_file_logger.h"
+#include "common_headers.h"
+
+#include <glob.h>
+
+#include <string>
+
+#include "base/debug.h"
+
+// Counts lines containing the pattern in all log files with the base name, which may be switched several times.
+static int count_lines(const char *dir, const char *base_name, const char *pattern)
+{
+    std::string files = std::string(dir) + "/" + base_name + "_*";
+    glob_t matches;
+    char line[1024];
+    int count = 0;
+
+    if (0 != glob(files.c_str(), 0, nullptr, &matches))
+        return -1;
+
+    for (size_t i = 0; i < matches.gl_pathc; ++i)
+    {
+        FILE *fp = fopen(matches.gl_pathv[i], "r");
+
+        if (nullptr == fp)
+            continue;
+
+        while (nullptr != fgets(line, sizeof(line), fp))
+        {
+            if (nullptr != strstr(line, pattern))
+                ++count;
+        }
+        fclose(fp);
+    }
+    globfree(&matches);
+
+    return count;
+}
+
+TEST(async_file_logger, WritesInBackground)
+{
+    const char *LOG_DIR = "./ca_test_nonexistent";
+    const char *BASE_NAME = "async_writing";
+    calib::async_file_logger logger;
+
+    system("rm -f ./ca_test_nonexistent/async_writing_*");
+    calib::debug::redirect_debug_output(nullptr);
+    ASSERT_EQ(CA_RET_OK, logger.set_log_name(BASE_NAME));
+    ASSERT_EQ(CA_RET_OK, logger.set_log_directory(LOG_DIR));
+
+    ASSERT_EQ(CA_RET(FILE_OR_STREAM_NOT_OPEN), logger.output(calib::HAS_LOG_PREFIX, calib::LOG_LEVEL_INFO, "%s\n", "not open"));
+
+    ASSERT_EQ(CA_RET_OK, logger.set_queue_size(1));
+    ASSERT_EQ((int)calib::async_file_logger::MIN_QUEUE_SIZE, logger.queue_size());
+    ASSERT_EQ(CA_RET_OK, logger.set_queue_size(calib::async_file_logger::MIN_QUEUE_SIZE + 1));
+    ASSERT_EQ((int)calib::async_file_logger::MIN_QUEUE_SIZE * 2, logger.queue_size());
+
+    ASSERT_EQ(CA_RET_OK, logger.open());
+    ASSERT_TRUE(logger.is_open());
+    ASSERT_EQ(CA_RET(DEVICE_BUSY), logger.set_queue_size(calib::async_file_logger::DEFAULT_QUEUE_SIZE));
+
+    // Far more than what the queue holds and than the line limit of a file,
+    // and nothing is lost with the default blocking policy.
+    const int LINE_COUNT = 20000;
+
+    logger.set_log_level(calib::LOG_LEVEL_INFO);
+    ASSERT_EQ(0, logger.output(calib::HAS_LOG_PREFIX, calib::LOG_LEVEL_DEBUG, "%s\n", "too low"));
+    for (int i = 0; i < LINE_COUNT; ++i)
+        ASSERT_GT(logger.output(calib::HAS_LOG_PREFIX, calib::LOG_LEVEL_INFO, "async line %d\n", i), 0);
+
+    std::string long_line(calib::async_file_logger::MAX_LINE_LEN * 2, 'x');
+
+    ASSERT_EQ(calib::async_file_logger::MAX_LINE_LEN - 1,
+        logger.output(calib::NO_LOG_PREFIX, calib::LOG_LEVEL_ERROR, "truncated %s\n", long_line.c_str()));
+
+    ASSERT_EQ(CA_RET_OK, logger.close());
+    ASSERT_FALSE(logger.is_open());
+    ASSERT_EQ(0, logger.dropped_count());
+    ASSERT_EQ(LINE_COUNT, count_lines(LOG_DIR, BASE_NAME, "async line "));
+    ASSERT_EQ(0, count_lines(LOG_DIR, BASE_NAME, "too low"));
+    ASSERT_EQ(1, count_lines(LOG_DIR, BASE_NAME, "truncated "));
+}
+
+TEST(async_file_logger, DropsOnOverflow)
+{
+    const char *LOG_DIR = "./ca_test_nonexistent";
+    const char *BASE_NAME = "async_overflow";
+    calib::async_file_logger logger;
+
+    system("rm -f ./ca_test_nonexistent/async_overflow_*");
+    calib::debug::redirect_debug_output(nullptr);
+    ASSERT_EQ(CA_RET_OK, logger.set_log_name(BASE_NAME));
+    ASSERT_EQ(CA_RET_OK, logger.set_log_directory(LOG_DIR));
+    ASSERT_EQ(CA_RET_OK, logger.set_queue_size(calib::async_file_logger::MIN_QUEUE_SIZE));
+    logger.set_overflow_policy(calib::async_file_logger::OVERFLOW_DROPS_LOW_LEVELS);
+    ASSERT_EQ(CA_RET_OK, logger.open());
+
+    const int LINE_COUNT = 100000;
+    int written_count = 0;
+
+    for (int i = 0; i < LINE_COUNT; ++i)
+    {
+        if (logger.output(calib::HAS_LOG_PREFIX, calib::LOG_LEVEL_INFO, "info line %d\n", i) > 0)
+            ++written_count;
+        // never dropped with this policy
+        ASSERT_GT(logger.output(calib::HAS_LOG_PREFIX, calib::LOG_LEVEL_WARNING, "warning line %d\n", i), 0);
+    }
+
+    int64_t dropped_count = logger.dropped_count();
+
+    printf("%d info lines written, %ld dropped\n", written_count, dropped_count);
+    ASSERT_EQ(LINE_COUNT, written_count + dropped_count);
+
+    ASSERT_EQ(CA_RET_OK, logger.close());
+    ASSERT_EQ(written_count, count_lines(LOG_DIR, BASE_NAME, "info line "));
+    ASSERT_EQ(LINE_COUNT, count_lines(LOG_DIR, BASE_NAME, "warning line "));
+}
@@ -0,0 +1,144 @@
+/*
+ * Copyright (c) 2017-2020, Wen Xiongchang <udc577 at 126 dot com>
+ * All rights reserved.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any
+ * damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any
+ * purpose, including commercial applications, and to alter it and
+ * redistribute it freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must
+ * not claim that you wrote the original software. If you use this
+ * software in a product, an acknowledgment in the product documentation
+ * would be appreciated but is not required.
+ *
+ * 2. Altered source versions must be plainly marked as such, and
+ * must not be misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source
+ * distribution.
+ */
+
+// NOTE: The original author also uses (short/code) names listed below,
+//       for convenience or for a certain purpose, at different places:
+//       wenxiongchang, wxc, Damon Wen, udc577
+
+#include "binary_logger.h"
+#include "common_headers.h"
+
+#include <stdarg.h>
+
+#include <string>
+
+#include "base/debug.h"
+
+static std::string expected_text(const char *fmt, ...)
+{
+    char buf[1024];
+    va_list args;
+
+    va_start(args, fmt);
+    vsnprintf(buf, sizeof(buf), fmt, args);
+    va_end(args);
+
+    return buf;
+}
+
+TEST(binary_logger, EncodeAndDecode)
+{
+    const char *LOG_DIR = "./ca_test_nonexistent";
+    calib::binary_logger logger;
+    const char *null_str = nullptr;
+    char array_str[16] = "array";
+    std::string long_str(calib::binary_logger::MAX_RECORD_LEN * 2, 'x');
+    std::vector<std::string> expected_lines;
+
+    calib::debug::redirect_debug_output(nullptr);
+    ASSERT_EQ(CA_RET_OK, logger.set_log_name("binary_test"));
+    ASSERT_EQ(CA_RET_OK, logger.set_log_directory(LOG_DIR));
+
+    std::string file = std::string(LOG_DIR) + "/" + logger.log_name();
+
+    calib::binary_logger::site_t site = { 0, 0, calib::LOG_LEVEL_INFO, "%d\n" };
+
+    ASSERT_EQ(CA_RET(FILE_OR_STREAM_NOT_OPEN), logger.log(site, 1));
+    ASSERT_EQ(CA_RET_OK, logger.open());
+    ASSERT_EQ(CA_RET(OPERATION_NOT_PERMITTED), logger.output(calib::HAS_LOG_PREFIX, calib::LOG_LEVEL_INFO, "%d\n", 1));
+    logger.set_log_level(calib::LOG_LEVEL_INFO);
+
+    for (int i = 0; i < 3; ++i) // the sites are defined only once
+    {
+        BLOG(logger, calib::LOG_LEVEL_DEBUG, "filtered out %d\n", i);
+
+        BLOG(logger, calib::LOG_LEVEL_INFO, "[cmd:0x%08X] [%s] done, time spent: %ld us\n", 0x1234 + i, "parsing", 10L * i);
+        expected_lines.push_back(expected_text("[cmd:0x%08X] [%s] done, time spent: %ld us\n", 0x1234 + i, "parsing", 10L * i));
+
+        BLOG(logger, calib::LOG_LEVEL_WARNING, "%d %u %hd %hhu %lld %llx %c %5.2f %-8s| %p %% %s %s\n",
+            -i, -1, (short)-2, (unsigned char)255, -1234567890123LL, 0xFEDCBA9876ULL, 'A' + i, 3.14159f,
+            array_str, (void *)0x1000, null_str, "literal");
+        expected_lines.push_back(expected_text("%d %u %hd %hhu %lld %llx %c %5.2f %-8s| %p %% %s %s\n",
+            -i, -1, (short)-2, (unsigned char)255, -1234567890123LL, 0xFEDCBA9876ULL, 'A' + i, 3.14159f,
+            array_str, (void *)0x1000, "(null)", "literal"));
+
+        BLOG(logger, calib::LOG_LEVEL_ERROR, "%*d|%.*s|%e\n", 6, i, 3, "abcdef", 1.5e10);
+        expected_lines.push_back(expected_text("%*d|%.*s|%e\n", 6, i, 3, "abcdef", 1.5e10));
+    }
+
+    BLOG(logger, calib::LOG_LEVEL_INFO, "long: %s\n", long_str.c_str()); // truncated
+    BLOG(logger, calib::LOG_LEVEL_INFO, "missing: %d %s\n", 1);
+
+    ASSERT_EQ(CA_RET_OK, logger.close());
+
+    FILE *input = fopen(file.c_str(), "rb");
+    FILE *output = tmpfile();
+    char line[calib::binary_logger::MAX_RECORD_LEN * 2];
+    int line_count = 0;
+
+    ASSERT_TRUE(nullptr != input);
+    ASSERT_TRUE(nullptr != output);
+    ASSERT_EQ((int)expected_lines.size() + 2, calib::binary_logger::decode(input, output));
+    fclose(input);
+
+    rewind(output);
+    while (nullptr != fgets(line, sizeof(line), output))
+    {
+        char level = '\0';
+        int month = 0;
+        int day = 0;
+        int hour = 0;
+        int minute = 0;
+        int second = 0;
+        long usec = 0;
+
+        ASSERT_EQ(7, sscanf(line, "%c%2d%2d %2d:%2d:%2d.%6ld ", &level, &month, &day, &hour, &minute, &second, &usec));
+
+        const char *text = line + calib::logger::LOG_PREFIX_LEN;
+
+        if (line_count < (int)expected_lines.size())
+        {
+            ASSERT_EQ("IWE"[line_count % 3], level);
+            ASSERT_STREQ(expected_lines[line_count].c_str(), text);
+        }
+        else if (line_count == (int)expected_lines.size())
+        {
+            ASSERT_EQ(0, strncmp("long: xxx", text, 9));
+            ASSERT_LT(strlen(text), (size_t)calib::binary_logger::MAX_RECORD_LEN);
+        }
+        else
+            ASSERT_STREQ("missing: 1 <?>\n", text);
+        ++line_count;
+    }
+    fclose(output);
+    ASSERT_EQ((int)expected_lines.size() + 2, line_count);
+
+    // Not a binary log file.
+    FILE *text_file = tmpfile();
+
+    fputs("I1017 00:00:00.000000 text\n", text_file);
+    rewind(text_file);
+    ASSERT_EQ(CA_RET(OBJECT_MISMATCHED), calib::binary_logger::decode(text_file, stdout));
+    fclose(text_file);
+}
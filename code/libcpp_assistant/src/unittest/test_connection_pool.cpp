@@ -0,0 +1,146 @@
+/*
+ * Copyright (c) 2026, Wen Xiongchang <udc577 at 126 dot com>
+ * All rights reserved.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any
+ * damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any
+ * purpose, including commercial applications, and to alter it and
+ * redistribute it freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must
+ * not claim that you wrote the original software. If you use this
+ * software in a product, an acknowledgment in the product documentation
+ * would be appreciated but is not required.
+ *
+ * 2. Altered source versions must be plainly marked as such, and
+ * must not be misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source
+ * distribution.
+ */
+
+// NOTE: The original author also uses (short/code) names listed below,
+//       for convenience or for a certain purpose, at different places:
+//       wenxiongchang, wxc, Damon Wen, udc577
+
+
+#include "connection_pool.h"
+#include "common_headers.h"
+
+#include <vector>
+
+#include "sequential_buffer.h"
+
+TEST(connection_pool, AcquireAndRelease)
+{
+    const int kConnCount = 100;
+    const int kBufSize = 2048;
+    calib::connection_pool pool(kConnCount / 2);
+    calib::net_connection *conns[kConnCount] = {nullptr};
+
+    ASSERT_EQ(kConnCount / 2, pool.max_idle_count());
+    ASSERT_EQ(0, pool.idle_node_count());
+    ASSERT_TRUE(nullptr == pool.acquire_buffer(0));
+
+    for (int i = 0; i < kConnCount; ++i)
+    {
+        conns[i] = pool.acquire(kBufSize, (0 == i % 2) ? kBufSize : 0);
+        ASSERT_TRUE(nullptr != conns[i]);
+        ASSERT_EQ(calib::INVALID_SOCK_FD, conns[i]->fd);
+        ASSERT_EQ(kBufSize, conns[i]->send_buf->total_size());
+        ASSERT_TRUE((0 == i % 2) ? (nullptr != conns[i]->recv_buf) : (nullptr == conns[i]->recv_buf));
+    }
+    ASSERT_EQ(0, pool.idle_buffer_count());
+
+    calib::buffer *recycled_buf = conns[0]->send_buf;
+    calib::net_connection *recycled_conn = conns[kConnCount - 1];
+
+    ASSERT_EQ(3, recycled_buf->write(3, "abc"));
+    for (int i = 0; i < kConnCount; ++i)
+    {
+        pool.release(conns[i]);
+    }
+    // one size only, with at most kConnCount / 2 kept
+    ASSERT_EQ(kConnCount / 2, pool.idle_buffer_count());
+
+    calib::net_connection *conn = pool.acquire(kBufSize, 0);
+
+    ASSERT_EQ(recycled_conn, conn); // the most recently released one
+    ASSERT_TRUE(recycled_buf == conn->send_buf || kConnCount / 2 - 1 == pool.idle_buffer_count());
+    ASSERT_TRUE(conn->send_buf->empty());
+    ASSERT_TRUE(nullptr == conn->recv_buf);
+    pool.release(conn);
+
+    // nodes not from the pool are destroyed directly
+    calib::net_connection *foreign_conn = calib::create_net_connection(kBufSize, kBufSize);
+
+    ASSERT_TRUE(nullptr != foreign_conn);
+    int idle_node_count = pool.idle_node_count();
+
+    pool.release(foreign_conn);
+    ASSERT_EQ(idle_node_count, pool.idle_node_count());
+
+    pool.shrink();
+    ASSERT_EQ(0, pool.idle_buffer_count());
+}
+
+TEST(connection_pool, GrowableBuffers)
+{
+    const int kMaxSize = 16 * 1024;
+    calib::connection_pool pool;
+
+    pool.set_initial_buffer_size(0);
+    ASSERT_EQ(0, pool.initial_buffer_size());
+
+    calib::buffer *buf = pool.acquire_buffer(kMaxSize);
+
+    ASSERT_TRUE(nullptr != buf);
+    ASSERT_TRUE(buf->is_growable());
+    ASSERT_TRUE(nullptr == buf->data());
+    ASSERT_EQ(0, buf->total_size());
+    ASSERT_EQ(kMaxSize, buf->max_size());
+    ASSERT_FALSE(buf->full());
+
+    std::vector<char> data(kMaxSize + 1, 'x');
+
+    // grows on demand
+    ASSERT_EQ(3, buf->write(3, data.data()));
+    ASSERT_EQ(calib::buffer::MIN_BUF_SIZE, buf->total_size());
+    ASSERT_EQ(calib::buffer::MIN_BUF_SIZE * 2 - 3, buf->reserve(calib::buffer::MIN_BUF_SIZE));
+    ASSERT_EQ(calib::buffer::MIN_BUF_SIZE * 2, buf->total_size());
+
+    // but never beyond the maximum size
+    ASSERT_EQ(kMaxSize - 3, buf->write(kMaxSize + 1, data.data()));
+    ASSERT_EQ(kMaxSize, buf->total_size());
+    ASSERT_TRUE(buf->full());
+
+    // memory is kept while there is data
+    ASSERT_EQ(0, buf->release_memory());
+    buf->reset();
+    ASSERT_EQ(kMaxSize, buf->release_memory());
+    ASSERT_TRUE(nullptr == buf->data());
+
+    buf->write(3, data.data());
+    pool.release_buffer(buf);
+    ASSERT_EQ(1, pool.idle_buffer_count());
+    ASSERT_TRUE(nullptr == buf->data());
+
+    ASSERT_EQ(buf, pool.acquire_buffer(kMaxSize));
+    ASSERT_TRUE(buf->empty());
+    pool.release_buffer(buf);
+
+    // eager buffers are not mixed with growable ones
+    pool.set_initial_buffer_size(-1);
+
+    calib::buffer *eager_buf = pool.acquire_buffer(kMaxSize);
+
+    ASSERT_TRUE(nullptr != eager_buf);
+    ASSERT_NE(buf, eager_buf);
+    ASSERT_FALSE(eager_buf->is_growable());
+    ASSERT_EQ(kMaxSize, eager_buf->total_size());
+    pool.release_buffer(eager_buf);
+    ASSERT_EQ(2, pool.idle_buffer_count());
+}
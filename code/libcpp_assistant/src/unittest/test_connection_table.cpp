@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2026, Wen Xiongchang <udc577 at 126 dot com>
+ * All rights reserved.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any
+ * damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any
+ * purpose, including commercial applications, and to alter it and
+ * redistribute it freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must
+ * not claim that you wrote the original software. If you use this
+ * software in a product, an acknowledgment in the product documentation
+ * would be appreciated but is not required.
+ *
+ * 2. Altered source versions must be plainly marked as such, and
+ * must not be misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source
+ * distribution.
+ */
+
+// NOTE: The original author also uses (short/code) names listed below,
+//       for convenience or for a certain purpose, at different places:
+//       wenxiongchang, wxc, Damon Wen, udc577
+
+#include "connection_table.h"
+#include "common_headers.h"
+
+#include "net_common.h"
+
+TEST(connection_table, AllInOne)
+{
+    const int kConnCount = 1000;
+    calib::connection_table table;
+    calib::net_connection conns[kConnCount];
+
+    ASSERT_TRUE(table.empty());
+    ASSERT_TRUE(table.end() == table.find(-1));
+    ASSERT_TRUE(table.end() == table.find(0));
+
+    for (int i = 0; i < kConnCount; ++i)
+    {
+        int fd = i * 3; // sparse file descriptors
+
+        conns[i].fd = fd;
+        ASSERT_TRUE(table.insert(fd, &conns[i]).second);
+        ASSERT_FALSE(table.insert(fd, &conns[i]).second);
+    }
+    ASSERT_FALSE(table.insert(-1, &conns[0]).second);
+    ASSERT_EQ((size_t)kConnCount, table.size());
+
+    for (int i = 0; i < kConnCount; ++i)
+    {
+        calib::connection_table::iterator it = table.find(i * 3);
+
+        ASSERT_TRUE(table.end() != it);
+        ASSERT_EQ(i * 3, it->first);
+        ASSERT_EQ(&conns[i], it->second);
+        ASSERT_TRUE(table.end() == table.find(i * 3 + 1));
+    }
+
+    // erases the even ones, including the last one and the first one
+    for (int i = 0; i < kConnCount; i += 2)
+        ASSERT_EQ((size_t)1, table.erase(i * 3));
+    ASSERT_EQ((size_t)0, table.erase(0));
+    ASSERT_EQ((size_t)(kConnCount / 2), table.size());
+
+    int traversed_count = 0;
+
+    for (calib::connection_table::iterator it = table.begin(); it != table.end(); ++it)
+    {
+        ASSERT_EQ(it->first, it->second->fd);
+        ASSERT_EQ(1, (it->first / 3) % 2); // odd ones left only
+        ASSERT_TRUE(it == table.find(it->first));
+        ++traversed_count;
+    }
+    ASSERT_EQ(kConnCount / 2, traversed_count);
+
+    ASSERT_TRUE(nullptr == table[kConnCount * 3]);
+    ASSERT_EQ((size_t)(kConnCount / 2 + 1), table.size());
+    table[kConnCount * 3] = &conns[0];
+    ASSERT_EQ(&conns[0], table.find(kConnCount * 3)->second);
+
+    table.clear();
+    ASSERT_TRUE(table.empty());
+    ASSERT_TRUE(table.end() == table.find(3));
+}
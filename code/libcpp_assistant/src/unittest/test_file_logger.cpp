@@ -389,3 +389,196 @@ TEST(file_logger, AllInOne)
     ASSERT_FALSE(logger.is_open());
 }
 
+
+TEST(file_logger, LogPrefix)
+{
+    const char *LOG_DIR = "./ca_test_nonexistent";
+    const calib::enum_log_level LOG_LEVELS[] = {
+        calib::LOG_LEVEL_DEBUG,
+        calib::LOG_LEVEL_INFO,
+        calib::LOG_LEVEL_WARNING,
+        calib::LOG_LEVEL_ERROR,
+        calib::LOG_LEVEL_CRITICAL
+    };
+    const int LEVEL_COUNT = sizeof(LOG_LEVELS) / sizeof(calib::enum_log_level);
+    const int ROUNDS = 3;
+    calib::file_logger logger;
+    time_t begin_time = time(nullptr);
+
+    calib::debug::redirect_debug_output(nullptr);
+    ASSERT_EQ(CA_RET_OK, logger.set_log_name("prefix_test"));
+    ASSERT_EQ(CA_RET_OK, logger.set_log_directory(LOG_DIR));
+    ASSERT_EQ(CA_RET_OK, logger.open());
+    ASSERT_FALSE(logger.uses_coarse_clock());
+
+    std::string file = std::string(LOG_DIR) + "/" + logger.log_name();
+
+    for (int i = 0; i < ROUNDS * LEVEL_COUNT; ++i)
+    {
+        logger.set_uses_coarse_clock(i >= LEVEL_COUNT);
+        ASSERT_EQ(8, logger.output(calib::HAS_LOG_PREFIX, LOG_LEVELS[i % LEVEL_COUNT], "line %02d\n", i));
+        usleep(200 * 1000); // some lines are in different seconds
+    }
+    ASSERT_EQ(CA_RET_OK, logger.close());
+
+    time_t end_time = time(nullptr);
+    FILE *fp = fopen(file.c_str(), "r");
+    char line[256];
+    int line_count = 0;
+
+    ASSERT_TRUE(nullptr != fp);
+    while (nullptr != fgets(line, sizeof(line), fp))
+    {
+        char level = '\0';
+        struct tm expected_time;
+        struct tm actual_time;
+        long usec = -1;
+        int index = -1;
+
+        memset(&actual_time, 0, sizeof(actual_time));
+        ASSERT_EQ(8, sscanf(line, "%c%2d%2d %2d:%2d:%2d.%6ld line %d", &level, &actual_time.tm_mon, &actual_time.tm_mday,
+            &actual_time.tm_hour, &actual_time.tm_min, &actual_time.tm_sec, &usec, &index)) << line;
+        ASSERT_EQ(line_count, index);
+        ASSERT_EQ(calib::G_LOG_LEVEL_STRINGS[LOG_LEVELS[index % LEVEL_COUNT]][0], level);
+        ASSERT_EQ(' ', line[calib::logger::LOG_PREFIX_LEN - 1]);
+        ASSERT_TRUE(usec >= 0 && usec < 1000000);
+
+        // The time of a line is between the beginning and the end.
+        localtime_r(&begin_time, &expected_time);
+        actual_time.tm_year = expected_time.tm_year;
+        actual_time.tm_mon -= 1;
+        actual_time.tm_isdst = -1;
+
+        time_t line_time = mktime(&actual_time);
+
+        ASSERT_LE(begin_time, line_time);
+        ASSERT_GE(end_time, line_time);
+        ++line_count;
+    }
+    fclose(fp);
+    ASSERT_EQ(ROUNDS * LEVEL_COUNT, line_count);
+}
+
+static void *logging_routine(void *arg)
+{
+    calib::logger *logger = (calib::logger *)arg;
+    long tid = calib::gettid();
+
+    for (int i = 0; i < 5000; ++i)
+    {
+        logger->output(calib::HAS_LOG_PREFIX, calib::LOG_LEVEL_INFO,
+            "thread[%ld] line[%d]: %s\n", tid, i, "some contents that should not be broken by other threads");
+    }
+
+    return nullptr;
+}
+
+TEST(file_logger, ThreadSafe)
+{
+    const char *LOG_DIR = "./ca_test_nonexistent";
+    const int THREAD_COUNT = 4;
+    calib::file_logger logger;
+    pthread_t threads[THREAD_COUNT];
+    char cmd[256];
+
+    system("rm -f ./ca_test_nonexistent/thread_safe_test_*");
+    calib::debug::redirect_debug_output(nullptr);
+    ASSERT_EQ(CA_RET_OK, logger.set_log_name("thread_safe_test"));
+    ASSERT_EQ(CA_RET_OK, logger.set_log_directory(LOG_DIR));
+    ASSERT_EQ(CA_RET_OK, logger.set_log_line_limit(calib::LOG_LINE_LIMIT_MIN)); // switched many times
+    ASSERT_FALSE(logger.is_thread_safe());
+    logger.set_thread_safe(true);
+    ASSERT_TRUE(logger.is_thread_safe());
+    ASSERT_EQ(CA_RET_OK, logger.open());
+
+    for (int i = 0; i < THREAD_COUNT; ++i)
+        ASSERT_EQ(0, pthread_create(&threads[i], nullptr, logging_routine, &logger));
+    for (int i = 0; i < THREAD_COUNT; ++i)
+        pthread_join(threads[i], nullptr);
+    ASSERT_EQ(CA_RET_OK, logger.close());
+
+    // All lines are written, and none of them is broken.
+    FILE *result = nullptr;
+    int line_count = 0;
+
+    snprintf(cmd, sizeof(cmd), "cat %s/thread_safe_test_* | grep -c \"^I.*thread\\[[0-9]*\\] line\\[[0-9]*\\]: some contents"
+        " that should not be broken by other threads$\"", LOG_DIR);
+    ASSERT_TRUE(nullptr != (result = popen(cmd, "r")));
+    ASSERT_EQ(1, fscanf(result, "%d", &line_count));
+    pclose(result);
+    ASSERT_EQ(THREAD_COUNT * 5000, line_count);
+
+    snprintf(cmd, sizeof(cmd), "cat %s/thread_safe_test_* | wc -l", LOG_DIR);
+    ASSERT_TRUE(nullptr != (result = popen(cmd, "r")));
+    ASSERT_EQ(1, fscanf(result, "%d", &line_count));
+    pclose(result);
+    ASSERT_EQ(THREAD_COUNT * 5000, line_count);
+}
+
+TEST(file_logger, SizeRotationInBackground)
+{
+    const char *LOG_DIR = "./ca_test_nonexistent";
+    const int LINE_COUNT = 20000;
+    const int MAX_FRAGMENTS = 3;
+    calib::file_logger logger;
+    char cmd[256];
+
+    system("rm -f ./ca_test_nonexistent/size_rotation_test_*");
+
+    // A fragment of another process, which is older than all, and must be left alone.
+    char foreign_fragment[256];
+    FILE *fp = nullptr;
+
+    snprintf(foreign_fragment, sizeof(foreign_fragment), "%s/size_rotation_test_20000101_%d_0.log",
+        LOG_DIR, (int)getpid() + 1);
+    ASSERT_TRUE(nullptr != (fp = fopen(foreign_fragment, "w")));
+    fclose(fp);
+    snprintf(cmd, sizeof(cmd), "touch -d 2000-01-01 %s", foreign_fragment);
+    ASSERT_EQ(0, system(cmd));
+
+    calib::debug::redirect_debug_output(nullptr);
+    ASSERT_EQ(CA_RET_OK, logger.set_log_name("size_rotation_test"));
+    ASSERT_EQ(CA_RET_OK, logger.set_log_directory(LOG_DIR));
+    ASSERT_EQ(CA_RET(INVALID_PARAM_VALUE), logger.set_log_size_limit(-1));
+    ASSERT_EQ(CA_RET_OK, logger.set_log_size_limit(1));
+    ASSERT_EQ(calib::file_logger::LOG_SIZE_LIMIT_MIN, logger.log_size_limit());
+    ASSERT_EQ(CA_RET_OK, logger.set_rotates_in_background(true));
+    ASSERT_EQ(CA_RET_OK, logger.set_compression_command("gzip -f"));
+    ASSERT_EQ(CA_RET_OK, logger.set_max_fragments(MAX_FRAGMENTS));
+    ASSERT_EQ(CA_RET_OK, logger.open());
+    ASSERT_EQ(CA_RET(DEVICE_BUSY), logger.set_log_size_limit(0));
+    ASSERT_EQ(CA_RET(DEVICE_BUSY), logger.set_max_fragments(0));
+
+    for (int i = 0; i < LINE_COUNT; ++i)
+    {
+        ASSERT_GT(logger.i("line[%05d]: some contents to fill up fragments of the log file quickly\n", i), 0);
+        ASSERT_LE(logger.current_log_size(), (int64_t)calib::file_logger::LOG_SIZE_LIMIT_MIN + 128);
+    }
+    ASSERT_GT(logger.current_log_fragments(), MAX_FRAGMENTS);
+    ASSERT_EQ(CA_RET_OK, logger.close());
+    ASSERT_EQ(0, logger.rotation_error());
+
+    // Only the latest fragments of this process are kept, all compressed, and nothing is left being written.
+    FILE *result = nullptr;
+    int count = 0;
+
+    snprintf(cmd, sizeof(cmd), "ls %s | grep -c \"^size_rotation_test_.*\\.log\\.gz$\"", LOG_DIR);
+    ASSERT_TRUE(nullptr != (result = popen(cmd, "r")));
+    ASSERT_EQ(1, fscanf(result, "%d", &count));
+    pclose(result);
+    ASSERT_EQ(MAX_FRAGMENTS, count);
+
+    snprintf(cmd, sizeof(cmd), "ls %s | grep -c \"^size_rotation_test_\"", LOG_DIR);
+    ASSERT_TRUE(nullptr != (result = popen(cmd, "r")));
+    ASSERT_EQ(1, fscanf(result, "%d", &count));
+    pclose(result);
+    ASSERT_EQ(MAX_FRAGMENTS + 1, count);
+    ASSERT_EQ(0, access(foreign_fragment, F_OK));
+
+    // The last line is in the latest fragment.
+    snprintf(cmd, sizeof(cmd), "zcat %s/size_rotation_test_*.gz | grep -c \"line\\[%05d\\]\"", LOG_DIR, LINE_COUNT - 1);
+    ASSERT_TRUE(nullptr != (result = popen(cmd, "r")));
+    ASSERT_EQ(1, fscanf(result, "%d", &count));
+    pclose(result);
+    ASSERT_EQ(1, count);
+}
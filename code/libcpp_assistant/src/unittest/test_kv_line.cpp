@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2017-2020, Wen Xiongchang <udc577 at 126 dot com>
+ * All rights reserved.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any
+ * damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any
+ * purpose, including commercial applications, and to alter it and
+ * redistribute it freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must
+ * not claim that you wrote the original software. If you use this
+ * software in a product, an acknowledgment in the product documentation
+ * would be appreciated but is not required.
+ *
+ * 2. Altered source versions must be plainly marked as such, and
+ * must not be misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source
+ * distribution.
+ */
+
+// NOTE: The original author also uses (short/code) names listed below,
+//       for convenience or for a certain purpose, at different places:
+//       wenxiongchang, wxc, Damon Wen, udc577
+#include "kv_line.h"
+#include "common_headers.h"
+
+#include <string.h>
+
+#include <string>
+
+#include "screen_logger.h"
+
+TEST(kv_line, RendersFields)
+{
+    calib::kv_line text(calib::KV_FORMAT_TEXT);
+
+    text.begin("I", "new connection");
+    text.add("fd", 12);
+    text.add("peer", "127.0.0.1");
+    text.add("bytes", -9223372036854775807LL - 1);
+    text.add("ratio", 0.5);
+    text.add("ok", true);
+    text.end();
+    ASSERT_STREQ("new connection: fd[12] | peer[127.0.0.1] | bytes[-9223372036854775808] | ratio[0.5] | ok[true]\n",
+        text.data());
+    ASSERT_EQ((int)strlen(text.data()), text.length());
+
+    calib::kv_line json(calib::KV_FORMAT_JSON);
+    std::string name("a\"b\\c\n\x01");
+
+    json.begin("W", "tab\there");
+    json.add("name", name);
+    json.add("count", 18446744073709551615ULL);
+    json.add("nan", 0.0 / 0.0);
+    json.add("null_str", (const char *)nullptr);
+    json.end();
+
+    std::string line(json.data(), json.length());
+
+    ASSERT_EQ(0U, line.find("{\"ts\":"));
+    ASSERT_NE(std::string::npos,
+        line.find(",\"level\":\"W\",\"msg\":\"tab\\there\",\"name\":\"a\\\"b\\\\c\\n\\u0001\","
+            "\"count\":18446744073709551615,\"nan\":null,\"null_str\":null}\n"));
+}
+
+TEST(kv_line, DropsFieldsCutOff)
+{
+    std::string long_value(calib::kv_line::MAX_LEN, 'v');
+    std::string quotes(calib::kv_line::MAX_LEN, '"');
+
+    for (int format = calib::KV_FORMAT_TEXT; format <= calib::KV_FORMAT_JSON; ++format)
+    {
+        calib::kv_line line((calib::enum_kv_format)format);
+
+        line.begin("E", "cut off");
+        line.add("first", 1);
+        line.add("long_value", long_value);
+        line.add("escaped", quotes);
+        line.add("after", 2);
+        line.end();
+
+        std::string rendered(line.data(), line.length());
+
+        ASSERT_LE(line.length(), (int)calib::kv_line::MAX_LEN);
+        ASSERT_NE(std::string::npos, rendered.find("first"));
+        ASSERT_EQ(std::string::npos, rendered.find("long_value"));
+        ASSERT_EQ(std::string::npos, rendered.find("escaped"));
+        ASSERT_EQ(std::string::npos, rendered.find("after")); // nothing after a cut-off field
+        ASSERT_EQ('\n', rendered[rendered.size() - 1]);
+        if (calib::KV_FORMAT_JSON == format)
+        {
+            ASSERT_EQ('}', rendered[rendered.size() - 2]);
+        }
+    }
+
+    calib::screen_logger logger;
+
+    ASSERT_EQ(CA_RET_OK, logger.open());
+    ASSERT_GT(logger.kv(calib::LOG_LEVEL_WARNING, "through a logger", "fd", 3, "peer", std::string("::1")), 0);
+    logger.set_log_level(calib::LOG_LEVEL_ERROR);
+    ASSERT_EQ(0, logger.kv(calib::LOG_LEVEL_WARNING, "filtered out", "fd", 3));
+}
@@ -0,0 +1,150 @@
+/*
+ * Copyright (c) 2017-2020, Wen Xiongchang <udc577 at 126 dot com>
+ * All rights reserved.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any
+ * damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any
+ * purpose, including commercial applications, and to alter it and
+ * redistribute it freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must
+ * not claim that you wrote the original software. If you use this
+ * software in a product, an acknowledgment in the product documentation
+ * would be appreciated but is not required.
+ *
+ * 2. Altered source versions must be plainly marked as such, and
+ * must not be misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source
+ * distribution.
+ */
+
+// NOTE: The original author also uses (short/code) names listed below,
+//       for convenience or for a certain purpose, at different places:
+//       wenxiongchang, wxc, Damon Wen, udc577
+#include "mmap_file_logger.h"
+#include "common_headers.h"
+
+#include <glob.h>
+#include <signal.h>
+#include <sys/wait.h>
+
+#include <string>
+
+#include "base/debug.h"
+
+// Reads all log files with the base name and the suffix, returns how many lines contain the pattern,
+// and how many '\0's are found into @zero_count.
+static int count_lines(const char *dir, const char *base_name, const char *suffix, const char *pattern, int &zero_count)
+{
+    std::string files = std::string(dir) + "/" + base_name + "_*" + suffix;
+    glob_t matches;
+    std::string contents;
+    char buf[4096];
+    int count = 0;
+
+    zero_count = 0;
+    if (0 != glob(files.c_str(), 0, nullptr, &matches))
+        return -1;
+
+    for (size_t i = 0; i < matches.gl_pathc; ++i)
+    {
+        FILE *fp = fopen(matches.gl_pathv[i], "r");
+        size_t len = 0;
+
+        if (nullptr == fp)
+            continue;
+
+        contents.clear();
+        while ((len = fread(buf, 1, sizeof(buf), fp)) > 0)
+            contents.append(buf, len);
+        fclose(fp);
+
+        for (size_t pos = 0; pos < contents.size(); ++pos)
+        {
+            if ('\0' == contents[pos])
+                ++zero_count;
+        }
+
+        for (size_t pos = contents.find(pattern); std::string::npos != pos; pos = contents.find(pattern, pos + 1))
+            ++count;
+    }
+    globfree(&matches);
+
+    return count;
+}
+
+TEST(mmap_file_logger, WritesIntoMapping)
+{
+    const char *LOG_DIR = "./ca_test_nonexistent";
+    const char *BASE_NAME = "mmap_writing";
+    calib::mmap_file_logger logger;
+    int zero_count = 0;
+
+    system("rm -f ./ca_test_nonexistent/mmap_writing_*");
+    calib::debug::redirect_debug_output(nullptr);
+    ASSERT_EQ(CA_RET_OK, logger.set_log_name(BASE_NAME));
+    ASSERT_EQ(CA_RET_OK, logger.set_log_directory(LOG_DIR));
+    ASSERT_EQ(CA_RET(FILE_OR_STREAM_NOT_OPEN), logger.i("%s\n", "not open"));
+
+    ASSERT_EQ(CA_RET_OK, logger.open(1));
+    ASSERT_EQ((int)calib::mmap_file_logger::MIN_WINDOW_SIZE, logger.window_size());
+
+    // Across many windows and several fragments.
+    const int LINE_COUNT = 25000;
+
+    for (int i = 0; i < LINE_COUNT; ++i)
+        ASSERT_GT(logger.i("mmap line %d\n", i), 0);
+    ASSERT_GT(logger.current_log_fragments(), 1);
+
+    std::string long_line(calib::mmap_file_logger::MAX_LINE_LEN * 2, 'x');
+
+    ASSERT_EQ(calib::mmap_file_logger::MAX_LINE_LEN - 1,
+        logger.output(calib::NO_LOG_PREFIX, calib::LOG_LEVEL_ERROR, "truncated %s\n", long_line.c_str()));
+
+    ASSERT_EQ(CA_RET_OK, logger.close());
+    ASSERT_EQ(LINE_COUNT, count_lines(LOG_DIR, BASE_NAME, ".log", "mmap line ", zero_count));
+    ASSERT_EQ(0, zero_count); // truncated to the length written
+    ASSERT_EQ(1, count_lines(LOG_DIR, BASE_NAME, ".log", "truncated ", zero_count));
+}
+
+TEST(mmap_file_logger, SurvivesCrash)
+{
+    const char *LOG_DIR = "./ca_test_nonexistent";
+    const char *BASE_NAME = "mmap_crash";
+    const int LINE_COUNT = 1000;
+    int zero_count = 0;
+
+    system("rm -f ./ca_test_nonexistent/mmap_crash_*");
+
+    pid_t pid = fork();
+
+    ASSERT_GE(pid, 0);
+    if (0 == pid)
+    {
+        calib::mmap_file_logger logger;
+
+        calib::debug::redirect_debug_output(nullptr);
+        if (CA_RET_OK != logger.set_log_name(BASE_NAME)
+            || CA_RET_OK != logger.set_log_directory(LOG_DIR)
+            || CA_RET_OK != logger.open())
+            _exit(1);
+
+        for (int i = 0; i < LINE_COUNT; ++i)
+            logger.i("line before crash %d\n", i);
+
+        kill(getpid(), SIGKILL); // nothing is flushed or closed
+    }
+
+    int status = 0;
+
+    ASSERT_EQ(pid, waitpid(pid, &status, 0));
+    ASSERT_TRUE(WIFSIGNALED(status));
+
+    // All lines are in the unfinished file, followed by the zero fill of the window.
+    ASSERT_EQ(LINE_COUNT, count_lines(LOG_DIR, BASE_NAME, ".tmp", "line before crash ", zero_count));
+    ASSERT_GT(zero_count, 0);
+}
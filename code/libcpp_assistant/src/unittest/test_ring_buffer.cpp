@@ -0,0 +1,150 @@
+/*
+ * Copyright (c) 2026, Wen Xiongchang <udc577 at 126 dot com>
+ * All rights reserved.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any
+ * damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any
+ * purpose, including commercial applications, and to alter it and
+ * redistribute it freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must
+ * not claim that you wrote the original software. If you use this
+ * software in a product, an acknowledgment in the product documentation
+ * would be appreciated but is not required.
+ *
+ * 2. Altered source versions must be plainly marked as such, and
+ * must not be misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source
+ * distribution.
+ */
+
+// NOTE: The original author also uses (short/code) names listed below,
+//       for convenience or for a certain purpose, at different places:
+//       wenxiongchang, wxc, Damon Wen, udc577
+
+
+#include "ring_buffer.h"
+#include "common_headers.h"
+
+#include <unistd.h>
+#include <sys/socket.h>
+
+#include <vector>
+
+#include "tcp_base.h"
+
+static void __check_wrapping(bool is_mirrored)
+{
+    calib::ring_buffer buf;
+    struct iovec iov[2];
+
+    ASSERT_TRUE(nullptr == buf.get_read_pointer());
+    ASSERT_EQ(CA_RET_OK, buf.create(1, is_mirrored));
+    ASSERT_EQ(CA_RET(OBJECT_ALREADY_EXISTS), buf.create(1, is_mirrored));
+    ASSERT_EQ(is_mirrored, buf.is_mirrored());
+
+    const int kSize = buf.total_size();
+    std::vector<char> data_holder(kSize * 2);
+    std::vector<char> out_holder(kSize * 2);
+    char *data = &(data_holder[0]);
+    char *out = &(out_holder[0]);
+
+    for (int i = 0; i < kSize * 2; ++i)
+        data[i] = (char)(i * 7);
+
+    ASSERT_GE(kSize, (int)calib::ring_buffer::MIN_BUF_SIZE);
+    ASSERT_TRUE(buf.empty());
+    ASSERT_EQ(0, buf.get_data_regions(iov));
+    ASSERT_EQ(1, buf.get_free_regions(iov));
+    ASSERT_EQ((size_t)kSize, iov[0].iov_len);
+
+    // makes data wrap around: [kSize - 300, kSize) + [0, 200)
+    ASSERT_EQ(kSize - 100, buf.write(kSize - 100, data));
+    ASSERT_EQ(kSize - 100, buf.read(kSize - 100, out));
+    ASSERT_EQ(0, memcmp(data, out, kSize - 100));
+    ASSERT_EQ(0, buf.data_size()); // pointers go back to the header when empty
+    ASSERT_EQ(kSize - 100, buf.write(kSize - 100, data));
+    ASSERT_EQ(kSize - 300, buf.move_read_pointer(kSize - 300));
+    ASSERT_EQ(300, buf.write(300, data + kSize - 100));
+    ASSERT_EQ(500, buf.data_size());
+    ASSERT_EQ(kSize - 500, buf.free_size());
+
+    if (is_mirrored)
+    {
+        ASSERT_EQ(500, buf.contiguous_data_size());
+        ASSERT_EQ(1, buf.get_data_regions(iov));
+        ASSERT_EQ(0, memcmp(buf.get_read_pointer(), data + kSize - 300, 500)); // in place across the end
+    }
+    else
+    {
+        ASSERT_EQ(300, buf.contiguous_data_size());
+        ASSERT_EQ(2, buf.get_data_regions(iov));
+        ASSERT_EQ((size_t)300, iov[0].iov_len);
+        ASSERT_EQ((size_t)200, iov[1].iov_len);
+    }
+    ASSERT_EQ(1, buf.get_free_regions(iov));
+    ASSERT_EQ((size_t)(kSize - 500), iov[0].iov_len);
+
+    ASSERT_EQ(500, buf.read(kSize * 2, out));
+    ASSERT_EQ(0, memcmp(data + kSize - 300, out, 500));
+    ASSERT_TRUE(buf.empty());
+
+    ASSERT_EQ(kSize, buf.write(kSize * 2, data));
+    ASSERT_TRUE(buf.full());
+    ASSERT_EQ(0, buf.write(1, data));
+    ASSERT_EQ(0, buf.get_free_regions(iov));
+
+    buf.destroy();
+    ASSERT_EQ(0, buf.total_size());
+}
+
+TEST(ring_buffer, Wrapping)
+{
+    __check_wrapping(false);
+}
+
+TEST(ring_buffer, MirroredWrapping)
+{
+    __check_wrapping(true);
+}
+
+TEST(ring_buffer, SendAndReceive)
+{
+    int fds[2] = { -1, -1 };
+    calib::ring_buffer out_buf(calib::ring_buffer::MIN_BUF_SIZE);
+    calib::ring_buffer in_buf(calib::ring_buffer::MIN_BUF_SIZE);
+    const int kSize = out_buf.total_size();
+    char data[calib::ring_buffer::MIN_BUF_SIZE] = {0};
+    char out[calib::ring_buffer::MIN_BUF_SIZE] = {0};
+    struct iovec iov[2];
+
+    for (size_t i = 0; i < sizeof(data); ++i)
+        data[i] = (char)(i * 7);
+
+    ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+
+    // data of both buffers wraps around
+    ASSERT_EQ(kSize - 10, out_buf.move_write_pointer(kSize - 10));
+    ASSERT_EQ(kSize - 20, out_buf.move_read_pointer(kSize - 20));
+    ASSERT_EQ(100, out_buf.write(100, data));
+    ASSERT_EQ(2, out_buf.get_data_regions(iov));
+    ASSERT_EQ(kSize - 30, in_buf.move_write_pointer(kSize - 30));
+    ASSERT_EQ(kSize - 40, in_buf.move_read_pointer(kSize - 40));
+    ASSERT_EQ(2, in_buf.get_free_regions(iov));
+
+    ASSERT_EQ(110, calib::tcp_base::send_from_ring_buffer(fds[0], &out_buf));
+    ASSERT_TRUE(out_buf.empty());
+    ASSERT_EQ(110, calib::tcp_base::recv_to_ring_buffer(fds[1], &in_buf));
+    ASSERT_EQ(120, in_buf.data_size());
+    ASSERT_EQ(10, in_buf.move_read_pointer(10)); // the old data
+    ASSERT_EQ(110, in_buf.read(sizeof(out), out));
+    ASSERT_EQ(0, memcmp(data, out + 10, 100));
+
+    close(fds[0]);
+    ASSERT_EQ(CA_RET(CONNECTION_BROKEN), calib::tcp_base::recv_to_ring_buffer(fds[1], &in_buf));
+    close(fds[1]);
+}
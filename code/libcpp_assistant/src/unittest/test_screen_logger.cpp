@@ -28,6 +28,9 @@
 
 #include "common_headers.h"
 
+#include <fcntl.h>
+#include <unistd.h>
+
 #include "private/debug.h"
 #include "base/debug.h"
 #include "screen_logger.h"
@@ -285,3 +288,48 @@ TEST(screen_logger, AllInOne)
 #endif
 }
 
+TEST(screen_logger, MutedWhenDiscarded)
+{
+    calib::screen_logger logger;
+
+    logger.set_log_level(calib::LOG_LEVEL_INFO);
+    logger.set_muted(true);
+    ASSERT_EQ(0, logger.e("%s\n", "dropped"));
+    ASSERT_EQ(0, logger.kv(calib::LOG_LEVEL_ERROR, "dropped"));
+    logger.set_log_level(calib::LOG_LEVEL_WARNING); // kept until unmuted
+    ASSERT_EQ(calib::LOG_LEVEL_WARNING, logger.log_level());
+    ASSERT_EQ(0, logger.w("%s\n", "dropped"));
+    logger.set_muted(false);
+    ASSERT_EQ(0, logger.i("%s\n", "filtered out"));
+    ASSERT_GT(logger.w("%s\n", "unmuted"), 0);
+
+    // Redirects both stdout and stderr to /dev/null, as a daemon may do.
+    int saved_stdout = dup(STDOUT_FILENO);
+    int saved_stderr = dup(STDERR_FILENO);
+    int null_fd = open("/dev/null", O_WRONLY);
+
+    ASSERT_GE(null_fd, 0);
+    fflush(stdout);
+    fflush(stderr);
+    dup2(null_fd, STDOUT_FILENO);
+    dup2(null_fd, STDERR_FILENO);
+    logger.refresh_output_status();
+
+    bool is_discarded = logger.output_is_discarded();
+    bool is_terminal = logger.is_terminal();
+    bool is_muted = logger.is_muted();
+
+    dup2(saved_stdout, STDOUT_FILENO);
+    dup2(saved_stderr, STDERR_FILENO);
+    close(saved_stdout);
+    close(saved_stderr);
+    close(null_fd);
+
+    ASSERT_TRUE(is_discarded);
+    ASSERT_FALSE(is_terminal);
+    ASSERT_TRUE(is_muted);
+
+    logger.refresh_output_status();
+    ASSERT_FALSE(logger.output_is_discarded());
+    ASSERT_TRUE(logger.is_muted()); // never unmuted by detection
+}
@@ -0,0 +1,275 @@
+/*
+ * Copyright (c) 2026, Wen Xiongchang <udc577 at 126 dot com>
+ * All rights reserved.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any
+ * damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any
+ * purpose, including commercial applications, and to alter it and
+ * redistribute it freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must
+ * not claim that you wrote the original software. If you use this
+ * software in a product, an acknowledgment in the product documentation
+ * would be appreciated but is not required.
+ *
+ * 2. Altered source versions must be plainly marked as such, and
+ * must not be misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source
+ * distribution.
+ */
+
+// NOTE: The original author also uses (short/code) names listed below,
+//       for convenience or for a certain purpose, at different places:
+//       wenxiongchang, wxc, Damon Wen, udc577
+
+
+#include "tcp_base.h"
+#include "common_headers.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/socket.h>
+
+#include "sequential_buffer.h"
+
+TEST(tcp_base, SendFragments)
+{
+    int fds[2] = { -1, -1 };
+    char recv_data[64] = {0};
+    struct iovec iov[3] = {
+        { (void *)"abc", 3 },
+        { nullptr, 0 },
+        { (void *)"defg", 4 }
+    };
+
+    ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+    ASSERT_EQ(CA_RET(INVALID_PARAM_VALUE), calib::tcp_base::send_fragments(-1, iov, 3));
+    ASSERT_EQ(0, calib::tcp_base::send_fragments(fds[0], iov, 0));
+    ASSERT_EQ(7, calib::tcp_base::send_fragments(fds[0], iov, 3));
+    ASSERT_EQ(7, recv(fds[1], recv_data, sizeof(recv_data), 0));
+    ASSERT_STREQ("abcdefg", recv_data);
+
+    close(fds[0]);
+    close(fds[1]);
+}
+
+TEST(tcp_base, SendToConnectionAndCorking)
+{
+    const int kBufSize = 1024;
+    int fds[2] = { -1, -1 };
+    char recv_data[kBufSize * 2] = {0};
+    calib::net_connection *conn = calib::create_net_connection(kBufSize, kBufSize);
+
+    ASSERT_TRUE(nullptr != conn);
+    ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+    conn->fd = fds[0];
+    ASSERT_EQ(CA_RET(CONNECTION_BROKEN), calib::tcp_base::send_to_connection(conn, "hello", 5));
+    conn->conn_status = calib::CONN_STATUS_CONNECTED;
+
+    // held in the send buffer while corked
+    calib::tcp_base::cork_connection(conn);
+    ASSERT_EQ(5, calib::tcp_base::send_to_connection(conn, "hello", 5));
+    ASSERT_EQ(5, calib::tcp_base::send_to_connection(conn, "world", 5));
+    ASSERT_EQ(10, conn->send_buf->data_size());
+    ASSERT_EQ(-1, recv(fds[1], recv_data, sizeof(recv_data), MSG_DONTWAIT));
+    ASSERT_EQ(EAGAIN, errno);
+    ASSERT_EQ(10, calib::tcp_base::uncork_connection(conn));
+    ASSERT_FALSE(conn->is_corked);
+    ASSERT_TRUE(conn->send_buf->empty());
+    ASSERT_EQ(10, recv(fds[1], recv_data, sizeof(recv_data), 0));
+    ASSERT_STREQ("helloworld", recv_data);
+
+    // pending data goes first, together with the new data
+    memset(recv_data, 0, sizeof(recv_data));
+    ASSERT_EQ(2, conn->send_buf->write(2, "xy"));
+    ASSERT_EQ(1, calib::tcp_base::send_to_connection(conn, "z", 1));
+    ASSERT_TRUE(conn->send_buf->empty());
+    ASSERT_EQ(3, recv(fds[1], recv_data, sizeof(recv_data), 0));
+    ASSERT_STREQ("xyz", recv_data);
+
+    ASSERT_EQ(CA_RET(SPACE_NOT_ENOUGH), calib::tcp_base::send_to_connection(conn, recv_data,
+        conn->send_buf->total_size() + 1));
+
+    calib::destroy_net_connection(&conn);
+    close(fds[1]);
+}
+
+TEST(tcp_base, EnqueueSharedPacket)
+{
+    const int kBufSize = 1024;
+    const int kBigLen = 1024 * 1024;
+    int fds[2][2] = { { -1, -1 }, { -1, -1 } };
+    char recv_data[kBufSize] = {0};
+    calib::net_connection *conns[2] = {
+        calib::create_net_connection(kBufSize, kBufSize),
+        calib::create_net_connection(kBufSize, kBufSize)
+    };
+    calib::shared_packet *packet = calib::create_shared_packet("packet", 6);
+
+    ASSERT_TRUE(nullptr != packet);
+    for (int i = 0; i < 2; ++i)
+    {
+        ASSERT_TRUE(nullptr != conns[i]);
+        ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, fds[i]));
+        conns[i]->fd = fds[i][0];
+        ASSERT_EQ(CA_RET(CONNECTION_BROKEN), calib::tcp_base::enqueue_to_connection(conns[i], packet));
+        conns[i]->conn_status = calib::CONN_STATUS_CONNECTED;
+    }
+
+    // one packet shared by both, queued after pending data, followed by data sent later
+    ASSERT_EQ(2, conns[0]->send_buf->write(2, "ab"));
+    for (int i = 0; i < 2; ++i)
+    {
+        ASSERT_EQ(6, calib::tcp_base::enqueue_to_connection(conns[i], packet));
+    }
+    ASSERT_EQ(3, packet->ref_count);
+    ASSERT_EQ(1, calib::tcp_base::send_to_connection(conns[0], "!", 1));
+    ASSERT_EQ(6, conns[0]->queued_bytes);
+    ASSERT_EQ(-1, recv(fds[0][1], recv_data, sizeof(recv_data), MSG_DONTWAIT));
+    ASSERT_EQ(9, calib::tcp_base::send_from_connection(conns[0]));
+    ASSERT_EQ(9, recv(fds[0][1], recv_data, sizeof(recv_data), 0));
+    ASSERT_STREQ("abpacket!", recv_data);
+    ASSERT_FALSE(calib::tcp_base::has_data_to_send(conns[0]));
+    ASSERT_EQ(2, packet->ref_count);
+
+    // released by the connection on destruction
+    ASSERT_TRUE(calib::tcp_base::has_data_to_send(conns[1]));
+    calib::destroy_net_connection(&(conns[1]));
+    ASSERT_EQ(1, packet->ref_count);
+    calib::release_shared_packet(&packet);
+    ASSERT_TRUE(nullptr == packet);
+
+    // what a slow peer can not take at once stays queued, and nothing is lost
+    char *big_data = (char *)malloc(kBigLen);
+    int recv_len = 0;
+
+    ASSERT_TRUE(nullptr != big_data);
+    memset(big_data, 'x', kBigLen);
+    packet = calib::create_shared_packet(big_data, kBigLen);
+    ASSERT_EQ(0, calib::tcp_base::set_nonblocking(fds[0][0]));
+    ASSERT_EQ(kBigLen, calib::tcp_base::enqueue_to_connection(conns[0], packet));
+    calib::release_shared_packet(&packet);
+    while (calib::tcp_base::has_data_to_send(conns[0]))
+    {
+        ASSERT_GE(calib::tcp_base::send_from_connection(conns[0]), 0);
+        if (conns[0]->queued_bytes > 0)
+        {
+            ASSERT_LT(conns[0]->queued_bytes, kBigLen); // sent partially, and the rest left queued
+        }
+
+        int ret = 0;
+
+        while ((ret = recv(fds[0][1], big_data, kBigLen, MSG_DONTWAIT)) > 0)
+        {
+            recv_len += ret;
+        }
+    }
+    ASSERT_EQ(kBigLen, recv_len);
+    ASSERT_EQ(0, conns[0]->queued_bytes);
+
+    free(big_data);
+    calib::destroy_net_connection(&(conns[0]));
+    close(fds[0][1]);
+    close(fds[1][1]);
+}
+
+TEST(tcp_base, SendQueueOrder)
+{
+    const int kBigLen = 1024 * 1024;
+    const char kTail[] = "headtailnextend";
+    int fds[2] = { -1, -1 };
+    calib::net_connection *conn = calib::create_net_connection(1024, 1024);
+    char *big_data = (char *)malloc(kBigLen);
+    char *recv_data = (char *)malloc(kBigLen + sizeof(kTail));
+    int recv_len = 0;
+    int ret = 0;
+
+    ASSERT_TRUE(nullptr != conn);
+    ASSERT_TRUE(nullptr != big_data);
+    ASSERT_TRUE(nullptr != recv_data);
+    ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+    ASSERT_EQ(0, calib::tcp_base::set_nonblocking(fds[0]));
+    conn->fd = fds[0];
+    conn->conn_status = calib::CONN_STATUS_CONNECTED;
+    memset(big_data, 'x', kBigLen);
+
+    // pending data, then a big packet sent partially by a slow peer
+    calib::shared_packet *packet = calib::create_shared_packet(big_data, kBigLen);
+
+    ASSERT_EQ(4, conn->send_buf->write(4, "head"));
+    ASSERT_EQ(kBigLen, calib::tcp_base::enqueue_to_connection(conn, packet));
+    calib::release_shared_packet(&packet);
+    ASSERT_GT(calib::tcp_base::send_from_connection(conn), 4);
+    ASSERT_GT(conn->queued_bytes, 0);
+    ASSERT_LT(conn->queued_bytes, kBigLen);
+    ASSERT_GT(conn->send_queue_head->offset, 0);
+
+    // data written into send_buf directly or not, and another packet, all go after the rest of it
+    ASSERT_EQ(4, conn->send_buf->write(4, "tail"));
+    packet = calib::create_shared_packet("next", 4);
+    ASSERT_EQ(4, calib::tcp_base::enqueue_to_connection(conn, packet));
+    calib::release_shared_packet(&packet);
+    ASSERT_EQ(3, calib::tcp_base::send_to_connection(conn, "end", 3));
+
+    while (calib::tcp_base::has_data_to_send(conn))
+    {
+        ASSERT_GE(calib::tcp_base::send_from_connection(conn), 0);
+        while ((ret = recv(fds[1], recv_data + recv_len, kBigLen + sizeof(kTail) - recv_len, MSG_DONTWAIT)) > 0)
+        {
+            recv_len += ret;
+        }
+    }
+    ASSERT_EQ((int)(kBigLen + strlen(kTail)), recv_len);
+    ASSERT_EQ(0, memcmp(recv_data, "head", 4));
+    ASSERT_EQ(0, memcmp(recv_data + 4, big_data, kBigLen));
+    ASSERT_EQ(0, memcmp(recv_data + 4 + kBigLen, "tailnextend", 11));
+    ASSERT_EQ(0, conn->queued_bytes);
+    ASSERT_EQ(0, conn->queued_buf_bytes);
+
+    free(big_data);
+    free(recv_data);
+    calib::destroy_net_connection(&conn);
+    close(fds[1]);
+}
+
+TEST(tcp_base, IsReady)
+{
+    int fds[2];
+
+    ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+    ASSERT_TRUE(calib::tcp_base::is_writable(fds[0], 0));
+    ASSERT_FALSE(calib::tcp_base::is_readable(fds[1], 0));
+    ASSERT_EQ(3, write(fds[0], "abc", 3));
+    ASSERT_TRUE(calib::tcp_base::is_readable(fds[1], 1000));
+
+    // beyond FD_SETSIZE, which select() can not handle
+    int high_fd = fcntl(fds[0], F_DUPFD, 2000);
+
+    if (high_fd >= 0)
+    {
+        ASSERT_TRUE(calib::tcp_base::is_writable(high_fd, 0));
+        ASSERT_FALSE(calib::tcp_base::is_readable(high_fd, 0));
+    }
+
+    // batch form
+    int batch_fds[] = { fds[0], fds[1], high_fd };
+    bool results[3] = { true, false, true };
+    int batch_count = (high_fd >= 0) ? 3 : 2;
+
+    ASSERT_EQ(1, calib::tcp_base::are_readable(batch_fds, batch_count, results, 0));
+    ASSERT_FALSE(results[0]);
+    ASSERT_TRUE(results[1]);
+    ASSERT_FALSE(results[2] && high_fd >= 0);
+    ASSERT_EQ(batch_count, calib::tcp_base::are_writable(batch_fds, batch_count, results, 0));
+    ASSERT_EQ(CA_RET(INVALID_PARAM_VALUE), calib::tcp_base::are_writable(batch_fds, 0, results, 0));
+
+    if (high_fd >= 0)
+        close(high_fd);
+    close(fds[0]);
+    close(fds[1]);
+}
@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) 2026, Wen Xiongchang <udc577 at 126 dot com>
+ * All rights reserved.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any
+ * damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any
+ * purpose, including commercial applications, and to alter it and
+ * redistribute it freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must
+ * not claim that you wrote the original software. If you use this
+ * software in a product, an acknowledgment in the product documentation
+ * would be appreciated but is not required.
+ *
+ * 2. Altered source versions must be plainly marked as such, and
+ * must not be misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source
+ * distribution.
+ */
+
+// NOTE: The original author also uses (short/code) names listed below,
+//       for convenience or for a certain purpose, at different places:
+//       wenxiongchang, wxc, Damon Wen, udc577
+
+#include "tcp_client.h"
+#include "common_headers.h"
+
+#include <errno.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+
+#include "sequential_buffer.h"
+
+// Polls @client until @conn is reported, which means connect() completes one way or another.
+static bool wait_for_connection(calib::tcp_client &client, calib::net_connection *conn)
+{
+    for (int i = 0; i < 100; ++i)
+    {
+        int count = client.poll();
+
+        for (int j = 0; j < count; ++j)
+        {
+            if (conn == client.get_active_peers().elements[j].data.ptr)
+                return true;
+        }
+    }
+
+    return false;
+}
+
+TEST(tcp_client, StartAndFinishConnecting)
+{
+    int listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in addr = {0};
+    socklen_t addr_len = sizeof(addr);
+
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    ASSERT_GE(listen_fd, 0);
+    ASSERT_EQ(0, bind(listen_fd, (struct sockaddr *)&addr, addr_len));
+    ASSERT_EQ(0, listen(listen_fd, 8));
+    ASSERT_EQ(0, getsockname(listen_fd, (struct sockaddr *)&addr, &addr_len));
+
+    calib::tcp_client client("test_client", 64, 10);
+    int fd = client.start_connecting("127.0.0.1", ntohs(addr.sin_port), 1024, 1024);
+
+    ASSERT_GE(fd, 0);
+
+    calib::net_connection *conn = client.find_peer(fd);
+
+    ASSERT_TRUE(nullptr != conn);
+    if (calib::CONN_STATUS_CONNECTING == conn->conn_status)
+    {
+        // held until the connection is established
+        ASSERT_EQ(3, calib::tcp_base::send_to_connection(conn, "abc", 3));
+        ASSERT_EQ(3, conn->send_buf->data_size());
+        ASSERT_EQ(CA_RET(CONNECTION_NOT_READY), calib::tcp_base::recv_to_connection(conn));
+        ASSERT_TRUE(wait_for_connection(client, conn));
+    }
+    else
+        ASSERT_EQ(3, calib::tcp_base::send_to_connection(conn, "abc", 3));
+
+    ASSERT_EQ(CA_RET_OK, client.finish_connecting(conn));
+    ASSERT_EQ((int)calib::CONN_STATUS_CONNECTED, conn->conn_status);
+    ASSERT_FALSE(conn->is_corked);
+    ASSERT_TRUE(conn->send_buf->empty());
+    ASSERT_GT(conn->self_port, 0);
+
+    int accepted_fd = accept(listen_fd, nullptr, nullptr);
+    char data[4] = {0};
+
+    ASSERT_GE(accepted_fd, 0);
+    ASSERT_EQ(3, recv(accepted_fd, data, sizeof(data), 0));
+    ASSERT_STREQ("abc", data);
+
+    close(accepted_fd);
+    close(listen_fd);
+
+    // nothing listens on the port now
+    fd = client.start_connecting("127.0.0.1", ntohs(addr.sin_port), 1024, 1024);
+    if (fd >= 0)
+    {
+        conn = client.find_peer(fd);
+        ASSERT_TRUE(nullptr != conn);
+        ASSERT_TRUE(wait_for_connection(client, conn));
+        ASSERT_EQ(-ECONNREFUSED, client.finish_connecting(conn));
+        ASSERT_EQ((int)calib::CONN_STATUS_BROKEN, conn->conn_status);
+        ASSERT_EQ(CA_RET_OK, client.disconnect_server(conn));
+    }
+    else
+        ASSERT_EQ(-ECONNREFUSED, fd);
+
+    client.disconnect_all_servers();
+}
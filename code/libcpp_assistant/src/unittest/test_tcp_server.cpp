@@ -0,0 +1,150 @@
+/*
+ * Copyright (c) 2026, Wen Xiongchang <udc577 at 126 dot com>
+ * All rights reserved.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any
+ * damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any
+ * purpose, including commercial applications, and to alter it and
+ * redistribute it freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must
+ * not claim that you wrote the original software. If you use this
+ * software in a product, an acknowledgment in the product documentation
+ * would be appreciated but is not required.
+ *
+ * 2. Altered source versions must be plainly marked as such, and
+ * must not be misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source
+ * distribution.
+ */
+
+// NOTE: The original author also uses (short/code) names listed below,
+//       for convenience or for a certain purpose, at different places:
+//       wenxiongchang, wxc, Damon Wen, udc577
+
+#include "tcp_server.h"
+#include "common_headers.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+
+#include "sequential_buffer.h"
+
+TEST(tcp_server, AcceptNewConnections)
+{
+    const int kClientCount = 8;
+    calib::tcp_server server("test_server", 64, 10);
+    struct sockaddr_in addr = {0};
+    socklen_t addr_len = sizeof(addr);
+    int client_fds[kClientCount];
+    std::vector<int> new_fds;
+
+    ASSERT_EQ(CA_RET(RESOURCE_NOT_AVAILABLE), server.accept_new_connections(1024, 1024, &new_fds));
+
+    server.set_listen_backlog(-1);
+    ASSERT_EQ((int)calib::tcp_server::DEFAULT_LISTEN_BACKLOG, server.listen_backlog());
+    server.set_listen_backlog(kClientCount * 2);
+    ASSERT_EQ(kClientCount * 2, server.listen_backlog());
+
+    ASSERT_GE(server.start("127.0.0.1", 0), 0); // port 0: an ephemeral one assigned by the kernel
+    ASSERT_EQ(0, getsockname(server.listening_fd(), (struct sockaddr *)&addr, &addr_len));
+    ASSERT_EQ(0, server.accept_new_connections(1024, 1024, &new_fds)); // none pending
+
+    for (int i = 0; i < kClientCount; ++i)
+    {
+        client_fds[i] = socket(AF_INET, SOCK_STREAM, 0);
+        ASSERT_GE(client_fds[i], 0);
+        // completed by the kernel and queued in the backlog, without any accept()
+        ASSERT_EQ(0, connect(client_fds[i], (struct sockaddr *)&addr, addr_len));
+    }
+
+    ASSERT_EQ(kClientCount / 2, server.accept_new_connections(1024, 1024, &new_fds, kClientCount / 2));
+    ASSERT_EQ(kClientCount - kClientCount / 2, server.accept_new_connections(1024, 1024, &new_fds));
+    ASSERT_EQ(0, server.accept_new_connections(1024, 1024, &new_fds));
+    ASSERT_EQ((size_t)kClientCount, new_fds.size());
+    ASSERT_EQ((size_t)kClientCount, server.peers()->size());
+
+    for (size_t i = 0; i < new_fds.size(); ++i)
+    {
+        calib::net_connection *conn = (*(server.peers()))[new_fds[i]];
+
+        ASSERT_TRUE(nullptr != conn);
+        ASSERT_EQ(new_fds[i], conn->fd);
+        ASSERT_FALSE(conn->is_blocking);
+        ASSERT_TRUE(fcntl(conn->fd, F_GETFL) & O_NONBLOCK);
+        ASSERT_TRUE(fcntl(conn->fd, F_GETFD) & FD_CLOEXEC);
+        ASSERT_STREQ("127.0.0.1", conn->peer_ip);
+    }
+
+    for (int i = 0; i < kClientCount; ++i)
+        close(client_fds[i]);
+
+    server.end();
+}
+
+TEST(tcp_server, SendPendingConnections)
+{
+    const int kConnCount = 4;
+    calib::tcp_server server("test_server", 64, 10);
+    int fds[kConnCount][2];
+    calib::net_connection *conns[kConnCount];
+
+    for (int i = 0; i < kConnCount; ++i)
+    {
+        ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, fds[i]));
+        ASSERT_EQ(fds[i][0], server.adopt_connection(fds[i][0], 1024, 1024));
+        ASSERT_TRUE(nullptr != (conns[i] = server.find_peer(fds[i][0])));
+    }
+    ASSERT_TRUE(nullptr == server.send_pending_head());
+
+    // data left by each way of sending, but nothing from a send completed at once
+    ASSERT_EQ(3, calib::tcp_base::send_to_connection(conns[0], "abc", 3));
+    ASSERT_EQ(0, server.send_pending_count());
+    calib::tcp_base::cork_connection(conns[0]);
+    ASSERT_EQ(3, calib::tcp_base::send_to_connection(conns[0], "def", 3));
+
+    calib::shared_packet *packet = calib::create_shared_packet("packet", 6);
+
+    ASSERT_EQ(6, calib::tcp_base::enqueue_to_connection(conns[1], packet));
+    ASSERT_EQ(6, calib::tcp_base::enqueue_to_connection(conns[1], packet)); // joins only once
+    calib::release_shared_packet(&packet);
+    ASSERT_EQ(4, conns[2]->send_buf->write(4, "ghij"));
+    calib::mark_send_pending(*(conns[2]));
+    ASSERT_EQ(3, server.send_pending_count());
+
+    // idle peers are not visited, and a drained one leaves
+    int visited_count = 0;
+    calib::net_connection *next = nullptr;
+
+    calib::tcp_base::uncork_connection(conns[0]);
+    ASSERT_EQ(2, server.send_pending_count());
+    for (calib::net_connection *conn = server.send_pending_head(); nullptr != conn; conn = next)
+    {
+        next = conn->pending_next;
+        ASSERT_NE(conns[3], conn);
+        ASSERT_GT(calib::tcp_base::send_from_connection(conn), 0);
+        ++visited_count;
+    }
+    ASSERT_EQ(2, visited_count);
+    ASSERT_TRUE(nullptr == server.send_pending_head());
+    ASSERT_EQ(0, server.send_pending_count());
+
+    // a peer leaves on shutdown too
+    ASSERT_EQ(4, calib::tcp_base::send_to_connection(conns[3], "klmn", 4));
+    calib::tcp_base::cork_connection(conns[3]);
+    ASSERT_EQ(1, calib::tcp_base::send_to_connection(conns[3], "o", 1));
+    ASSERT_EQ(1, server.send_pending_count());
+    ASSERT_EQ(0, server.shutdown_connection(conns[3]));
+    ASSERT_EQ(0, server.send_pending_count());
+
+    for (int i = 0; i < kConnCount; ++i)
+        close(fds[i][1]);
+
+    server.end();
+}